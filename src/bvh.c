@@ -0,0 +1,512 @@
+/** Bounding Volume Hierarchy */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+
+#include "bcore_spect_inst.h"
+#include "bcore_life.h"
+#include "bcore_spect.h"
+#include "bcore_spect_array.h"
+
+#include "bvh.h"
+
+/**********************************************************************************************************************/
+/// bvh_node_s
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( bvh_node_s, "bvh_node_s = bcore_inst { u2_t offs; u2_t count; }" )
+
+/**********************************************************************************************************************/
+/// bvh_node_arr_s, bvh_f3_arr_s, bvh_u2_arr_s
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( bvh_node_arr_s, "bvh_node_arr_s = bcore_inst { aware_t _; bvh_node_s [] arr; }" )
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( bvh_f3_arr_s,   "bvh_f3_arr_s = bcore_inst { aware_t _; f3_t [] arr; }" )
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( bvh_u2_arr_s,   "bvh_u2_arr_s = bcore_inst { aware_t _; u2_t [] arr; }" )
+
+/**********************************************************************************************************************/
+/// bvh_s
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST
+(
+    bvh_s,
+    "bvh_s = bcore_inst"
+    "{"
+        "aware_t _;"
+        "bvh_node_arr_s node_arr;"
+        "bvh_f3_arr_s   node_box;"
+        "bvh_u2_arr_s   idx_arr;"
+        "bvh_f3_arr_s   prim_box;"
+        "bvh_f3_arr_s   node_cost;"
+    "}"
+)
+
+#define BVH_BINS 16          // number of bins per axis evaluated by the SAH
+#define BVH_MAX_LEAF_SIZE 8  // leaves larger than this are split even when the SAH advises against it
+
+/// cost of testing a node relative to the cost of testing a primitive
+static const f3_t bvh_traversal_cost = 0.25;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// working data during construction
+typedef struct bvh_builder_s
+{
+    bvh_s* bvh;
+    const box_s* box_arr; // primitive bounds
+    v3d_s* cen_arr;       // primitive centers
+    box_s* node_box;      // node bounds (array-of-structures; converted at the end)
+} bvh_builder_s;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// appends a node; returns its index
+static uz_t bvh_s_push_node( bvh_s* o )
+{
+    uz_t index = o->node_arr.size;
+    if( o->node_arr.space == index ) bcore_array_a_set_space( (bcore_array*)&o->node_arr, index > 0 ? index * 2 : 16 );
+    bcore_array_a_set_size( (bcore_array*)&o->node_arr, index + 1 );
+    return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline uz_t bvh_bin( f3_t c, f3_t c_min, f3_t scale )
+{
+    uz_t bin = ( c - c_min ) * scale;
+    return bin < BVH_BINS ? bin : BVH_BINS - 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// builds subtree over slots first ... first + count - 1 at node 'node_index'; children are appended depth-first
+static void bvh_builder_s_build_node( bvh_builder_s* o, uz_t node_index, uz_t first, uz_t count, uz_t depth )
+{
+    bvh_s* bvh = o->bvh;
+    u2_t* idx = bvh->idx_arr.data;
+    const box_s* box_arr = o->box_arr;
+    const v3d_s* cen_arr = o->cen_arr;
+
+    box_s box     = box_s_empty();
+    box_s cen_box = box_s_empty();
+    for( uz_t i = first; i < first + count; i++ )
+    {
+        box     = box_s_union( box, box_arr[ idx[ i ] ] );
+        cen_box = box_s_union_pos( cen_box, cen_arr[ idx[ i ] ] );
+    }
+
+    o->node_box[ node_index ] = box;
+    bvh->node_arr.data[ node_index ].offs  = first;
+    bvh->node_arr.data[ node_index ].count = count;
+
+    if( count <= 1 || depth + 1 >= BVH_MAX_DEPTH ) return;
+
+    s2_t best_axis = -1;
+    uz_t best_bin  = 0;
+    f3_t best_cost = f3_inf;
+
+    for( s2_t axis = 0; axis < 3; axis++ )
+    {
+        f3_t c_min = ( &cen_box.min.x )[ axis ];
+        f3_t extent = ( &cen_box.max.x )[ axis ] - c_min;
+        if( extent <= 0 ) continue;
+        f3_t scale = BVH_BINS / extent;
+
+        box_s bin_box[ BVH_BINS ];
+        uz_t  bin_count[ BVH_BINS ];
+        for( uz_t b = 0; b < BVH_BINS; b++ )
+        {
+            bin_box[ b ] = box_s_empty();
+            bin_count[ b ] = 0;
+        }
+
+        for( uz_t i = first; i < first + count; i++ )
+        {
+            uz_t b = bvh_bin( ( &cen_arr[ idx[ i ] ].x )[ axis ], c_min, scale );
+            bin_box[ b ] = box_s_union( bin_box[ b ], box_arr[ idx[ i ] ] );
+            bin_count[ b ]++;
+        }
+
+        // sweep from left: left side of split b contains bins 0 ... b - 1
+        f3_t area_l [ BVH_BINS ];
+        uz_t count_l[ BVH_BINS ];
+        box_s acc = box_s_empty();
+        uz_t n = 0;
+        for( uz_t b = 1; b < BVH_BINS; b++ )
+        {
+            acc = box_s_union( acc, bin_box[ b - 1 ] );
+            n += bin_count[ b - 1 ];
+            area_l[ b ] = box_s_area( acc );
+            count_l[ b ] = n;
+        }
+
+        // sweep from right and evaluate cost
+        acc = box_s_empty();
+        n = 0;
+        for( uz_t b = BVH_BINS - 1; b > 0; b-- )
+        {
+            acc = box_s_union( acc, bin_box[ b ] );
+            n += bin_count[ b ];
+            if( n == 0 || count_l[ b ] == 0 ) continue;
+            f3_t cost = area_l[ b ] * count_l[ b ] + box_s_area( acc ) * n;
+            if( cost < best_cost )
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin  = b;
+            }
+        }
+    }
+
+    uz_t mid = first;
+    if( best_axis >= 0 )
+    {
+        f3_t area = box_s_area( box );
+        f3_t split_cost = bvh_traversal_cost + ( ( area > 0 ) ? best_cost / area : count );
+        if( split_cost >= count && count <= BVH_MAX_LEAF_SIZE ) return;
+
+        f3_t c_min = ( &cen_box.min.x )[ best_axis ];
+        f3_t scale = BVH_BINS / ( ( &cen_box.max.x )[ best_axis ] - c_min );
+        for( uz_t i = first; i < first + count; i++ )
+        {
+            if( bvh_bin( ( &cen_arr[ idx[ i ] ].x )[ best_axis ], c_min, scale ) < best_bin )
+            {
+                u2_t t = idx[ i ]; idx[ i ] = idx[ mid ]; idx[ mid ] = t;
+                mid++;
+            }
+        }
+    }
+    else
+    {
+        // all centers coincide
+        if( count <= BVH_MAX_LEAF_SIZE ) return;
+        mid = first + count / 2;
+    }
+
+    bvh->node_arr.data[ node_index ].count = 0;
+
+    uz_t left = bvh_s_push_node( bvh );
+    bvh_builder_s_build_node( o, left, first, mid - first, depth + 1 );
+
+    uz_t right = bvh_s_push_node( bvh );
+    bvh->node_arr.data[ node_index ].offs = right;
+    bvh_builder_s_build_node( o, right, mid, first + count - mid, depth + 1 );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// writes boxes into a bounds array of stride n
+static void bvh_f3_arr_s_set_boxes( bvh_f3_arr_s* o, const box_s* box_arr, const u2_t* idx, uz_t n )
+{
+    bcore_array_a_set_size( (bcore_array*)o, n * 6 );
+    f3_t* b = o->data;
+    for( uz_t i = 0; i < n; i++ )
+    {
+        const box_s* box = &box_arr[ idx ? idx[ i ] : i ];
+        b[ i         ] = box->min.x;
+        b[ i +     n ] = box->min.y;
+        b[ i + 2 * n ] = box->min.z;
+        b[ i + 3 * n ] = box->max.x;
+        b[ i + 4 * n ] = box->max.y;
+        b[ i + 5 * n ] = box->max.z;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// computes node bounds bottom-up (children always follow their parent)
+static void bvh_s_eval_boxes( const bvh_s* o, const box_s* box_arr, box_s* node_box )
+{
+    const bvh_node_s* node_arr = o->node_arr.data;
+    const u2_t* idx = o->idx_arr.data;
+    for( uz_t i = o->node_arr.size; i > 0; i-- )
+    {
+        uz_t n = i - 1;
+        const bvh_node_s* nd = &node_arr[ n ];
+        box_s box = box_s_empty();
+        if( nd->count > 0 )
+        {
+            for( uz_t j = nd->offs; j < nd->offs + nd->count; j++ ) box = box_s_union( box, box_arr[ idx[ j ] ] );
+        }
+        else
+        {
+            box = box_s_union( node_box[ n + 1 ], node_box[ nd->offs ] );
+        }
+        node_box[ n ] = box;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** computes the SAH cost of each subtree bottom-up:
+ *  leaf: number of primitives; inner node: traversal cost + area weighted costs of children
+ */
+static void bvh_s_eval_cost( const bvh_s* o, const box_s* node_box, f3_t* cost )
+{
+    const bvh_node_s* node_arr = o->node_arr.data;
+    for( uz_t i = o->node_arr.size; i > 0; i-- )
+    {
+        uz_t n = i - 1;
+        const bvh_node_s* nd = &node_arr[ n ];
+        if( nd->count > 0 )
+        {
+            cost[ n ] = nd->count;
+        }
+        else
+        {
+            uz_t l = n + 1;
+            uz_t r = nd->offs;
+            f3_t area = box_s_area( node_box[ n ] );
+            if( area > 0 )
+            {
+                cost[ n ] = bvh_traversal_cost + ( box_s_area( node_box[ l ] ) * cost[ l ] + box_s_area( node_box[ r ] ) * cost[ r ] ) / area;
+            }
+            else
+            {
+                cost[ n ] = bvh_traversal_cost + cost[ l ] + cost[ r ];
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// builds the tree as subtree at depth 'depth' of an enclosing tree (limits its depth to BVH_MAX_DEPTH - depth)
+static void bvh_s_build_at_depth( bvh_s* o, const box_s* box_arr, uz_t size, uz_t depth )
+{
+    bcore_array_a_set_size( (bcore_array*)&o->node_arr, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->node_box, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->idx_arr,  size );
+    bcore_array_a_set_size( (bcore_array*)&o->prim_box, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->node_cost, 0 );
+    if( size == 0 ) return;
+
+    if( size > 0xFFFFFFFFull ) bcore_err_fa( "bvh_s_build: Too many primitives (#<uz_t>).", size );
+
+    for( uz_t i = 0; i < size; i++ ) o->idx_arr.data[ i ] = i;
+
+    bvh_builder_s builder;
+    builder.bvh      = o;
+    builder.box_arr  = box_arr;
+    builder.cen_arr  = bcore_u_alloc( sizeof( v3d_s ), NULL, size, NULL );
+    builder.node_box = bcore_u_alloc( sizeof( box_s ), NULL, size * 2, NULL ); // a binary tree has less than 2 * size nodes
+
+    for( uz_t i = 0; i < size; i++ ) builder.cen_arr[ i ] = box_s_center( box_arr[ i ] );
+
+    bvh_s_push_node( o );
+    bvh_builder_s_build_node( &builder, 0, 0, size, depth );
+
+    bvh_f3_arr_s_set_boxes( &o->node_box, builder.node_box, NULL, o->node_arr.size );
+    bvh_f3_arr_s_set_boxes( &o->prim_box, box_arr, o->idx_arr.data, size );
+
+    bcore_array_a_set_size( (bcore_array*)&o->node_cost, o->node_arr.size );
+    bvh_s_eval_cost( o, builder.node_box, o->node_cost.data );
+
+    bcore_free( builder.cen_arr );
+    bcore_free( builder.node_box );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void bvh_s_build( bvh_s* o, const box_s* box_arr, uz_t size )
+{
+    bvh_s_build_at_depth( o, box_arr, size, 0 );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// index following the last node of the subtree at 'node'
+static uz_t bvh_s_subtree_end( const bvh_s* o, uz_t node )
+{
+    while( o->node_arr.data[ node ].count == 0 ) node = o->node_arr.data[ node ].offs;
+    return node + 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// rebuilds the subtree at 'node' (at depth 'depth') over its slots and splices it into the node array
+static void bvh_s_rebuild_subtree( bvh_s* o, const box_s* box_arr, uz_t node, uz_t depth )
+{
+    const bvh_node_s* node_arr = o->node_arr.data;
+
+    uz_t end = bvh_s_subtree_end( o, node );
+    uz_t first = node;
+    while( node_arr[ first ].count == 0 ) first++; // leftmost leaf
+    first = node_arr[ first ].offs;
+    uz_t count = node_arr[ end - 1 ].offs + node_arr[ end - 1 ].count - first;
+
+    u2_t* idx = o->idx_arr.data;
+    u2_t*  sub_idx = bcore_u_alloc( sizeof( u2_t ),  NULL, count, NULL );
+    box_s* sub_box = bcore_u_alloc( sizeof( box_s ), NULL, count, NULL );
+    for( uz_t i = 0; i < count; i++ )
+    {
+        sub_idx[ i ] = idx[ first + i ];
+        sub_box[ i ] = box_arr[ sub_idx[ i ] ];
+    }
+
+    bvh_s* sub = bvh_s_create();
+    bvh_s_build_at_depth( sub, sub_box, count, depth );
+
+    for( uz_t i = 0; i < count; i++ ) idx[ first + i ] = sub_idx[ sub->idx_arr.data[ i ] ];
+
+    uz_t size = o->node_arr.size;
+    uz_t old_size = end - node;
+    uz_t new_size = sub->node_arr.size;
+    uz_t tail = size - end;
+
+    // references to nodes behind the subtree shift
+    for( uz_t i = 0; i < size; i++ )
+    {
+        bvh_node_s* nd = &o->node_arr.data[ i ];
+        if( ( i < node || i >= end ) && nd->count == 0 && nd->offs >= end ) nd->offs = nd->offs - old_size + new_size;
+    }
+
+    if( new_size > old_size )
+    {
+        bcore_array_a_set_size( (bcore_array*)&o->node_arr,  size - old_size + new_size );
+        bcore_array_a_set_size( (bcore_array*)&o->node_cost, size - old_size + new_size );
+    }
+
+    memmove( o->node_arr.data  + node + new_size, o->node_arr.data  + end, tail * sizeof( bvh_node_s ) );
+    memmove( o->node_cost.data + node + new_size, o->node_cost.data + end, tail * sizeof( f3_t ) );
+
+    if( new_size < old_size )
+    {
+        bcore_array_a_set_size( (bcore_array*)&o->node_arr,  size - old_size + new_size );
+        bcore_array_a_set_size( (bcore_array*)&o->node_cost, size - old_size + new_size );
+    }
+
+    for( uz_t i = 0; i < new_size; i++ )
+    {
+        bvh_node_s nd = sub->node_arr.data[ i ];
+        nd.offs += ( nd.count > 0 ) ? first : node;
+        o->node_arr.data[ node + i ] = nd;
+        o->node_cost.data[ node + i ] = sub->node_cost.data[ i ];
+    }
+
+    bvh_s_discard( sub );
+    bcore_free( sub_idx );
+    bcore_free( sub_box );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void bvh_s_refit( bvh_s* o, const box_s* box_arr, uz_t size )
+{
+    if( size != o->idx_arr.size || o->node_arr.size == 0 || o->node_cost.size != o->node_arr.size )
+    {
+        bvh_s_build( o, box_arr, size );
+        return;
+    }
+
+    uz_t nodes = o->node_arr.size;
+    box_s* node_box = bcore_u_alloc( sizeof( box_s ), NULL, nodes, NULL );
+    f3_t*  cost     = bcore_u_alloc( sizeof( f3_t  ), NULL, nodes, NULL );
+    uz_t*  degraded = bcore_u_alloc( sizeof( uz_t  ), NULL, nodes, NULL );
+    uz_t*  degraded_depth = bcore_u_alloc( sizeof( uz_t ), NULL, nodes, NULL );
+    uz_t   degraded_size = 0;
+
+    bvh_s_eval_boxes( o, box_arr, node_box );
+    bvh_s_eval_cost( o, node_box, cost );
+
+    // topmost degraded subtrees in ascending order
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_depth[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+    stack[ stack_size ] = 0;
+    stack_depth[ stack_size++ ] = 0;
+    while( stack_size > 0 )
+    {
+        stack_size--;
+        uz_t n     = stack[ stack_size ];
+        uz_t depth = stack_depth[ stack_size ];
+        const bvh_node_s* nd = &o->node_arr.data[ n ];
+        if( nd->count > 0 ) continue;
+        if( cost[ n ] > o->node_cost.data[ n ] * BVH_REFIT_THRESHOLD )
+        {
+            degraded[ degraded_size ] = n;
+            degraded_depth[ degraded_size++ ] = depth;
+        }
+        else
+        {
+            stack[ stack_size ] = nd->offs;
+            stack_depth[ stack_size++ ] = depth + 1;
+            stack[ stack_size ] = n + 1;
+            stack_depth[ stack_size++ ] = depth + 1;
+        }
+    }
+
+    bcore_free( cost );
+
+    if( degraded_size > 0 && degraded[ 0 ] == 0 )
+    {
+        bcore_free( node_box );
+        bcore_free( degraded );
+        bcore_free( degraded_depth );
+        bvh_s_build( o, box_arr, size );
+        return;
+    }
+
+    // splicing from the back keeps the indices of pending subtrees valid
+    // rebuilt subtrees keep the total depth within BVH_MAX_DEPTH
+    for( uz_t i = degraded_size; i > 0; i-- ) bvh_s_rebuild_subtree( o, box_arr, degraded[ i - 1 ], degraded_depth[ i - 1 ] );
+
+    if( degraded_size > 0 )
+    {
+        nodes = o->node_arr.size;
+        node_box = bcore_u_alloc( sizeof( box_s ), node_box, nodes, NULL );
+        bvh_s_eval_boxes( o, box_arr, node_box );
+    }
+
+    bvh_f3_arr_s_set_boxes( &o->node_box, node_box, NULL, nodes );
+    bvh_f3_arr_s_set_boxes( &o->prim_box, box_arr, o->idx_arr.data, size );
+
+    bcore_free( node_box );
+    bcore_free( degraded );
+    bcore_free( degraded_depth );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+box_s bvh_s_get_box( const bvh_s* o )
+{
+    uz_t n = o->node_arr.size;
+    if( n == 0 ) return box_s_empty();
+    const f3_t* b = o->node_box.data;
+    return ( box_s ) { .min = { b[ 0 ], b[ n ], b[ 2 * n ] }, .max = { b[ 3 * n ], b[ 4 * n ], b[ 5 * n ] } };
+}
+
+/**********************************************************************************************************************/
+
+vd_t bvh_signal_handler( const bcore_signal_s* o )
+{
+    switch( bcore_signal_s_handle_type( o, typeof( "bvh" ) ) )
+    {
+        case TYPEOF_init1:
+        {
+            BCORE_REGISTER_OBJECT( bvh_node_s );
+            BCORE_REGISTER_OBJECT( bvh_node_arr_s );
+            BCORE_REGISTER_OBJECT( bvh_f3_arr_s );
+            BCORE_REGISTER_OBJECT( bvh_u2_arr_s );
+            BCORE_REGISTER_OBJECT( bvh_s );
+        }
+        break;
+
+        default: break;
+    }
+    return NULL;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,180 @@
+/** Bounding Volume Hierarchy */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "bcore_std.h"
+#include "bcore_arr.h"
+
+#include "quicktypes.h"
+#include "vectors.h"
+
+/**********************************************************************************************************************/
+/** Render form of a bounding volume hierarchy
+ *
+ *  Nodes are stored depth-first in a contiguous array: the left child of an inner node immediately
+ *  follows its parent; only the right child is referenced explicitly.
+ *  Node bounds and primitive bounds are stored structure-of-arrays (see bvh_s).
+ *  Leaves reference a contiguous range of slots; a slot holds the index of a primitive.
+ */
+
+/// maximum depth of the hierarchy (traversal stacks of this size cannot overflow)
+#define BVH_MAX_DEPTH 64
+
+/// relative cost increase at which bvh_s_refit rebuilds a subtree
+#define BVH_REFIT_THRESHOLD 1.3
+
+/** count > 0: leaf covering slots offs ... offs + count - 1
+ *  count = 0: inner node; left child at (node index) + 1, right child at offs
+ */
+#define TYPEOF_bvh_node_s typeof( "bvh_node_s" )
+typedef struct bvh_node_s
+{
+    u2_t offs;
+    u2_t count;
+} bvh_node_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( bvh_node_s )
+
+/**********************************************************************************************************************/
+/// bvh_node_arr_s
+
+#define TYPEOF_bvh_node_arr_s typeof( "bvh_node_arr_s" )
+typedef struct bvh_node_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            bvh_node_s* data;
+            uz_t size, space;
+        };
+    };
+} bvh_node_arr_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( bvh_node_arr_s )
+
+/**********************************************************************************************************************/
+/// bvh_f3_arr_s
+
+#define TYPEOF_bvh_f3_arr_s typeof( "bvh_f3_arr_s" )
+typedef struct bvh_f3_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            f3_t* data;
+            uz_t size, space;
+        };
+    };
+} bvh_f3_arr_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( bvh_f3_arr_s )
+
+/**********************************************************************************************************************/
+/// bvh_u2_arr_s
+
+#define TYPEOF_bvh_u2_arr_s typeof( "bvh_u2_arr_s" )
+typedef struct bvh_u2_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            u2_t* data;
+            uz_t size, space;
+        };
+    };
+} bvh_u2_arr_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( bvh_u2_arr_s )
+
+/**********************************************************************************************************************/
+/// bvh_s
+
+/** Bounds arrays (node_box, prim_box) hold six consecutive blocks of 'n' values each:
+ *  min.x, min.y, min.z, max.x, max.y, max.z; where n is the number of nodes or slots respectively.
+ */
+#define TYPEOF_bvh_s typeof( "bvh_s" )
+typedef struct bvh_s
+{
+    aware_t _;
+    bvh_node_arr_s node_arr; // depth-first; root at index 0
+    bvh_f3_arr_s   node_box; // node bounds
+    bvh_u2_arr_s   idx_arr;  // slot -> primitive index
+    bvh_f3_arr_s   prim_box; // primitive bounds in slot order
+    bvh_f3_arr_s   node_cost; // SAH cost of each subtree at construction (reference for bvh_s_refit)
+} bvh_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( bvh_s )
+
+/** Builds the hierarchy over 'size' primitives with bounds box_arr[ 0 ... size - 1 ]
+ *  using the surface area heuristic (SAH).
+ */
+void bvh_s_build( bvh_s* o, const box_s* box_arr, uz_t size );
+
+/** Updates all bounds after primitives have moved (box_arr as in bvh_s_build) keeping the topology.
+ *  Subtrees whose SAH cost grew beyond BVH_REFIT_THRESHOLD times their cost at construction are rebuilt.
+ *  Falls back to bvh_s_build when the number of primitives changed.
+ */
+void bvh_s_refit( bvh_s* o, const box_s* box_arr, uz_t size );
+
+/// bounds of all primitives
+box_s bvh_s_get_box( const bvh_s* o );
+
+/// slab test on a box in a bounds array of stride n (see bvh_s); returns entry offset or f3_inf
+static inline f3_t bvh_box_ray_entry( const f3_t* b, uz_t n, uz_t i, v3d_s p, v3d_s inv_d )
+{
+    f3_t x1 = ( b[ i         ] - p.x ) * inv_d.x, x2 = ( b[ i + 3 * n ] - p.x ) * inv_d.x;
+    f3_t y1 = ( b[ i +     n ] - p.y ) * inv_d.y, y2 = ( b[ i + 4 * n ] - p.y ) * inv_d.y;
+    f3_t z1 = ( b[ i + 2 * n ] - p.z ) * inv_d.z, z2 = ( b[ i + 5 * n ] - p.z ) * inv_d.z;
+
+    f3_t t_near = 0;
+    f3_t t_far  = f3_inf;
+    t_near = x1 < x2 ? ( x1 > t_near ? x1 : t_near ) : ( x2 > t_near ? x2 : t_near );
+    t_far  = x1 < x2 ? ( x2 < t_far  ? x2 : t_far  ) : ( x1 < t_far  ? x1 : t_far  );
+    t_near = y1 < y2 ? ( y1 > t_near ? y1 : t_near ) : ( y2 > t_near ? y2 : t_near );
+    t_far  = y1 < y2 ? ( y2 < t_far  ? y2 : t_far  ) : ( y1 < t_far  ? y1 : t_far  );
+    t_near = z1 < z2 ? ( z1 > t_near ? z1 : t_near ) : ( z2 > t_near ? z2 : t_near );
+    t_far  = z1 < z2 ? ( z2 < t_far  ? z2 : t_far  ) : ( z1 < t_far  ? z1 : t_far  );
+
+    return ( t_near <= t_far ) ? t_near : f3_inf;
+}
+
+static inline f3_t bvh_s_node_ray_entry( const bvh_s* o, uz_t node, v3d_s p, v3d_s inv_d )
+{
+    return bvh_box_ray_entry( o->node_box.data, o->node_arr.size, node, p, inv_d );
+}
+
+static inline f3_t bvh_s_slot_ray_entry( const bvh_s* o, uz_t slot, v3d_s p, v3d_s inv_d )
+{
+    return bvh_box_ray_entry( o->prim_box.data, o->idx_arr.size, slot, p, inv_d );
+}
+
+/**********************************************************************************************************************/
+
+vd_t bvh_signal_handler( const bcore_signal_s* o );
+
+#endif // BVH_H
@@ -22,6 +22,7 @@
 #include "vectors.h"
 #include "objects.h"
 #include "distance.h"
+#include "mesh.h"
 
 /**********************************************************************************************************************/
 
@@ -468,6 +469,18 @@ BCLOS_DEFINE_STD_CLOSURE( create_plane_s, "spect_obj create_plane_s()", create_p
 
 /**********************************************************************************************************************/
 
+/// empty polyhedron (entire space); planes are added via operator '&'
+static sr_s create_polyhedron_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 0 );
+    sr_s r = sr_create( typeof( "obj_polyhedron_s" ) );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_polyhedron_s, "spect_obj create_polyhedron_s()", create_polyhedron_s_call )
+
+/**********************************************************************************************************************/
+
 static sr_s create_sphere_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
 {
     ASSERT( args->size == 1 );
@@ -566,6 +579,61 @@ BCLOS_DEFINE_STD_CLOSURE( create_ellipsoid_s, "spect_obj create_ellipsoid_s( num
 /**********************************************************************************************************************/
 
 static sr_s create_torus_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    f3_t radius1 = sr_to_f3( bclos_arguments_s_get( args, 0, frm ) );
+    f3_t radius2 = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    return sr_asd( obj_torus_s_create_torus( radius1, radius2 ) );
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_torus_s, "spect_obj create_torus_s( num radius1, num radius2 )", create_torus_s_call )
+
+/**********************************************************************************************************************/
+
+/// triangle mesh from .obj, .ply or binary mesh file
+static sr_s create_mesh_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 1 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s r = sr_asd( obj_mesh_s_create_mesh( ( ( st_s* )arg0.o )->sc ) );
+    sr_down( arg0 );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_mesh_s, "spect_obj create_mesh_s( st_s file )", create_mesh_s_call )
+
+/**********************************************************************************************************************/
+
+/// convert_mesh( src_file, dst_file ): writes a mesh in binary format (see mesh.h)
+static sr_s convert_mesh_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    mesh_convert( ( ( st_s* )arg0.o )->sc, ( ( st_s* )arg1.o )->sc );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return sr_bl( true );
+}
+
+BCLOS_DEFINE_STD_CLOSURE( convert_mesh_s, "bl_t convert_mesh_s( st_s src_file, st_s dst_file )", convert_mesh_s_call )
+
+/**********************************************************************************************************************/
+
+/// empty sphere cloud; spheres are added via push_sphere( pos, radius )
+static sr_s create_sphere_cloud_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 0 );
+    sr_s r = sr_create( typeof( "obj_sphere_cloud_s" ) );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_sphere_cloud_s, "spect_obj create_sphere_cloud_s()", create_sphere_cloud_s_call )
+
+/**********************************************************************************************************************/
+
+/// torus as distance field (ray-marched); used where distance functions are combined
+static sr_s create_distance_torus_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
 {
     ASSERT( args->size == 2 );
     f3_t radius1 = sr_to_f3( bclos_arguments_s_get( args, 0, frm ) );
@@ -590,7 +658,209 @@ static sr_s create_torus_s_call( vc_t o, bclos_frame_s* frm, const bclos_argumen
     return r;
 }
 
-BCLOS_DEFINE_STD_CLOSURE( create_torus_s, "spect_obj create_torus_s( num radius1, num radius2 )", create_torus_s_call )
+BCLOS_DEFINE_STD_CLOSURE( create_distance_torus_s, "spect_obj create_distance_torus_s( num radius1, num radius2 )", create_distance_torus_s_call )
+
+/**********************************************************************************************************************/
+/// distance graph (sdf): composable distance functions
+
+static sr_s sdf_sphere_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 1 );
+    return sr_asd( distance_graph_s_create_sphere( sr_to_f3( bclos_arguments_s_get( args, 0, frm ) ) ) );
+}
+
+static sr_s sdf_box_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 1 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s r = sr_asd( distance_graph_s_create_box( *( v3d_s* )arg0.o ) );
+    sr_down( arg0 );
+    return r;
+}
+
+static sr_s sdf_torus_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    f3_t radius1 = sr_to_f3( bclos_arguments_s_get( args, 0, frm ) );
+    f3_t radius2 = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    return sr_asd( distance_graph_s_create_torus( radius1, radius2 ) );
+}
+
+static sr_s sdf_cylinder_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 1 );
+    return sr_asd( distance_graph_s_create_cylinder( sr_to_f3( bclos_arguments_s_get( args, 0, frm ) ) ) );
+}
+
+static sr_s sdf_plane_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    f3_t offs = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    sr_s r = sr_asd( distance_graph_s_create_plane( *( v3d_s* )arg0.o, offs ) );
+    sr_down( arg0 );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( sdf_sphere_s,   "distance_graph_s sdf_sphere_s( num radius )",               sdf_sphere_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_box_s,      "distance_graph_s sdf_box_s( v3d_s ext )",                   sdf_box_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_torus_s,    "distance_graph_s sdf_torus_s( num radius1, num radius2 )",  sdf_torus_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_cylinder_s, "distance_graph_s sdf_cylinder_s( num radius )",             sdf_cylinder_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_plane_s,    "distance_graph_s sdf_plane_s( v3d_s nor, num offs )",       sdf_plane_s_call )
+
+/**********************************************************************************************************************/
+
+typedef distance_graph_s* ( *sdf_binary_fp )( const distance_graph_s* a, const distance_graph_s* b );
+
+static sr_s sdf_binary_call( const bclos_arguments_s* args, bclos_frame_s* frm, sdf_binary_fp create )
+{
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    sr_s r = sr_asd( create( arg0.o, arg1.o ) );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+static sr_s sdf_union_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    return sdf_binary_call( args, frm, distance_graph_s_create_union );
+}
+
+static sr_s sdf_intersection_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    return sdf_binary_call( args, frm, distance_graph_s_create_intersection );
+}
+
+static sr_s sdf_difference_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    return sdf_binary_call( args, frm, distance_graph_s_create_difference );
+}
+
+static sr_s sdf_smooth_union_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 3 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    f3_t k = sr_to_f3( bclos_arguments_s_get( args, 2, frm ) );
+    sr_s r = sr_asd( distance_graph_s_create_smooth_union( arg0.o, arg1.o, k ) );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( sdf_union_s,        "distance_graph_s sdf_union_s( distance_graph_s a, distance_graph_s b )",               sdf_union_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_intersection_s, "distance_graph_s sdf_intersection_s( distance_graph_s a, distance_graph_s b )",        sdf_intersection_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_difference_s,   "distance_graph_s sdf_difference_s( distance_graph_s a, distance_graph_s b )",          sdf_difference_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_smooth_union_s, "distance_graph_s sdf_smooth_union_s( distance_graph_s a, distance_graph_s b, num k )", sdf_smooth_union_s_call )
+
+/**********************************************************************************************************************/
+
+static sr_s sdf_move_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    sr_s r = sr_asd( distance_graph_s_create_move( arg0.o, *( v3d_s* )arg1.o ) );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+static sr_s sdf_rotate_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    sr_s r = sr_asd( distance_graph_s_create_rotate( arg0.o, ( m3d_s* )arg1.o ) );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+static sr_s sdf_scale_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    f3_t fac = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    sr_s r = sr_asd( distance_graph_s_create_scale( arg0.o, fac ) );
+    sr_down( arg0 );
+    return r;
+}
+
+static sr_s sdf_repeat_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    sr_s r = sr_asd( distance_graph_s_create_repeat( arg0.o, *( v3d_s* )arg1.o ) );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+static sr_s sdf_displace_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 3 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    f3_t amplitude = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    sr_s arg2 = bclos_arguments_s_get( args, 2, frm );
+    sr_s r = sr_asd( distance_graph_s_create_displace( arg0.o, amplitude, *( v3d_s* )arg2.o ) );
+    sr_down( arg0 );
+    sr_down( arg2 );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( sdf_move_s,     "distance_graph_s sdf_move_s( distance_graph_s a, v3d_s vec )",                         sdf_move_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_rotate_s,   "distance_graph_s sdf_rotate_s( distance_graph_s a, m3d_s mat )",                       sdf_rotate_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_scale_s,    "distance_graph_s sdf_scale_s( distance_graph_s a, num fac )",                          sdf_scale_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_repeat_s,   "distance_graph_s sdf_repeat_s( distance_graph_s a, v3d_s period )",                    sdf_repeat_s_call )
+BCLOS_DEFINE_STD_CLOSURE( sdf_displace_s, "distance_graph_s sdf_displace_s( distance_graph_s a, num amplitude, v3d_s frequency )", sdf_displace_s_call )
+
+/**********************************************************************************************************************/
+
+/// object from a distance graph; radius: bounding sphere (envelope) around the origin
+static sr_s create_sdf_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    f3_t radius = sr_to_f3( bclos_arguments_s_get( args, 1, frm ) );
+    sr_s r = sr_create( typeof( "obj_distance_s" ) );
+    obj_distance_s_set_distance( r.o, arg0.o );
+    obj_distance_s_set_lipschitz( r.o, distance_graph_s_get_lipschitz( arg0.o ) );
+    sr_down( arg0 );
+
+    {
+        envelope_s* env = envelope_s_create();
+        env->radius = radius;
+        obj_set_envelope( r.o, env );
+        envelope_s_discard( env );
+    }
+
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_sdf_s, "spect_obj create_sdf_s( distance_graph_s graph, num radius )", create_sdf_s_call )
+
+/**********************************************************************************************************************/
+
+/// axis aligned box envelope spanned by two corners
+static sr_s create_envelope_box_s_call( vc_t o, bclos_frame_s* frm, const bclos_arguments_s* args )
+{
+    ASSERT( args->size == 2 );
+    sr_s arg0 = bclos_arguments_s_get( args, 0, frm );
+    sr_s arg1 = bclos_arguments_s_get( args, 1, frm );
+    sr_s r = sr_create( TYPEOF_envelope_s );
+    *( envelope_s* )r.o = envelope_create_box( *( v3d_s* )arg0.o, *( v3d_s* )arg1.o );
+    sr_down( arg0 );
+    sr_down( arg1 );
+    return r;
+}
+
+BCLOS_DEFINE_STD_CLOSURE( create_envelope_box_s, "envelope_s create_envelope_box_s( v3d_s p1, v3d_s p2 )", create_envelope_box_s_call )
 
 /**********************************************************************************************************************/
 
@@ -657,14 +927,37 @@ vd_t closures_signal_handler( const bcore_signal_s* o )
             // objects
             BCORE_REGISTER_OBJECT( create_beth_object_s );
             BCORE_REGISTER_OBJECT( create_plane_s );
+            BCORE_REGISTER_OBJECT( create_polyhedron_s );
             BCORE_REGISTER_OBJECT( create_sphere_s );
             BCORE_REGISTER_OBJECT( create_squaroid_s );
             BCORE_REGISTER_OBJECT( create_cylinder_s );
             BCORE_REGISTER_OBJECT( create_torus_s );
+            BCORE_REGISTER_OBJECT( create_distance_torus_s );
+            BCORE_REGISTER_OBJECT( create_mesh_s );
+            BCORE_REGISTER_OBJECT( convert_mesh_s );
+            BCORE_REGISTER_OBJECT( create_sphere_cloud_s );
             BCORE_REGISTER_OBJECT( create_hyperboloid1_s );
             BCORE_REGISTER_OBJECT( create_hyperboloid2_s );
             BCORE_REGISTER_OBJECT( create_ellipsoid_s );
             BCORE_REGISTER_OBJECT( create_cone_s );
+            BCORE_REGISTER_OBJECT( create_envelope_box_s );
+
+            // distance graph
+            BCORE_REGISTER_OBJECT( sdf_sphere_s );
+            BCORE_REGISTER_OBJECT( sdf_box_s );
+            BCORE_REGISTER_OBJECT( sdf_torus_s );
+            BCORE_REGISTER_OBJECT( sdf_cylinder_s );
+            BCORE_REGISTER_OBJECT( sdf_plane_s );
+            BCORE_REGISTER_OBJECT( sdf_union_s );
+            BCORE_REGISTER_OBJECT( sdf_intersection_s );
+            BCORE_REGISTER_OBJECT( sdf_difference_s );
+            BCORE_REGISTER_OBJECT( sdf_smooth_union_s );
+            BCORE_REGISTER_OBJECT( sdf_move_s );
+            BCORE_REGISTER_OBJECT( sdf_rotate_s );
+            BCORE_REGISTER_OBJECT( sdf_scale_s );
+            BCORE_REGISTER_OBJECT( sdf_repeat_s );
+            BCORE_REGISTER_OBJECT( sdf_displace_s );
+            BCORE_REGISTER_OBJECT( create_sdf_s );
 
             // time
             BCORE_REGISTER_OBJECT( get_time_s );
@@ -23,12 +23,14 @@
 
 #include "compound.h"
 #include "container.h"
+#include "gmath.h"
+#include "bvh.h"
 
 /**********************************************************************************************************************/
 /// trans_data_s // ray transition data
 
 BCORE_DEFINE_FUNCTIONS_OBJ_FLAT( trans_data_s )
-BCORE_DEFINE_CREATE_SELF( trans_data_s, "trans_data_s = bcore_inst { v3d_s exit_nor; private vc_t exit_obj; private vc_t enter_obj; }" )
+BCORE_DEFINE_CREATE_SELF( trans_data_s, "trans_data_s = bcore_inst { v3d_s exit_nor; private vc_t exit_obj; private vc_t enter_obj; bl_t enter_framed; v3d_s enter_pos; m3d_s enter_inv; }" )
 
 /**********************************************************************************************************************/
 /// compound_s
@@ -37,6 +39,10 @@ typedef struct compound_s
 {
     aware_t _;
     envelope_s* envelope;
+    bvh_s* bvh; // acceleration structure (created by compound_s_prepare)
+    bl_t bvh_stale; // elements were transformed; bvh bounds are outdated until refitted by compound_s_prepare
+    bvh_u2_arr_s bvh_map;   // bvh primitive index -> element index (bounded elements)
+    bvh_u2_arr_s unbounded; // element indices of unbounded elements (tested linearly when bvh is used)
     union
     {
         bcore_array_dyn_link_aware_s arr;
@@ -54,11 +60,61 @@ static sc_t compound_s_def =
 "{"
     "aware_t _;"
     "envelope_s => envelope;"
+    "bvh_s => bvh;"
+    "bl_t bvh_stale;"
+    "bvh_u2_arr_s bvh_map;"
+    "bvh_u2_arr_s unbounded;"
     "aware => [] object_arr;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_OBJ_INST( compound_s )
 
+/// instance_s (see section instance_s below)
+typedef struct instance_s
+{
+    aware_t _;
+    compound_s* compound; // shared
+    v3d_s pos;            // translation
+    m3d_s mat;            // linear map: compound frame -> world
+    m3d_s inv;            // inverse of mat
+} instance_s;
+
+/// frame of a hit object inside instances: scene position p corresponds to inv * ( p - pos )
+typedef struct hit_frame_s
+{
+    bl_t  framed; // false: scene frame
+    v3d_s pos;
+    m3d_s inv;
+} hit_frame_s;
+
+static f3_t instance_s_frame_hit( const instance_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame );
+static bl_t instance_s_get_auto_box( const instance_s* o, box_s* box );
+
+/// discards the acceleration structure (needed whenever the compound is modified)
+static void compound_s_reset_bvh( compound_s* o )
+{
+    if( o->bvh )
+    {
+        bvh_s_discard( o->bvh );
+        o->bvh = NULL;
+    }
+    o->bvh_stale = false;
+    bcore_array_a_set_size( (bcore_array*)&o->bvh_map, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->unbounded, 0 );
+}
+
+/// marks the acceleration structure for refitting (needed whenever elements are transformed)
+static void compound_s_stale_bvh( compound_s* o )
+{
+    if( o->bvh ) o->bvh_stale = true;
+}
+
+/// valid acceleration structure or NULL
+static inline const bvh_s* compound_s_get_bvh( const compound_s* o )
+{
+    return o->bvh_stale ? NULL : o->bvh;
+}
+
 uz_t compound_s_get_size( const compound_s* o )
 {
     return o ? o->size : 0;
@@ -70,6 +126,44 @@ void compound_s_set_envelope( compound_s* o, const envelope_s* envelope )
     o->envelope = envelope_s_clone( envelope );
 }
 
+/** Envelope compound_s_set_auto_envelope would set, but without modifying the compound or its elements
+ *  (compounds of instances are shared); returns false if the compound is unbounded or empty.
+ */
+static bl_t compound_s_auto_envelope( const compound_s* o, envelope_s* env )
+{
+    bl_t empty = true;
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        envelope_s env_l;
+        bl_t bounded = false;
+        vc_t obj = o->data[ i ];
+        tp_t type = *( aware_t* )obj;
+        if( type == TYPEOF_compound_s )
+        {
+            const compound_s* cmp = obj;
+            if( cmp->envelope ) env_l = *cmp->envelope;
+            bounded = cmp->envelope ? true : compound_s_auto_envelope( cmp, &env_l );
+        }
+        else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
+        {
+            const obj_hdr_s* hdr = obj;
+            if( hdr->prp.envelope ) env_l = *hdr->prp.envelope;
+            bounded = hdr->prp.envelope ? true : obj_auto_envelope( obj, &env_l );
+        }
+        else if( type == TYPEOF_instance_s )
+        {
+            box_s box;
+            bounded = instance_s_get_auto_box( obj, &box );
+            if( bounded ) env_l = envelope_of_box( box );
+        }
+
+        if( !bounded ) return false;
+        *env = empty ? env_l : envelope_of_pair( env, &env_l );
+        empty = false;
+    }
+    return !empty;
+}
+
 void compound_s_set_auto_envelope( compound_s* o )
 {
     if( o->envelope )
@@ -77,33 +171,56 @@ void compound_s_set_auto_envelope( compound_s* o )
         envelope_s_discard( o->envelope );
         o->envelope = NULL;
     }
+    compound_s_reset_bvh( o );
+    bl_t bounded = true;
     for( uz_t i = 0; i < o->size; i++ )
     {
-        envelope_s env = envelope_create( v3d_s_zero(), 0 );
+        const envelope_s* env = NULL;
+        envelope_s env_inst;
         vd_t obj = o->data[ i ];
         tp_t type = *( aware_t* )obj;
         if( type == TYPEOF_compound_s )
         {
             compound_s* cmp = obj;
             if( !cmp->envelope ) compound_s_set_auto_envelope( cmp );
-            env = *cmp->envelope;
+            env = cmp->envelope;
         }
         else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
         {
             obj_hdr_s* hdr = obj;
             if( !hdr->prp.envelope ) obj_set_auto_envelope( obj );
-            env = *hdr->prp.envelope;
+            env = hdr->prp.envelope;
+        }
+        else if( type == TYPEOF_instance_s )
+        {
+            box_s box;
+            if( instance_s_get_auto_box( obj, &box ) )
+            {
+                env_inst = envelope_of_box( box );
+                env = &env_inst;
+            }
         }
 
-        if( o->envelope )
+        if( !env )
+        {
+            bounded = false;
+        }
+        else if( o->envelope )
         {
-            *o->envelope = envelope_of_pair( o->envelope, &env );
+            *o->envelope = envelope_of_pair( o->envelope, env );
         }
         else
         {
-            o->envelope = envelope_s_clone( &env );
+            o->envelope = envelope_s_clone( env );
         }
     }
+
+    // an unbounded element leaves the compound without envelope
+    if( !bounded && o->envelope )
+    {
+        envelope_s_discard( o->envelope );
+        o->envelope = NULL;
+    }
 }
 
 const aware_t* compound_s_get_object( const compound_s* o, uz_t index )
@@ -113,12 +230,14 @@ const aware_t* compound_s_get_object( const compound_s* o, uz_t index )
 
 void compound_s_clear( compound_s* o )
 {
+    compound_s_reset_bvh( o );
     bcore_array_a_set_size( (bcore_array*)o, 0 );
 }
 
 vd_t compound_s_push_type( compound_s* o, tp_t type )
 {
-    if( type == TYPEOF_compound_s )
+    compound_s_reset_bvh( o );
+    if( type == TYPEOF_compound_s || type == TYPEOF_instance_s )
     {
         sr_s sr = sr_create( type );
         bcore_array_a_push( (bcore_array*)o, sr );
@@ -180,6 +299,31 @@ void compound_s_push_q( compound_s* o, const sr_s* object )
             }
         }
     }
+    else if( type == TYPEOF_instance_s )
+    {
+        vd_t dst = compound_s_push_type( o, TYPEOF_instance_s );
+        bcore_inst_t_copy( TYPEOF_instance_s, dst, object->o );
+        box_s box;
+        bl_t bounded = instance_s_get_box( dst, &box );
+        if( o->envelope )
+        {
+            if( bounded )
+            {
+                envelope_s env = envelope_of_box( box );
+                *o->envelope = envelope_of_pair( o->envelope, &env );
+            }
+            else
+            {
+                envelope_s_discard( o->envelope );
+                o->envelope = NULL;
+            }
+        }
+        else if( o->size == 1 && bounded )
+        {
+            envelope_s env = envelope_of_box( box );
+            o->envelope = envelope_s_clone( &env );
+        }
+    }
     else if( type == TYPEOF_map_s )
     {
         map_s* map = object->o;
@@ -212,92 +356,379 @@ void compound_s_push( compound_s* o, sr_s object )
     sr_down( object );
 }
 
-f3_t compound_s_ray_hit( const compound_s* o, const ray_s* ray, v3d_s* p_nor, vc_t* hit_obj )
+/// bounds of a compound; returns false in case the compound is unbounded
+static bl_t compound_s_get_box( const compound_s* o, box_s* box )
 {
-    if( o->envelope && !envelope_s_ray_hits( o->envelope, ray ) ) return f3_inf;
-    v3d_s nor;
-    f3_t min_a = f3_inf;
+    if( o->envelope )
+    {
+        *box = envelope_s_get_box( o->envelope );
+        return true;
+    }
+    if( compound_s_get_bvh( o ) && o->unbounded.size == 0 )
+    {
+        *box = bvh_s_get_box( o->bvh );
+        return true;
+    }
+    return false;
+}
+
+/// bounds of a compound element; returns false in case the element is unbounded
+static bl_t compound_element_box( vc_t element, box_s* box )
+{
+    tp_t type = *( aware_t* )element;
+    if( type == TYPEOF_compound_s ) return compound_s_get_box( element, box );
+    if( type == TYPEOF_instance_s ) return instance_s_get_box( element, box );
+
+    envelope_s env;
+    if( obj_bounds( element, &env ) )
+    {
+        *box = envelope_s_get_box( &env );
+        return true;
+    }
+    return false;
+}
+
+/// minimum number of elements for which an acceleration structure is built
+#define COMPOUND_BVH_MIN_SIZE 4
+
+/** Builds the acceleration structure or refits it after the compound was transformed.
+ *  Refitting keeps the hierarchy and only rebuilds degraded subtrees (see bvh_s_refit).
+ */
+void compound_s_prepare( compound_s* o )
+{
+    if( compound_s_get_bvh( o ) ) return;
+
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        tp_t type = *( aware_t* )o->data[ i ];
+        if( type == TYPEOF_compound_s ) compound_s_prepare( o->data[ i ] );
+        if( type == TYPEOF_instance_s ) instance_s_prepare( o->data[ i ] );
+    }
+
+    if( o->size < COMPOUND_BVH_MIN_SIZE ) return;
+
+    /* Unbounded elements (e.g. planes) are kept in a separate list and tested linearly;
+     * the remaining elements form the hierarchy.
+     */
+    box_s* box_arr = bcore_u_alloc( sizeof( box_s ), NULL, o->size, NULL );
+    bcore_array_a_set_size( (bcore_array*)&o->bvh_map,   o->size );
+    bcore_array_a_set_size( (bcore_array*)&o->unbounded, o->size );
+    uz_t bounded_size = 0;
+    uz_t unbounded_size = 0;
     for( uz_t i = 0; i < o->size; i++ )
     {
-        aware_t* element = o->data[ i ];
-        vc_t hit_obj_l = NULL;
-        f3_t a = f3_inf;
-        if( *element == TYPEOF_compound_s )
+        if( compound_element_box( o->data[ i ], &box_arr[ bounded_size ] ) )
         {
-            compound_s* cmp = ( compound_s* )element;
-            a = compound_s_ray_hit( cmp, ray, &nor, &hit_obj_l );
+            o->bvh_map.data[ bounded_size++ ] = i;
         }
         else
         {
-            hit_obj_l = ( obj_hdr_s* )element;
-            a = obj_ray_hit( hit_obj_l, ray, &nor );
+            o->unbounded.data[ unbounded_size++ ] = i;
         }
+    }
+    bcore_array_a_set_size( (bcore_array*)&o->bvh_map,   bounded_size );
+    bcore_array_a_set_size( (bcore_array*)&o->unbounded, unbounded_size );
 
-        if( a < min_a )
+    if( o->bvh_map.size >= COMPOUND_BVH_MIN_SIZE )
+    {
+        if( o->bvh )
         {
-            min_a = a;
-            if( p_nor ) *p_nor = nor;
-            if( hit_obj ) *hit_obj = hit_obj_l;
+            bvh_s_refit( o->bvh, box_arr, o->bvh_map.size );
+        }
+        else
+        {
+            o->bvh = bvh_s_create();
+            bvh_s_build( o->bvh, box_arr, o->bvh_map.size );
         }
+        o->bvh_stale = false;
     }
-    return min_a;
+    else
+    {
+        compound_s_reset_bvh( o );
+    }
+
+    bcore_free( box_arr );
 }
 
-f3_t compound_s_ray_trans_hit( const compound_s* o, const ray_s* ray, trans_data_s* trans )
+void compound_s_bake( compound_s* o, uz_t threads )
 {
-    if( o->envelope && !envelope_s_ray_hits( o->envelope, ray ) ) return f3_inf;
-    v3d_s nor;
-    f3_t min_a = f3_inf;
     for( uz_t i = 0; i < o->size; i++ )
     {
-        aware_t* element = o->data[ i ];
-        obj_hdr_s* hit_obj = NULL;
-        f3_t a = f3_inf;
-        if( *element == TYPEOF_compound_s )
+        tp_t type = *( aware_t* )o->data[ i ];
+        if( type == TYPEOF_compound_s )
         {
-            a = compound_s_ray_hit( ( compound_s* )element, ray, &nor, ( vc_t* )&hit_obj );
+            compound_s_bake( o->data[ i ], threads );
+        }
+        else if( type == TYPEOF_instance_s )
+        {
+            compound_s_bake( ( ( instance_s* )o->data[ i ] )->compound, threads );
         }
         else
         {
-            hit_obj = ( obj_hdr_s* )element;
-            a = obj_ray_hit( hit_obj, ray, &nor );
+            obj_bake( o->data[ i ], threads );
+        }
+    }
+}
+
+static f3_t compound_s_hit( const compound_s* o, const ray_s* ray, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame, trans_data_s* trans );
+
+/// sets the frame of enter_obj
+static inline void trans_data_s_set_enter_frame( trans_data_s* o, const hit_frame_s* frame )
+{
+    o->enter_framed = frame->framed;
+    o->enter_pos    = frame->pos;
+    o->enter_inv    = frame->inv;
+}
+
+/** Tests a single element and updates the closest hit 'p_min_a'.
+ *  trans == NULL: updates p_nor, hit_obj and p_frame (if not NULL)
+ *  trans != NULL: updates transition data
+ */
+static inline void compound_element_hit( const aware_t* element, const ray_s* ray, f3_t* p_min_a, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame, trans_data_s* trans )
+{
+    v3d_s nor;
+    vc_t hit_obj_l = NULL;
+    hit_frame_s frame = { .framed = false };
+    f3_t a = f3_inf;
+    if( *element == TYPEOF_compound_s )
+    {
+        a = compound_s_hit( ( const compound_s* )element, ray, &nor, &hit_obj_l, &frame, NULL );
+    }
+    else if( *element == TYPEOF_instance_s )
+    {
+        a = instance_s_frame_hit( ( const instance_s* )element, ray, &nor, &hit_obj_l, &frame );
+    }
+    else
+    {
+        hit_obj_l = element;
+        a = obj_ray_hit( hit_obj_l, ray, &nor );
+    }
+
+    f3_t min_a = *p_min_a;
+
+    if( !trans )
+    {
+        if( a < min_a )
+        {
+            *p_min_a = a;
+            if( p_nor ) *p_nor = nor;
+            if( hit_obj ) *hit_obj = hit_obj_l;
+            if( p_frame ) *p_frame = frame;
         }
+        return;
+    }
 
-        if( a < f3_inf )
+    if( a < f3_inf )
+    {
+        if( a < min_a - f3_eps )
         {
-            if( a < min_a - f3_eps )
+            *p_min_a = a;
+            if( v3d_s_mlv( nor, ray->d ) > 0 )
             {
-                min_a = a;
-                if( v3d_s_mlv( nor, ray->d ) > 0 )
-                {
-                    trans->exit_nor = nor;
-                    trans->exit_obj = hit_obj;
-                    trans->enter_obj = NULL;
-                }
-                else
-                {
-                    trans->exit_nor = v3d_s_neg( nor );
-                    trans->exit_obj = NULL;
-                    trans->enter_obj = hit_obj;
-                }
+                trans->exit_nor = nor;
+                trans->exit_obj = ( obj_hdr_s* )hit_obj_l;
+                trans->enter_obj = NULL;
+                trans->enter_framed = false;
+            }
+            else
+            {
+                trans->exit_nor = v3d_s_neg( nor );
+                trans->exit_obj = NULL;
+                trans->enter_obj = ( obj_hdr_s* )hit_obj_l;
+                trans_data_s_set_enter_frame( trans, &frame );
+            }
+        }
+        else if( f3_abs( a - min_a ) < f3_eps )
+        {
+            *p_min_a = a < min_a ? a : min_a;
+            if( v3d_s_mlv( nor, ray->d ) > 0 )
+            {
+                trans->exit_obj = ( obj_hdr_s* )hit_obj_l;
             }
-            else if( f3_abs( a - min_a ) < f3_eps )
+            else
+            {
+                trans->enter_obj = ( obj_hdr_s* )hit_obj_l;
+                trans_data_s_set_enter_frame( trans, &frame );
+            }
+        }
+    }
+}
+
+static inline bl_t compound_element_occluded( const aware_t* element, const ray_s* ray, f3_t max_dist )
+{
+    if( *element == TYPEOF_compound_s ) return compound_s_ray_occluded( ( const compound_s* )element, ray, max_dist );
+    if( *element == TYPEOF_instance_s ) return instance_s_ray_occluded( ( const instance_s* )element, ray, max_dist );
+    return obj_ray_occluded( element, ray, max_dist );
+}
+
+/** Front-to-back traversal of the hierarchy.
+ *  A node is skipped when its entry offset lies beyond the closest hit found so far.
+ *  The margin accounts for hits being reported f3_eps before the surface and (for transitions)
+ *  for coincident surfaces within f3_eps.
+ *  Elements are only accessed after their bounds (stored in the hierarchy) are hit.
+ */
+static void compound_s_bvh_hit( const compound_s* o, const ray_s* ray, f3_t* p_min_a, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame, trans_data_s* trans )
+{
+    const bvh_s* bvh = o->bvh;
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    const u2_t* idx_arr = bvh->idx_arr.data;
+    const u2_t* map = o->bvh_map.data;
+    vd_t* data = o->data;
+
+    f3_t margin = trans ? 2.0 * f3_eps : f3_eps;
+    v3d_s p = ray->p;
+    v3d_s inv_d = ray_inv_dir( ray );
+
+    uz_t stack_node[ BVH_MAX_DEPTH ];
+    f3_t stack_offs[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+
+    f3_t min_a = *p_min_a;
+    if( !( bvh_s_node_ray_entry( bvh, 0, p, inv_d ) < min_a + margin ) ) return;
+
+    uz_t node = 0;
+    bl_t active = true;
+    while( active )
+    {
+        const bvh_node_s* nd = &node_arr[ node ];
+        if( nd->count > 0 )
+        {
+            for( uz_t i = nd->offs; i < nd->offs + nd->count; i++ )
             {
-                min_a = a < min_a ? a : min_a;
-                if( v3d_s_mlv( nor, ray->d ) > 0 )
+                if( bvh_s_slot_ray_entry( bvh, i, p, inv_d ) < min_a + margin )
                 {
-                    trans->exit_obj = hit_obj;
+                    compound_element_hit( data[ map[ idx_arr[ i ] ] ], ray, &min_a, p_nor, hit_obj, p_frame, trans );
                 }
-                else
+            }
+        }
+        else
+        {
+            uz_t near = node + 1;
+            uz_t far  = nd->offs;
+            f3_t near_offs = bvh_s_node_ray_entry( bvh, near, p, inv_d );
+            f3_t far_offs  = bvh_s_node_ray_entry( bvh, far,  p, inv_d );
+            if( far_offs < near_offs )
+            {
+                uz_t t = near; near = far; far = t;
+                f3_t t_offs = near_offs; near_offs = far_offs; far_offs = t_offs;
+            }
+
+            if( near_offs < min_a + margin )
+            {
+                if( far_offs < min_a + margin )
                 {
-                    trans->enter_obj = hit_obj;
+                    stack_node[ stack_size ] = far;
+                    stack_offs[ stack_size ] = far_offs;
+                    stack_size++;
                 }
+                node = near;
+                continue;
+            }
+        }
+
+        active = false;
+        while( stack_size > 0 )
+        {
+            stack_size--;
+            if( stack_offs[ stack_size ] < min_a + margin )
+            {
+                node = stack_node[ stack_size ];
+                active = true;
+                break;
             }
         }
     }
+
+    *p_min_a = min_a;
+}
+
+static f3_t compound_s_hit( const compound_s* o, const ray_s* ray, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame, trans_data_s* trans )
+{
+    if( o->envelope && !envelope_s_ray_hits( o->envelope, ray ) ) return f3_inf;
+
+    f3_t min_a = f3_inf;
+    if( compound_s_get_bvh( o ) )
+    {
+        // unbounded elements first: a close hit (e.g. on a ground plane) prunes the hierarchy
+        for( uz_t i = 0; i < o->unbounded.size; i++ ) compound_element_hit( o->data[ o->unbounded.data[ i ] ], ray, &min_a, p_nor, hit_obj, p_frame, trans );
+        compound_s_bvh_hit( o, ray, &min_a, p_nor, hit_obj, p_frame, trans );
+        return min_a;
+    }
+
+    for( uz_t i = 0; i < o->size; i++ ) compound_element_hit( o->data[ i ], ray, &min_a, p_nor, hit_obj, p_frame, trans );
     return min_a;
 }
 
+f3_t compound_s_ray_hit( const compound_s* o, const ray_s* ray, v3d_s* p_nor, vc_t* hit_obj )
+{
+    return compound_s_hit( o, ray, p_nor, hit_obj, NULL, NULL );
+}
+
+f3_t compound_s_ray_trans_hit( const compound_s* o, const ray_s* ray, trans_data_s* trans )
+{
+    return compound_s_hit( o, ray, NULL, NULL, NULL, trans );
+}
+
+/// any-hit traversal; order of nodes is irrelevant
+static bl_t compound_s_bvh_occluded( const compound_s* o, const ray_s* ray, f3_t max_dist )
+{
+    const bvh_s* bvh = o->bvh;
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    const u2_t* idx_arr = bvh->idx_arr.data;
+    const u2_t* map = o->bvh_map.data;
+    vd_t* data = o->data;
+
+    f3_t limit = max_dist + f3_eps;
+    v3d_s p = ray->p;
+    v3d_s inv_d = ray_inv_dir( ray );
+
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+
+    if( !( bvh_s_node_ray_entry( bvh, 0, p, inv_d ) < limit ) ) return false;
+
+    stack[ stack_size++ ] = 0;
+    while( stack_size > 0 )
+    {
+        const bvh_node_s* nd = &node_arr[ stack[ --stack_size ] ];
+        if( nd->count > 0 )
+        {
+            for( uz_t i = nd->offs; i < nd->offs + nd->count; i++ )
+            {
+                if( bvh_s_slot_ray_entry( bvh, i, p, inv_d ) < limit && compound_element_occluded( data[ map[ idx_arr[ i ] ] ], ray, max_dist ) ) return true;
+            }
+        }
+        else
+        {
+            uz_t left  = ( nd - node_arr ) + 1;
+            uz_t right = nd->offs;
+            if( bvh_s_node_ray_entry( bvh, right, p, inv_d ) < limit ) stack[ stack_size++ ] = right;
+            if( bvh_s_node_ray_entry( bvh, left,  p, inv_d ) < limit ) stack[ stack_size++ ] = left;
+        }
+    }
+
+    return false;
+}
+
+bl_t compound_s_ray_occluded( const compound_s* o, const ray_s* ray, f3_t max_dist )
+{
+    if( o->envelope && !envelope_s_ray_hits( o->envelope, ray ) ) return false;
+    if( compound_s_get_bvh( o ) )
+    {
+        for( uz_t i = 0; i < o->unbounded.size; i++ )
+        {
+            if( compound_element_occluded( o->data[ o->unbounded.data[ i ] ], ray, max_dist ) ) return true;
+        }
+        return compound_s_bvh_occluded( o, ray, max_dist );
+    }
+
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        if( compound_element_occluded( o->data[ i ], ray, max_dist ) ) return true;
+    }
+    return false;
+}
+
 uz_t compound_s_side_count( const compound_s* o, v3d_s pos, s2_t side )
 {
     uz_t count = 0;
@@ -317,6 +748,7 @@ static bcore_self_s* compound_s_create_self( void )
 void compound_s_move( compound_s* o, const v3d_s* vec )
 {
     if( o->envelope ) envelope_s_move( o->envelope, vec );
+    compound_s_stale_bvh( o );
     for( uz_t i = 0; i < o->size; i++ )
     {
         vd_t obj = o->data[ i ];
@@ -327,6 +759,10 @@ void compound_s_move( compound_s* o, const v3d_s* vec )
             {
                 compound_s_move( obj, vec );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_move( obj, vec );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_move( obj, vec );
@@ -338,6 +774,7 @@ void compound_s_move( compound_s* o, const v3d_s* vec )
 void compound_s_rotate( compound_s* o, const m3d_s* mat )
 {
     if( o->envelope ) envelope_s_rotate( o->envelope, mat );
+    compound_s_stale_bvh( o );
     for( uz_t i = 0; i < o->size; i++ )
     {
         vd_t obj = o->data[ i ];
@@ -348,6 +785,10 @@ void compound_s_rotate( compound_s* o, const m3d_s* mat )
             {
                 compound_s_rotate( obj, mat );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_rotate( obj, mat );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_rotate( obj, mat );
@@ -359,6 +800,7 @@ void compound_s_rotate( compound_s* o, const m3d_s* mat )
 void compound_s_scale( compound_s* o, f3_t fac )
 {
     if( o->envelope ) envelope_s_scale( o->envelope, fac );
+    compound_s_stale_bvh( o );
     for( uz_t i = 0; i < o->size; i++ )
     {
         vd_t obj = o->data[ i ];
@@ -369,6 +811,10 @@ void compound_s_scale( compound_s* o, f3_t fac )
             {
                 compound_s_scale( obj, fac );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_scale( obj, fac );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_scale( obj, fac );
@@ -390,7 +836,7 @@ sr_s compound_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
         sr_s obj = meval_s_eval( ev, sr_null() );
         tp_t type = sr_s_type( &obj );
-        if( type != TYPEOF_compound_s && !bcore_trait_is_of( type, TYPEOF_spect_obj ) )
+        if( type != TYPEOF_compound_s && type != TYPEOF_instance_s && !bcore_trait_is_of( type, TYPEOF_spect_obj ) )
         {
             meval_s_err_fa( ev, "Cannot push '#<sc_t>' to compound_s.", ifnameof( type ) );
         }
@@ -427,14 +873,12 @@ sr_s compound_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         }
         else if( sr_s_type( &v ) == TYPEOF_obj_sphere_s )
         {
-            envelope_s env;
-            env.pos = ( ( obj_hdr_s* )v.o )->prp.pos;
-            env.radius = obj_sphere_s_get_radius( v.o );
+            envelope_s env = envelope_create( ( ( obj_hdr_s* )v.o )->prp.pos, obj_sphere_s_get_radius( v.o ) );
             compound_s_set_envelope( sr_o->o, &env );
         }
         else
         {
-            meval_s_err_fa( ev, "Object '#<sc_t>' cannot be used as envelope (use a sphere).", ifnameof( sr_s_type( &v ) ) );
+            meval_s_err_fa( ev, "Object '#<sc_t>' cannot be used as envelope (use a sphere or an envelope).", ifnameof( sr_s_type( &v ) ) );
         }
 
         sr_down( v );
@@ -446,6 +890,19 @@ sr_s compound_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
         compound_s_set_auto_envelope( sr_o->o );
     }
+    else if( key == typeof( "prepare" ) )
+    {
+        // builds the hierarchy now; transformed copies of the compound then only need a refit
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+        compound_s_prepare( sr_o->o );
+    }
+    else if( key == typeof( "create_instance" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+        ret = sr_tsd( TYPEOF_instance_s, instance_s_create_instance( o ) );
+    }
     else
     {
         meval_s_err_fa( ev, "Compound has no element of name #<sc_t>.", meval_s_get_name( ev, key ) );
@@ -454,6 +911,192 @@ sr_s compound_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
     return sr_fork( ret );
 }
 
+/**********************************************************************************************************************/
+/// instance_s
+
+static sc_t instance_s_def =
+"instance_s = bcore_inst"
+"{"
+    "aware_t _;"
+    "compound_s -> compound;"
+    "v3d_s pos;"
+    "m3d_s mat;"
+    "m3d_s inv;"
+    "func ap_t init = instance_s_init_a;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( instance_s, instance_s_def )
+
+static void instance_s_init_a( vd_t nc )
+{
+    struct { ap_t a; vc_t p; instance_s* o; } * nc_l = nc;
+    nc_l->a( nc ); // default
+    nc_l->o->mat = m3d_s_ident();
+    nc_l->o->inv = m3d_s_ident();
+}
+
+instance_s* instance_s_create_instance( const compound_s* compound )
+{
+    instance_s* o = instance_s_create();
+    o->compound = compound_s_clone( compound );
+    return o;
+}
+
+void instance_s_prepare( instance_s* o )
+{
+    compound_s_prepare( o->compound );
+}
+
+/// bounds of the transformed box_l
+static box_s instance_s_map_box( const instance_s* o, box_s box_l )
+{
+    box_s box;
+    v3d_s c = v3d_s_add( m3d_s_mlv( &o->mat, box_s_center( box_l ) ), o->pos );
+    v3d_s e_l = v3d_s_mlf( v3d_s_sub( box_l.max, box_l.min ), 0.5 );
+    const m3d_s* m = &o->mat;
+    v3d_s e;
+    e.x = f3_abs( m->x.x ) * e_l.x + f3_abs( m->x.y ) * e_l.y + f3_abs( m->x.z ) * e_l.z;
+    e.y = f3_abs( m->y.x ) * e_l.x + f3_abs( m->y.y ) * e_l.y + f3_abs( m->y.z ) * e_l.z;
+    e.z = f3_abs( m->z.x ) * e_l.x + f3_abs( m->z.y ) * e_l.y + f3_abs( m->z.z ) * e_l.z;
+
+    box.min = v3d_s_sub( c, e );
+    box.max = v3d_s_add( c, e );
+    return box;
+}
+
+bl_t instance_s_get_box( const instance_s* o, box_s* box )
+{
+    box_s box_l;
+    if( !compound_s_get_box( o->compound, &box_l ) ) return false;
+    *box = instance_s_map_box( o, box_l );
+    return true;
+}
+
+/// instance_s_get_box; computes the envelope of a compound without bounds locally (the compound is shared)
+static bl_t instance_s_get_auto_box( const instance_s* o, box_s* box )
+{
+    if( instance_s_get_box( o, box ) ) return true;
+    envelope_s env;
+    if( !compound_s_auto_envelope( o->compound, &env ) ) return false;
+    *box = instance_s_map_box( o, envelope_s_get_box( &env ) );
+    return true;
+}
+
+/// transforms ray into the compound's frame (normalized direction); returns the length of the transformed direction
+static inline f3_t instance_s_ray_to_local( const instance_s* o, const ray_s* r, ray_s* ray )
+{
+    ray->p = m3d_s_mlv( &o->inv, v3d_s_sub( r->p, o->pos ) );
+    ray->d = m3d_s_mlv( &o->inv, r->d );
+    f3_t d_length = sqrt( v3d_s_sqr( ray->d ) );
+    ray->d = v3d_s_mlf( ray->d, ( d_length > 0 ) ? ( 1.0 / d_length ) : 0 );
+    return d_length;
+}
+
+/// instance_s_ray_hit; p_frame (if not NULL) receives the frame of the hit object
+static f3_t instance_s_frame_hit( const instance_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj, hit_frame_s* p_frame )
+{
+    ray_s ray;
+    f3_t d_length = instance_s_ray_to_local( o, r, &ray );
+    if( d_length == 0 ) return f3_inf;
+
+    v3d_s nor;
+    hit_frame_s frame = { .framed = false };
+    f3_t a = compound_s_hit( o->compound, &ray, &nor, hit_obj, &frame, NULL );
+    if( a >= f3_inf ) return f3_inf;
+
+    // normals transform by the transposed inverse
+    if( p_nor ) *p_nor = v3d_s_of_length( m3d_s_tmlv( &o->inv, nor ), 1.0 );
+
+    if( p_frame )
+    {
+        if( frame.framed )
+        {
+            // nested instance: p -> frame.inv * ( o->inv * ( p - o->pos ) - frame.pos )
+            m3d_s inv_t = m3d_s_transposed( o->inv );
+            p_frame->pos = v3d_s_add( o->pos, m3d_s_mlv( &o->mat, frame.pos ) );
+            p_frame->inv = m3d_s_mlm( &inv_t, &frame.inv ); // frame.inv * o->inv
+        }
+        else
+        {
+            p_frame->pos = o->pos;
+            p_frame->inv = o->inv;
+        }
+        p_frame->framed = true;
+    }
+
+    return ( a + f3_eps ) / d_length - f3_eps;
+}
+
+f3_t instance_s_ray_hit( const instance_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj )
+{
+    return instance_s_frame_hit( o, r, p_nor, hit_obj, NULL );
+}
+
+bl_t instance_s_ray_occluded( const instance_s* o, const ray_s* r, f3_t max_dist )
+{
+    ray_s ray;
+    f3_t d_length = instance_s_ray_to_local( o, r, &ray );
+    if( d_length == 0 ) return false;
+
+    // inverse of the offset mapping in instance_s_ray_hit
+    return compound_s_ray_occluded( o->compound, &ray, ( max_dist + f3_eps ) * d_length - f3_eps );
+}
+
+void instance_s_move( instance_s* o, const v3d_s* vec )
+{
+    v3d_s_o_add( &o->pos, *vec );
+}
+
+void instance_s_rotate( instance_s* o, const m3d_s* mat )
+{
+    m3d_s mat_t = m3d_s_transposed( o->mat );
+    o->pos = m3d_s_mlv( mat, o->pos );
+    o->mat = m3d_s_transposed( m3d_s_mlm( mat, &mat_t ) ); // mat * o->mat
+    o->inv = m3d_s_mlm( mat, &o->inv );                    // o->inv * transposed( mat )
+}
+
+void instance_s_scale( instance_s* o, f3_t fac )
+{
+    if( fac == 0 ) return;
+    v3d_s_o_mlf( &o->pos, fac );
+    o->mat = m3d_s_mlf( &o->mat, fac );
+    o->inv = m3d_s_mlf( &o->inv, 1.0 / fac );
+}
+
+sr_s instance_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
+{
+    if( !sr_o ) return sr_null();
+    assert( sr_s_type( sr_o ) == TYPEOF_instance_s );
+    instance_s* o = sr_o->o;
+
+    if( key == TYPEOF_move )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        v3d_s v = meval_s_eval_v3d( ev );
+        instance_s_move( o, &v );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == TYPEOF_rotate )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        m3d_s rot = meval_s_eval_rot( ev );
+        instance_s_rotate( o, &rot );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == TYPEOF_scale )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        instance_s_scale( o, meval_s_eval_f3( ev ) );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else
+    {
+        meval_s_err_fa( ev, "Instance has no element of name #<sc_t>.", meval_s_get_name( ev, key ) );
+    }
+
+    return sr_null();
+}
+
 /**********************************************************************************************************************/
 
 vd_t compound_signal_handler( const bcore_signal_s* o )
@@ -464,6 +1107,8 @@ vd_t compound_signal_handler( const bcore_signal_s* o )
         {
             BCORE_REGISTER_OBJECT( trans_data_s );
             BCORE_REGISTER_OBJECT( compound_s );
+            BCORE_REGISTER_OBJECT( instance_s );
+            BCORE_REGISTER_FUNC(   instance_s_init_a );
         }
         break;
 
@@ -33,10 +33,21 @@ typedef struct trans_data_s
     v3d_s exit_nor;
     obj_hdr_s* exit_obj;
     obj_hdr_s* enter_obj;
+
+    /// frame of enter_obj inside instances: scene position p corresponds to enter_inv * ( p - enter_pos )
+    bl_t  enter_framed;
+    v3d_s enter_pos;
+    m3d_s enter_inv;
 } trans_data_s;
 
 BCORE_DECLARE_FUNCTIONS_OBJ( trans_data_s )
 
+/// position in the frame of enter_obj (to be used for textures and radiance of enter_obj)
+static inline v3d_s trans_data_s_enter_pos( const trans_data_s* o, v3d_s pos )
+{
+    return o->enter_framed ? m3d_s_mlv( &o->enter_inv, v3d_s_sub( pos, o->enter_pos ) ) : pos;
+}
+
 /**********************************************************************************************************************/
 /// compound_s (array of objects)
 
@@ -54,14 +65,27 @@ void compound_s_set_auto_envelope( compound_s* o );
 /// empties compound
 void compound_s_clear( compound_s* o );
 
-/// pushes an object to compound (copies object)
+/// pushes an object to compound (copies object; instances share their compound)
 void compound_s_push_q( compound_s* o, const sr_s* object );
 void compound_s_push(   compound_s* o, sr_s object );
 
+/** Prepares compound for rendering by building a bounding volume hierarchy (recursively for nested compounds).
+ *  Unbounded elements (e.g. planes) are excluded from the hierarchy and tested linearly.
+ *  After move, rotate or scale the hierarchy is refitted; other modifications require a rebuild.
+ *  Without hierarchy (too few bounded elements or compound modified after preparation) elements are tested linearly.
+ */
+void compound_s_prepare( compound_s* o );
+
+/// bakes distance objects that requested it (see obj_distance_s_set_bake) using 'threads' threads (recursively)
+void compound_s_bake( compound_s* o, uz_t threads );
+
 /// computes an object hit by given ray; returns f3_inf in case of no hit
 f3_t compound_s_ray_hit( const compound_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj );
 f3_t compound_s_ray_trans_hit( const compound_s* o, const ray_s* r, trans_data_s* trans );
 
+/// returns true when any object is hit at an offset <= max_dist (stops at first such hit)
+bl_t compound_s_ray_occluded( const compound_s* o, const ray_s* r, f3_t max_dist );
+
 /// counts number of objects where pos is on the side 'side'
 uz_t compound_s_side_count( const compound_s* o, v3d_s pos, s2_t side );
 
@@ -72,6 +96,38 @@ void compound_s_scale(  compound_s* o, f3_t fac );
 /// executes a function given by key
 sr_s compound_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key );
 
+/**********************************************************************************************************************/
+/// instance_s (compound placed by an affine transform)
+
+/** The compound of an instance is shared among all copies of the instance (copying or pushing an instance
+ *  does not copy the compound) and must not be modified once instantiated.
+ *  Rays are transformed into the compound's frame at traversal time.
+ *  Surface properties are taken from the shared objects; position dependent textures and radiance
+ *  refer to the compound's frame: compound_s_ray_trans_hit reports that frame (trans_data_s_enter_pos).
+ */
+typedef struct instance_s instance_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( instance_s )
+
+/// creates an instance of a copy of compound with identity transform
+instance_s* instance_s_create_instance( const compound_s* compound );
+
+/// prepares the shared compound (see compound_s_prepare)
+void instance_s_prepare( instance_s* o );
+
+/// axis aligned bounds of the instance; returns false in case the compound is unbounded
+bl_t instance_s_get_box( const instance_s* o, box_s* box );
+
+f3_t instance_s_ray_hit( const instance_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj );
+bl_t instance_s_ray_occluded( const instance_s* o, const ray_s* r, f3_t max_dist );
+
+void instance_s_move(   instance_s* o, const v3d_s* vec );
+void instance_s_rotate( instance_s* o, const m3d_s* mat );
+void instance_s_scale(  instance_s* o, f3_t fac );
+
+/// executes a function given by key
+sr_s instance_s_meval_key( sr_s* sr_o, meval_s* ev, tp_t key );
+
 /**********************************************************************************************************************/
 
 vd_t compound_signal_handler( const bcore_signal_s* o );
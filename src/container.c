@@ -87,6 +87,10 @@ void map_s_move( map_s* o, const v3d_s* vec )
             {
                 compound_s_move( sr->o, vec );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_move( sr->o, vec );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_move( sr->o, vec );
@@ -116,6 +120,10 @@ void map_s_rotate( map_s* o, const m3d_s* mat )
             {
                 compound_s_rotate( sr->o, mat );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_rotate( sr->o, mat );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_rotate( sr->o, mat );
@@ -145,6 +153,10 @@ void map_s_scale( map_s* o, f3_t fac )
             {
                 compound_s_scale( sr->o, fac );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_scale( sr->o, fac );
+            }
             else if( bcore_trait_is_of( sr_s_type( sr ), TYPEOF_spect_obj ) )
             {
                 obj_scale( sr->o, fac );
@@ -307,6 +319,10 @@ void arr_s_move( arr_s* o, const v3d_s* vec )
             {
                 compound_s_move( sr->o, vec );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_move( sr->o, vec );
+            }
             else if( bcore_trait_is_of( sr_s_type( sr ), TYPEOF_spect_obj ) )
             {
                 obj_move( sr->o, vec );
@@ -336,6 +352,10 @@ void arr_s_rotate( arr_s* o, const m3d_s* mat )
             {
                 compound_s_rotate( sr->o, mat );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_rotate( sr->o, mat );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_rotate( sr->o, mat );
@@ -365,6 +385,10 @@ void arr_s_scale( arr_s* o, f3_t fac )
             {
                 compound_s_scale( sr->o, fac );
             }
+            else if( type == TYPEOF_instance_s )
+            {
+                instance_s_scale( sr->o, fac );
+            }
             else if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
             {
                 obj_scale( sr->o, fac );
@@ -382,11 +406,20 @@ sr_s arr_s_create_inside_composite( arr_s* o, uz_t start, uz_t size )
     }
     else
     {
-        return obj_pair_inside_s_create_pair_sr
-        (
-            arr_s_create_inside_composite( o, start, size >> 1 ),
-            arr_s_create_inside_composite( o, start + ( size >> 1 ), size - ( size >> 1 ) )
-        );
+        sr_s o1 = arr_s_create_inside_composite( o, start, size >> 1 );
+        sr_s o2 = arr_s_create_inside_composite( o, start + ( size >> 1 ), size - ( size >> 1 ) );
+
+        // planes are merged into a single polyhedron
+        if( bcore_trait_is_of( sr_s_type( &o1 ), TYPEOF_spect_obj ) && bcore_trait_is_of( sr_s_type( &o2 ), TYPEOF_spect_obj ) &&
+            obj_polyhedron_s_is_mergeable( o1.o ) && obj_polyhedron_s_is_mergeable( o2.o ) )
+        {
+            sr_s ret = sr_asd( obj_polyhedron_s_create_pair( o1.o, o2.o ) );
+            sr_down( o1 );
+            sr_down( o2 );
+            return ret;
+        }
+
+        return obj_pair_inside_s_create_pair_sr( o1, o2 );
     }
     return sr_null();
 }
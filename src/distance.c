@@ -16,6 +16,9 @@
  */
 
 #include "bcore_trait.h"
+#include "bcore_spect_array.h"
+#include "bcore_threads.h"
+#include "bcore_bin_ml.h"
 #include "distance.h"
 
 /**********************************************************************************************************************/
@@ -24,7 +27,8 @@
 typedef struct distance_sphere_s
 {
     aware_t _;
-    distance_fp fp_distance;
+    distance_fp   fp_distance;
+    distance_n_fp fp_distance_n;
 } distance_sphere_s;
 
 static sc_t distance_sphere_s_def =
@@ -32,6 +36,7 @@ static sc_t distance_sphere_s_def =
 "{"
     "aware_t _;"
     "fp_t fp_distance;"
+    "fp_t fp_distance_n;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_OBJ_INST( distance_sphere_s )
@@ -61,7 +66,8 @@ static bcore_self_s* distance_sphere_s_create_self( void )
 typedef struct distance_torus_s
 {
     aware_t _;
-    distance_fp fp_distance;
+    distance_fp   fp_distance;
+    distance_n_fp fp_distance_n;
     f3_t ex_radius; // ex-planar radius
 } distance_torus_s;
 
@@ -70,6 +76,7 @@ static sc_t distance_torus_s_def =
 "{"
     "aware_t _;"
     "fp_t fp_distance;"
+    "fp_t fp_distance_n;"
     "f3_t ex_radius = 0.5;" // ex-planar radius
 "}";
 
@@ -105,6 +112,743 @@ static bcore_self_s* distance_torus_s_create_self( void )
     return self;
 }
 
+/**********************************************************************************************************************/
+/// distance_graph_s
+
+enum
+{
+    DISTANCE_OP_SPHERE = 1,   // f: radius
+    DISTANCE_OP_BOX,          // v: half edge lengths
+    DISTANCE_OP_TORUS,        // f: radius1; v.x: radius2
+    DISTANCE_OP_CYLINDER,     // f: radius
+    DISTANCE_OP_PLANE,        // v: normal; f: offset
+    DISTANCE_OP_UNION,
+    DISTANCE_OP_INTERSECTION,
+    DISTANCE_OP_DIFFERENCE,
+    DISTANCE_OP_SMOOTH_UNION, // f: blend radius
+    DISTANCE_OP_PUSH_POS,
+    DISTANCE_OP_POP_POS,
+    DISTANCE_OP_MOVE,         // pos -= v
+    DISTANCE_OP_ROTATE,       // pos = m * pos
+    DISTANCE_OP_SCALE,        // pos *= f
+    DISTANCE_OP_MUL,          // dist *= f
+    DISTANCE_OP_REPEAT,       // v: period
+    DISTANCE_OP_DISPLACE,     // f: amplitude; v: frequency
+};
+
+typedef struct distance_op_s
+{
+    u2_t  op;
+    f3_t  f;
+    v3d_s v;
+    m3d_s m;
+} distance_op_s;
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( distance_op_s, "distance_op_s = bcore_inst { u2_t op; f3_t f; v3d_s v; m3d_s m; }" )
+
+#define TYPEOF_distance_graph_s typeof( "distance_graph_s" )
+typedef struct distance_graph_s
+{
+    aware_t _;
+    distance_fp   fp_distance;
+    distance_n_fp fp_distance_n;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            distance_op_s* data;
+            uz_t size, space;
+        };
+    };
+    uz_t val_depth; // required depth of the value stack
+    uz_t pos_depth; // required depth of the position stack
+    f3_t lipschitz; // upper bound of the gradient magnitude
+} distance_graph_s;
+
+static sc_t distance_graph_s_def =
+"distance_graph_s = distance"
+"{"
+    "aware_t _;"
+    "fp_t fp_distance;"
+    "fp_t fp_distance_n;"
+    "distance_op_s [] arr;"
+    "uz_t val_depth;"
+    "uz_t pos_depth;"
+    "f3_t lipschitz;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_OBJ_INST( distance_graph_s )
+
+static void distance_graph_s_push_op( distance_graph_s* o, u2_t op, f3_t f, v3d_s v, const m3d_s* m )
+{
+    bcore_array_a_set_size( ( bcore_array* )o, o->size + 1 );
+    distance_op_s* ins = &o->data[ o->size - 1 ];
+    ins->op = op;
+    ins->f  = f;
+    ins->v  = v;
+    ins->m  = m ? *m : m3d_s_ident();
+}
+
+static void distance_graph_s_append( distance_graph_s* o, const distance_graph_s* a )
+{
+    uz_t size = o->size;
+    bcore_array_a_set_size( ( bcore_array* )o, size + a->size );
+    for( uz_t i = 0; i < a->size; i++ ) o->data[ size + i ] = a->data[ i ];
+}
+
+static void distance_graph_s_check_depth( const distance_graph_s* o )
+{
+    if( o->val_depth > DISTANCE_GRAPH_STACK_SIZE || o->pos_depth > DISTANCE_GRAPH_STACK_SIZE )
+    {
+        ERR_fa( "Distance graph exceeds stack size #<uz_t>.", ( uz_t )DISTANCE_GRAPH_STACK_SIZE );
+    }
+}
+
+static distance_graph_s* distance_graph_s_create_primitive( u2_t op, f3_t f, v3d_s v )
+{
+    distance_graph_s* o = distance_graph_s_create();
+    distance_graph_s_push_op( o, op, f, v, NULL );
+    o->val_depth = 1;
+    o->lipschitz = 1.0;
+    return o;
+}
+
+distance_graph_s* distance_graph_s_create_sphere( f3_t radius )
+{
+    return distance_graph_s_create_primitive( DISTANCE_OP_SPHERE, radius, v3d_s_zero() );
+}
+
+distance_graph_s* distance_graph_s_create_box( v3d_s ext )
+{
+    return distance_graph_s_create_primitive( DISTANCE_OP_BOX, 0, ext );
+}
+
+distance_graph_s* distance_graph_s_create_torus( f3_t radius1, f3_t radius2 )
+{
+    return distance_graph_s_create_primitive( DISTANCE_OP_TORUS, radius1, ( v3d_s ){ radius2, 0, 0 } );
+}
+
+distance_graph_s* distance_graph_s_create_cylinder( f3_t radius )
+{
+    return distance_graph_s_create_primitive( DISTANCE_OP_CYLINDER, radius, v3d_s_zero() );
+}
+
+distance_graph_s* distance_graph_s_create_plane( v3d_s nor, f3_t offs )
+{
+    return distance_graph_s_create_primitive( DISTANCE_OP_PLANE, offs, v3d_s_of_length( nor, 1.0 ) );
+}
+
+static distance_graph_s* distance_graph_s_create_binary( const distance_graph_s* a, const distance_graph_s* b, u2_t op, f3_t f )
+{
+    distance_graph_s* o = distance_graph_s_create();
+    distance_graph_s_append( o, a );
+    distance_graph_s_append( o, b );
+    distance_graph_s_push_op( o, op, f, v3d_s_zero(), NULL );
+    o->val_depth = a->val_depth > b->val_depth + 1 ? a->val_depth : b->val_depth + 1;
+    o->pos_depth = a->pos_depth > b->pos_depth     ? a->pos_depth : b->pos_depth;
+    o->lipschitz = a->lipschitz > b->lipschitz ? a->lipschitz : b->lipschitz; // also holds for the smooth union
+    distance_graph_s_check_depth( o );
+    return o;
+}
+
+distance_graph_s* distance_graph_s_create_union( const distance_graph_s* a, const distance_graph_s* b )
+{
+    return distance_graph_s_create_binary( a, b, DISTANCE_OP_UNION, 0 );
+}
+
+distance_graph_s* distance_graph_s_create_intersection( const distance_graph_s* a, const distance_graph_s* b )
+{
+    return distance_graph_s_create_binary( a, b, DISTANCE_OP_INTERSECTION, 0 );
+}
+
+distance_graph_s* distance_graph_s_create_difference( const distance_graph_s* a, const distance_graph_s* b )
+{
+    return distance_graph_s_create_binary( a, b, DISTANCE_OP_DIFFERENCE, 0 );
+}
+
+distance_graph_s* distance_graph_s_create_smooth_union( const distance_graph_s* a, const distance_graph_s* b, f3_t k )
+{
+    return distance_graph_s_create_binary( a, b, DISTANCE_OP_SMOOTH_UNION, f3_abs( k ) );
+}
+
+/// wraps 'a' into a position transform (saves and restores the position)
+static distance_graph_s* distance_graph_s_create_transform( const distance_graph_s* a, u2_t op, f3_t f, v3d_s v, const m3d_s* m )
+{
+    distance_graph_s* o = distance_graph_s_create();
+    distance_graph_s_push_op( o, DISTANCE_OP_PUSH_POS, 0, v3d_s_zero(), NULL );
+    distance_graph_s_push_op( o, op, f, v, m );
+    distance_graph_s_append( o, a );
+    distance_graph_s_push_op( o, DISTANCE_OP_POP_POS, 0, v3d_s_zero(), NULL );
+    o->val_depth = a->val_depth;
+    o->pos_depth = a->pos_depth + 1;
+    o->lipschitz = a->lipschitz; // scale: position and distance scale inversely
+    distance_graph_s_check_depth( o );
+    return o;
+}
+
+distance_graph_s* distance_graph_s_create_move( const distance_graph_s* a, v3d_s vec )
+{
+    return distance_graph_s_create_transform( a, DISTANCE_OP_MOVE, 0, vec, NULL );
+}
+
+distance_graph_s* distance_graph_s_create_rotate( const distance_graph_s* a, const m3d_s* mat )
+{
+    // the position is transformed inversely
+    m3d_s inv = m3d_s_transposed( *mat );
+    return distance_graph_s_create_transform( a, DISTANCE_OP_ROTATE, 0, v3d_s_zero(), &inv );
+}
+
+distance_graph_s* distance_graph_s_create_scale( const distance_graph_s* a, f3_t fac )
+{
+    fac = f3_abs( fac );
+    if( fac == 0 ) ERR_fa( "Scale factor is zero." );
+    distance_graph_s* o = distance_graph_s_create_transform( a, DISTANCE_OP_SCALE, 1.0 / fac, v3d_s_zero(), NULL );
+    distance_graph_s_push_op( o, DISTANCE_OP_MUL, fac, v3d_s_zero(), NULL );
+    return o;
+}
+
+distance_graph_s* distance_graph_s_create_repeat( const distance_graph_s* a, v3d_s period )
+{
+    period = ( v3d_s ){ f3_abs( period.x ), f3_abs( period.y ), f3_abs( period.z ) };
+    return distance_graph_s_create_transform( a, DISTANCE_OP_REPEAT, 0, period, NULL );
+}
+
+distance_graph_s* distance_graph_s_create_displace( const distance_graph_s* a, f3_t amplitude, v3d_s frequency )
+{
+    distance_graph_s* o = distance_graph_s_clone( a );
+    distance_graph_s_push_op( o, DISTANCE_OP_DISPLACE, amplitude, frequency, NULL );
+
+    // gradient of the displacement: |amplitude| * |frequency| per axis at most
+    v3d_s f_abs = { f3_abs( frequency.x ), f3_abs( frequency.y ), f3_abs( frequency.z ) };
+    o->lipschitz += f3_abs( amplitude ) * v3d_s_max( f_abs ) * sqrt( 3.0 );
+    return o;
+}
+
+/// evaluates n <= DISTANCE_LANES positions; each instruction runs over all lanes
+static void distance_graph_s_eval_lanes( const distance_graph_s* o, const v3d_s* pos, f3_t* dist, uz_t n )
+{
+    f3_t x[ DISTANCE_LANES ], y[ DISTANCE_LANES ], z[ DISTANCE_LANES ];
+    f3_t pos_stack[ DISTANCE_GRAPH_STACK_SIZE ][ 3 ][ DISTANCE_LANES ];
+    f3_t val_stack[ DISTANCE_GRAPH_STACK_SIZE ][ DISTANCE_LANES ];
+    uz_t pos_top = 0;
+    uz_t val_top = 0;
+
+    for( uz_t l = 0; l < n; l++ )
+    {
+        x[ l ] = pos[ l ].x;
+        y[ l ] = pos[ l ].y;
+        z[ l ] = pos[ l ].z;
+    }
+
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        const distance_op_s* ins = &o->data[ i ];
+        f3_t f = ins->f;
+        v3d_s v = ins->v;
+        switch( ins->op )
+        {
+            case DISTANCE_OP_SPHERE:
+            {
+                f3_t* d = val_stack[ val_top++ ];
+                for( uz_t l = 0; l < n; l++ ) d[ l ] = sqrt( x[ l ] * x[ l ] + y[ l ] * y[ l ] + z[ l ] * z[ l ] ) - f;
+            }
+            break;
+
+            case DISTANCE_OP_BOX:
+            {
+                f3_t* d = val_stack[ val_top++ ];
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    f3_t qx = f3_abs( x[ l ] ) - v.x;
+                    f3_t qy = f3_abs( y[ l ] ) - v.y;
+                    f3_t qz = f3_abs( z[ l ] ) - v.z;
+                    f3_t ox = qx > 0 ? qx : 0;
+                    f3_t oy = qy > 0 ? qy : 0;
+                    f3_t oz = qz > 0 ? qz : 0;
+                    f3_t qm = qx > qy ? ( qx > qz ? qx : qz ) : ( qy > qz ? qy : qz );
+                    d[ l ] = sqrt( ox * ox + oy * oy + oz * oz ) + ( qm < 0 ? qm : 0 );
+                }
+            }
+            break;
+
+            case DISTANCE_OP_TORUS:
+            {
+                f3_t* d = val_stack[ val_top++ ];
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    f3_t q = sqrt( x[ l ] * x[ l ] + y[ l ] * y[ l ] ) - f;
+                    d[ l ] = sqrt( q * q + z[ l ] * z[ l ] ) - v.x;
+                }
+            }
+            break;
+
+            case DISTANCE_OP_CYLINDER:
+            {
+                f3_t* d = val_stack[ val_top++ ];
+                for( uz_t l = 0; l < n; l++ ) d[ l ] = sqrt( x[ l ] * x[ l ] + y[ l ] * y[ l ] ) - f;
+            }
+            break;
+
+            case DISTANCE_OP_PLANE:
+            {
+                f3_t* d = val_stack[ val_top++ ];
+                for( uz_t l = 0; l < n; l++ ) d[ l ] = x[ l ] * v.x + y[ l ] * v.y + z[ l ] * v.z - f;
+            }
+            break;
+
+            case DISTANCE_OP_UNION:
+            {
+                const f3_t* b = val_stack[ --val_top ];
+                f3_t* a = val_stack[ val_top - 1 ];
+                for( uz_t l = 0; l < n; l++ ) a[ l ] = a[ l ] < b[ l ] ? a[ l ] : b[ l ];
+            }
+            break;
+
+            case DISTANCE_OP_INTERSECTION:
+            {
+                const f3_t* b = val_stack[ --val_top ];
+                f3_t* a = val_stack[ val_top - 1 ];
+                for( uz_t l = 0; l < n; l++ ) a[ l ] = a[ l ] > b[ l ] ? a[ l ] : b[ l ];
+            }
+            break;
+
+            case DISTANCE_OP_DIFFERENCE:
+            {
+                const f3_t* b = val_stack[ --val_top ];
+                f3_t* a = val_stack[ val_top - 1 ];
+                for( uz_t l = 0; l < n; l++ ) a[ l ] = a[ l ] > -b[ l ] ? a[ l ] : -b[ l ];
+            }
+            break;
+
+            case DISTANCE_OP_SMOOTH_UNION:
+            {
+                // polynomial smooth minimum
+                const f3_t* b = val_stack[ --val_top ];
+                f3_t* a = val_stack[ val_top - 1 ];
+                f3_t k_inv = ( f > 0 ) ? 0.5 / f : f3_mag;
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    f3_t h = 0.5 + ( b[ l ] - a[ l ] ) * k_inv;
+                    h = h < 0 ? 0 : h > 1 ? 1 : h;
+                    a[ l ] = b[ l ] + ( a[ l ] - b[ l ] ) * h - f * h * ( 1.0 - h );
+                }
+            }
+            break;
+
+            case DISTANCE_OP_PUSH_POS:
+            {
+                f3_t ( *p )[ DISTANCE_LANES ] = pos_stack[ pos_top++ ];
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    p[ 0 ][ l ] = x[ l ];
+                    p[ 1 ][ l ] = y[ l ];
+                    p[ 2 ][ l ] = z[ l ];
+                }
+            }
+            break;
+
+            case DISTANCE_OP_POP_POS:
+            {
+                f3_t ( *p )[ DISTANCE_LANES ] = pos_stack[ --pos_top ];
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    x[ l ] = p[ 0 ][ l ];
+                    y[ l ] = p[ 1 ][ l ];
+                    z[ l ] = p[ 2 ][ l ];
+                }
+            }
+            break;
+
+            case DISTANCE_OP_MOVE:
+            {
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    x[ l ] -= v.x;
+                    y[ l ] -= v.y;
+                    z[ l ] -= v.z;
+                }
+            }
+            break;
+
+            case DISTANCE_OP_ROTATE:
+            {
+                const m3d_s* m = &ins->m;
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    f3_t px = x[ l ], py = y[ l ], pz = z[ l ];
+                    x[ l ] = m->x.x * px + m->x.y * py + m->x.z * pz;
+                    y[ l ] = m->y.x * px + m->y.y * py + m->y.z * pz;
+                    z[ l ] = m->z.x * px + m->z.y * py + m->z.z * pz;
+                }
+            }
+            break;
+
+            case DISTANCE_OP_SCALE:
+            {
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    x[ l ] *= f;
+                    y[ l ] *= f;
+                    z[ l ] *= f;
+                }
+            }
+            break;
+
+            case DISTANCE_OP_MUL:
+            {
+                f3_t* d = val_stack[ val_top - 1 ];
+                for( uz_t l = 0; l < n; l++ ) d[ l ] *= f;
+            }
+            break;
+
+            case DISTANCE_OP_REPEAT:
+            {
+                for( uz_t l = 0; l < n; l++ )
+                {
+                    if( v.x > 0 ) x[ l ] -= v.x * floor( x[ l ] / v.x + 0.5 );
+                    if( v.y > 0 ) y[ l ] -= v.y * floor( y[ l ] / v.y + 0.5 );
+                    if( v.z > 0 ) z[ l ] -= v.z * floor( z[ l ] / v.z + 0.5 );
+                }
+            }
+            break;
+
+            case DISTANCE_OP_DISPLACE:
+            {
+                f3_t* d = val_stack[ val_top - 1 ];
+                for( uz_t l = 0; l < n; l++ ) d[ l ] += f * sin( v.x * x[ l ] ) * sin( v.y * y[ l ] ) * sin( v.z * z[ l ] );
+            }
+            break;
+
+            default:
+            {
+                ERR_fa( "Invalid instruction '#<u2_t>'.", ins->op );
+            }
+            break;
+        }
+    }
+
+    if( val_top == 1 )
+    {
+        for( uz_t l = 0; l < n; l++ ) dist[ l ] = val_stack[ 0 ][ l ];
+    }
+    else // empty graph
+    {
+        for( uz_t l = 0; l < n; l++ ) dist[ l ] = f3_mag;
+    }
+}
+
+f3_t distance_graph_s_get_lipschitz( const distance_graph_s* o )
+{
+    return o->lipschitz > 0 ? o->lipschitz : 1.0;
+}
+
+void distance_graph_s_call_n( const distance_graph_s* o, const v3d_s* pos, f3_t* dist, uz_t n )
+{
+    for( uz_t i = 0; i < n; i += DISTANCE_LANES )
+    {
+        distance_graph_s_eval_lanes( o, pos + i, dist + i, ( n - i < DISTANCE_LANES ) ? n - i : DISTANCE_LANES );
+    }
+}
+
+f3_t distance_graph_s_call( const distance_graph_s* o, const v3d_s* pos )
+{
+    f3_t dist;
+    distance_graph_s_eval_lanes( o, pos, &dist, 1 );
+    return dist;
+}
+
+static void distance_graph_s_init_a( vd_t nc )
+{
+    struct { ap_t a; vc_t p; distance_graph_s* o; } * nc_l = nc;
+    nc_l->a( nc ); // default
+    nc_l->o->fp_distance   = ( distance_fp   )distance_graph_s_call;
+    nc_l->o->fp_distance_n = ( distance_n_fp )distance_graph_s_call_n;
+}
+
+static bcore_self_s* distance_graph_s_create_self( void )
+{
+    bcore_self_s* self = BCORE_SELF_S_BUILD_PARSE_SC( distance_graph_s_def, distance_graph_s );
+    bcore_self_s_push_ns_func( self, ( fp_t )distance_graph_s_init_a, "ap_t", "init" );
+    return self;
+}
+
+/**********************************************************************************************************************/
+/// distance_cache_s
+
+#define TYPEOF_distance_f3_arr_s typeof( "distance_f3_arr_s" )
+typedef struct distance_f3_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            f3_t* data;
+            uz_t size, space;
+        };
+    };
+} distance_f3_arr_s;
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( distance_f3_arr_s, "distance_f3_arr_s = bcore_inst { aware_t _; f3_t [] arr; }" )
+
+#define TYPEOF_distance_u2_arr_s typeof( "distance_u2_arr_s" )
+typedef struct distance_u2_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            u2_t* data;
+            uz_t size, space;
+        };
+    };
+} distance_u2_arr_s;
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( distance_u2_arr_s, "distance_u2_arr_s = bcore_inst { aware_t _; u2_t [] arr; }" )
+
+/// samples per brick edge
+#define DISTANCE_BRICK_SAMPLES ( DISTANCE_BRICK_CELLS + 1 )
+#define DISTANCE_BRICK_VOLUME ( DISTANCE_BRICK_SAMPLES * DISTANCE_BRICK_SAMPLES * DISTANCE_BRICK_SAMPLES )
+
+typedef struct distance_cache_s
+{
+    aware_t _;
+    v3d_s min;            // lower corner of the cube
+    f3_t  cell;           // edge length of a cell
+    uz_t  bricks;         // bricks per axis
+    f3_t  lipschitz;
+    tp_t  fingerprint;    // see distance_cache_s_fingerprint
+    distance_f3_arr_s center_arr; // brick -> distance at brick center
+    distance_u2_arr_s slot_arr;   // brick -> 0: far brick; else 1 + index of its samples
+    distance_f3_arr_s sample_arr; // DISTANCE_BRICK_VOLUME samples per near brick (x fastest)
+} distance_cache_s;
+
+static sc_t distance_cache_s_def =
+"distance_cache_s = bcore_inst"
+"{"
+    "aware_t _;"
+    "v3d_s min;"
+    "f3_t cell;"
+    "uz_t bricks;"
+    "f3_t lipschitz;"
+    "tp_t fingerprint;"
+    "distance_f3_arr_s center_arr;"
+    "distance_u2_arr_s slot_arr;"
+    "distance_f3_arr_s sample_arr;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( distance_cache_s, distance_cache_s_def )
+
+static inline f3_t distance_cache_s_brick_size( const distance_cache_s* o )
+{
+    return o->cell * DISTANCE_BRICK_CELLS;
+}
+
+static inline v3d_s distance_cache_s_brick_center( const distance_cache_s* o, uz_t bx, uz_t by, uz_t bz )
+{
+    f3_t b = distance_cache_s_brick_size( o );
+    return ( v3d_s ){ o->min.x + b * ( bx + 0.5 ), o->min.y + b * ( by + 0.5 ), o->min.z + b * ( bz + 0.5 ) };
+}
+
+/// folds the bit pattern of v into hash
+static inline tp_t distance_fold_f3( tp_t hash, f3_t v )
+{
+    union { f3_t f; u3_t u; } c = { .f = v };
+    return bcore_tp_fold_u2( bcore_tp_fold_u2( hash, c.u ), c.u >> 32 );
+}
+
+tp_t distance_cache_s_fingerprint( vc_t distance_obj, v3d_s min, f3_t size, uz_t resolution, f3_t lipschitz )
+{
+    tp_t hash = bcore_tp_init();
+    hash = bcore_tp_fold_u2( hash, *( aware_t* )distance_obj );
+    hash = bcore_tp_fold_u2( hash, resolution );
+    hash = distance_fold_f3( hash, min.x );
+    hash = distance_fold_f3( hash, min.y );
+    hash = distance_fold_f3( hash, min.z );
+    hash = distance_fold_f3( hash, size );
+    hash = distance_fold_f3( hash, lipschitz );
+
+    // the serialized object characterizes the function itself
+    st_s* data = st_s_create();
+    bcore_bin_ml_x_to_string( sr_awc( distance_obj ), data );
+    for( uz_t i = 0; i < data->size; i++ ) hash = bcore_tp_fold_u2( hash, ( u0_t )data->data[ i ] );
+    st_s_discard( data );
+
+    return hash;
+}
+
+/// parallel bake job: workers fetch bricks by index
+typedef struct distance_bake_s
+{
+    distance_cache_s* cache;
+    vc_t distance;
+    bl_t samples; // false: brick centers; true: samples of near bricks
+    uz_t index;
+    bcore_mutex_s mutex;
+} distance_bake_s;
+
+static uz_t distance_bake_s_get_index( distance_bake_s* o )
+{
+    bcore_mutex_s_lock( &o->mutex );
+    uz_t index = o->index++;
+    bcore_mutex_s_unlock( &o->mutex );
+    return index;
+}
+
+static vd_t distance_bake_s_func( distance_bake_s* o )
+{
+    distance_cache_s* cache = o->cache;
+    uz_t n = cache->bricks;
+    uz_t bricks = n * n * n;
+    f3_t b = distance_cache_s_brick_size( cache );
+
+    uz_t index;
+    while( ( index = distance_bake_s_get_index( o ) ) < bricks )
+    {
+        uz_t bx = index % n;
+        uz_t by = ( index / n ) % n;
+        uz_t bz = index / ( n * n );
+
+        if( !o->samples )
+        {
+            cache->center_arr.data[ index ] = distance( o->distance, distance_cache_s_brick_center( cache, bx, by, bz ) );
+        }
+        else if( cache->slot_arr.data[ index ] > 0 )
+        {
+            f3_t* s = cache->sample_arr.data + ( cache->slot_arr.data[ index ] - 1 ) * DISTANCE_BRICK_VOLUME;
+            v3d_s p0 = { cache->min.x + b * bx, cache->min.y + b * by, cache->min.z + b * bz };
+            v3d_s pos[ DISTANCE_BRICK_SAMPLES ];
+            for( uz_t k = 0; k < DISTANCE_BRICK_SAMPLES; k++ )
+            {
+                for( uz_t j = 0; j < DISTANCE_BRICK_SAMPLES; j++ )
+                {
+                    for( uz_t i = 0; i < DISTANCE_BRICK_SAMPLES; i++ )
+                    {
+                        pos[ i ] = ( v3d_s ){ p0.x + cache->cell * i, p0.y + cache->cell * j, p0.z + cache->cell * k };
+                    }
+                    distance_n( o->distance, pos, s, DISTANCE_BRICK_SAMPLES );
+                    s += DISTANCE_BRICK_SAMPLES;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static void distance_bake_s_run( distance_bake_s* o, uz_t threads )
+{
+    o->index = 0;
+    threads = threads > 0 ? threads : 1;
+    bcore_thread_s* thread_arr = bcore_u_alloc( sizeof( bcore_thread_s ), NULL, threads, NULL );
+    for( uz_t i = 0; i < threads; i++ ) thread_arr[ i ] = bcore_thread_call( ( vd_t(*)(vd_t) )distance_bake_s_func, o );
+    for( uz_t i = 0; i < threads; i++ ) bcore_thread_join( thread_arr[ i ] );
+    bcore_free( thread_arr );
+}
+
+void distance_cache_s_bake( distance_cache_s* o, vc_t distance_obj, v3d_s min, f3_t size, uz_t resolution, f3_t lipschitz, uz_t threads )
+{
+    uz_t n = ( resolution + DISTANCE_BRICK_CELLS - 1 ) / DISTANCE_BRICK_CELLS;
+    n = n > 0 ? n : 1;
+    uz_t bricks = n * n * n;
+
+    o->min       = min;
+    o->bricks    = n;
+    o->cell      = size / ( n * DISTANCE_BRICK_CELLS );
+    o->lipschitz = lipschitz;
+    o->fingerprint = distance_cache_s_fingerprint( distance_obj, min, size, resolution, lipschitz );
+
+    bcore_array_a_set_size( ( bcore_array* )&o->center_arr, bricks );
+    bcore_array_a_set_size( ( bcore_array* )&o->slot_arr,   bricks );
+
+    distance_bake_s bake;
+    bcore_memzero( &bake, sizeof( bake ) );
+    bcore_mutex_s_init( &bake.mutex );
+    bake.cache = o;
+    bake.distance = distance_obj;
+
+    // pass 1: brick centers
+    bake.samples = false;
+    distance_bake_s_run( &bake, threads );
+
+    // near bricks: the surface might pass closer than one cell to the brick
+    f3_t half_diag = 0.5 * sqrt( 3.0 ) * distance_cache_s_brick_size( o );
+    uz_t slots = 0;
+    for( uz_t i = 0; i < bricks; i++ )
+    {
+        bl_t near = f3_abs( o->center_arr.data[ i ] ) - lipschitz * half_diag <= o->cell;
+        o->slot_arr.data[ i ] = near ? ++slots : 0;
+    }
+    bcore_array_a_set_size( ( bcore_array* )&o->sample_arr, slots * DISTANCE_BRICK_VOLUME );
+
+    // pass 2: samples of near bricks
+    bake.samples = true;
+    distance_bake_s_run( &bake, threads );
+
+    bcore_mutex_s_down( &bake.mutex );
+}
+
+tp_t distance_cache_s_get_fingerprint( const distance_cache_s* o )
+{
+    return o->fingerprint;
+}
+
+bl_t distance_cache_s_bound( const distance_cache_s* o, v3d_s pos, f3_t* dist )
+{
+    if( o->bricks == 0 ) return false;
+    f3_t b_inv = 1.0 / distance_cache_s_brick_size( o );
+    f3_t fx = ( pos.x - o->min.x ) * b_inv;
+    f3_t fy = ( pos.y - o->min.y ) * b_inv;
+    f3_t fz = ( pos.z - o->min.z ) * b_inv;
+    if( fx < 0 || fy < 0 || fz < 0 ) return false;
+    uz_t bx = fx, by = fy, bz = fz;
+    uz_t n = o->bricks;
+    if( bx >= n || by >= n || bz >= n ) return false;
+    uz_t index = bx + n * ( by + n * bz );
+
+    f3_t d, err;
+    u2_t slot = o->slot_arr.data[ index ];
+    if( slot == 0 )
+    {
+        // far brick: bound from the center value
+        d = o->center_arr.data[ index ];
+        err = o->lipschitz * sqrt( v3d_s_diff_sqr( pos, distance_cache_s_brick_center( o, bx, by, bz ) ) );
+    }
+    else
+    {
+        // near brick: trilinear interpolation; each corner deviates at most by lipschitz * cell diagonal
+        const f3_t* s = o->sample_arr.data + ( slot - 1 ) * DISTANCE_BRICK_VOLUME;
+        f3_t cx = ( fx - bx ) * DISTANCE_BRICK_CELLS;
+        f3_t cy = ( fy - by ) * DISTANCE_BRICK_CELLS;
+        f3_t cz = ( fz - bz ) * DISTANCE_BRICK_CELLS;
+        uz_t ix = cx, iy = cy, iz = cz;
+        ix = ix < DISTANCE_BRICK_CELLS ? ix : DISTANCE_BRICK_CELLS - 1;
+        iy = iy < DISTANCE_BRICK_CELLS ? iy : DISTANCE_BRICK_CELLS - 1;
+        iz = iz < DISTANCE_BRICK_CELLS ? iz : DISTANCE_BRICK_CELLS - 1;
+        f3_t tx = cx - ix, ty = cy - iy, tz = cz - iz;
+        const f3_t* s0 = s + ix + DISTANCE_BRICK_SAMPLES * ( iy + DISTANCE_BRICK_SAMPLES * iz );
+        const uz_t sy = DISTANCE_BRICK_SAMPLES;
+        const uz_t sz = DISTANCE_BRICK_SAMPLES * DISTANCE_BRICK_SAMPLES;
+        f3_t d00 = s0[ 0       ] + ( s0[ 1            ] - s0[ 0       ] ) * tx;
+        f3_t d10 = s0[ sy      ] + ( s0[ sy + 1       ] - s0[ sy      ] ) * tx;
+        f3_t d01 = s0[ sz      ] + ( s0[ sz + 1       ] - s0[ sz      ] ) * tx;
+        f3_t d11 = s0[ sz + sy ] + ( s0[ sz + sy + 1  ] - s0[ sz + sy ] ) * tx;
+        f3_t d0 = d00 + ( d10 - d00 ) * ty;
+        f3_t d1 = d01 + ( d11 - d01 ) * ty;
+        d = d0 + ( d1 - d0 ) * tz;
+        err = o->lipschitz * sqrt( 3.0 ) * o->cell;
+    }
+
+    // close to the surface the exact function is preferred
+    f3_t bound = f3_abs( d ) - err;
+    if( bound <= o->cell ) return false;
+    *dist = ( d > 0 ) ? bound : -bound;
+    return true;
+}
+
 /**********************************************************************************************************************/
 
 vd_t distance_signal_handler( const bcore_signal_s* o )
@@ -116,6 +860,11 @@ vd_t distance_signal_handler( const bcore_signal_s* o )
             bcore_trait_set( entypeof( "distance" ), entypeof( "bcore_inst" ) );
             BCORE_REGISTER_OBJECT( distance_sphere_s );
             BCORE_REGISTER_OBJECT( distance_torus_s );
+            BCORE_REGISTER_OBJECT( distance_op_s );
+            BCORE_REGISTER_OBJECT( distance_graph_s );
+            BCORE_REGISTER_OBJECT( distance_f3_arr_s );
+            BCORE_REGISTER_OBJECT( distance_u2_arr_s );
+            BCORE_REGISTER_OBJECT( distance_cache_s );
         }
         break;
 
@@ -25,11 +25,15 @@
 
 typedef f3_t ( *distance_fp )( vc_t o, const v3d_s* pos );
 
-/// header of distance object
+/// batched distance function: dist[ i ] = distance at pos[ i ] for i < n
+typedef void ( *distance_n_fp )( vc_t o, const v3d_s* pos, f3_t* dist, uz_t n );
+
+/// header of distance object (fp_distance_n is optional)
 typedef struct distance_hdr_s
 {
     aware_t _;
-    distance_fp fp_distance;
+    distance_fp   fp_distance;
+    distance_n_fp fp_distance_n;
 } distance_hdr_s;
 
 /// distance function
@@ -38,6 +42,20 @@ static inline f3_t distance( vc_t o, v3d_s pos )
     return ( ( const distance_hdr_s* )o )->fp_distance( o, &pos );
 }
 
+/// distance function for n positions at once
+static inline void distance_n( vc_t o, const v3d_s* pos, f3_t* dist, uz_t n )
+{
+    const distance_hdr_s* hdr = o;
+    if( hdr->fp_distance_n )
+    {
+        hdr->fp_distance_n( o, pos, dist, n );
+    }
+    else
+    {
+        for( uz_t i = 0; i < n; i++ ) dist[ i ] = hdr->fp_distance( o, &pos[ i ] );
+    }
+}
+
 /**********************************************************************************************************************/
 /// distance_torus_s
 
@@ -46,6 +64,78 @@ BCORE_DECLARE_FUNCTIONS_OBJ( distance_torus_s )
 
 void distance_torus_s_set_ex_radius( distance_torus_s* o, f3_t radius );
 
+/**********************************************************************************************************************/
+/** distance_graph_s
+ *  Distance function composed of primitives, combinations and transforms.
+ *  The expression is kept as flat postfix program (compiled while composing):
+ *  Primitives push a distance; combinations pop two and push one; transforms modify the position
+ *  between saving and restoring it on a position stack.
+ *  Evaluation processes DISTANCE_LANES positions per instruction (structure-of-arrays).
+ *  Composing functions create a new graph and leave their arguments unchanged.
+ *  Primitives are centered at the origin; torus and cylinder are oriented along the z-axis.
+ */
+
+/// positions evaluated per instruction
+#define DISTANCE_LANES 8
+
+/// maximum depth of value- and position stack
+#define DISTANCE_GRAPH_STACK_SIZE 32
+
+typedef struct distance_graph_s distance_graph_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( distance_graph_s )
+
+distance_graph_s* distance_graph_s_create_sphere(   f3_t radius );
+distance_graph_s* distance_graph_s_create_box(      v3d_s ext ); // ext: half edge lengths
+distance_graph_s* distance_graph_s_create_torus(    f3_t radius1, f3_t radius2 );
+distance_graph_s* distance_graph_s_create_cylinder( f3_t radius ); // infinite
+distance_graph_s* distance_graph_s_create_plane(    v3d_s nor, f3_t offs ); // inside: nor * pos < offs
+
+distance_graph_s* distance_graph_s_create_union(        const distance_graph_s* a, const distance_graph_s* b );
+distance_graph_s* distance_graph_s_create_intersection( const distance_graph_s* a, const distance_graph_s* b );
+distance_graph_s* distance_graph_s_create_difference(   const distance_graph_s* a, const distance_graph_s* b ); // a without b
+distance_graph_s* distance_graph_s_create_smooth_union( const distance_graph_s* a, const distance_graph_s* b, f3_t k ); // k: blend radius
+
+distance_graph_s* distance_graph_s_create_move(     const distance_graph_s* a, v3d_s vec );
+distance_graph_s* distance_graph_s_create_rotate(   const distance_graph_s* a, const m3d_s* mat );
+distance_graph_s* distance_graph_s_create_scale(    const distance_graph_s* a, f3_t fac );
+distance_graph_s* distance_graph_s_create_repeat(   const distance_graph_s* a, v3d_s period ); // period component 0: no repetition
+distance_graph_s* distance_graph_s_create_displace( const distance_graph_s* a, f3_t amplitude, v3d_s frequency ); // sinusoidal
+
+f3_t distance_graph_s_call(   const distance_graph_s* o, const v3d_s* pos );
+void distance_graph_s_call_n( const distance_graph_s* o, const v3d_s* pos, f3_t* dist, uz_t n );
+
+/// upper bound of the gradient magnitude (tracked while composing; 1 for undistorted functions)
+f3_t distance_graph_s_get_lipschitz( const distance_graph_s* o );
+
+/**********************************************************************************************************************/
+/** distance_cache_s
+ *  Sparse sampling of a distance function inside a cube.
+ *  The cube is divided into bricks of DISTANCE_BRICK_CELLS^3 cells. A brick stores only its center value
+ *  unless the surface may come within one cell of it (near brick); near bricks store all cell corners.
+ *  Lookups return conservative distances (never larger in magnitude than the true distance)
+ *  derived from the lipschitz bound of the function.
+ */
+
+/// cells per brick edge
+#define DISTANCE_BRICK_CELLS 8
+
+typedef struct distance_cache_s distance_cache_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( distance_cache_s )
+
+/// samples distance_obj in the cube [min, min + size] at resolution cells per edge using 'threads' threads
+void distance_cache_s_bake( distance_cache_s* o, vc_t distance_obj, v3d_s min, f3_t size, uz_t resolution, f3_t lipschitz, uz_t threads );
+
+/** Conservative distance at pos.
+ *  Returns false when pos is outside the cube or closer than one cell to the surface.
+ */
+bl_t distance_cache_s_bound( const distance_cache_s* o, v3d_s pos, f3_t* dist );
+
+/// hash identifying a bake (bake parameters and serialized distance object)
+tp_t distance_cache_s_fingerprint( vc_t distance_obj, v3d_s min, f3_t size, uz_t resolution, f3_t lipschitz );
+
+/// fingerprint of the bake stored in the cache
+tp_t distance_cache_s_get_fingerprint( const distance_cache_s* o );
+
 /**********************************************************************************************************************/
 
 vd_t distance_signal_handler( const bcore_signal_s* o );
@@ -114,6 +114,83 @@ void fresnel_refraction( v3d_s dir_i, v3d_s exit_nor, f3_t trix, v3d_s* dir )
 
 /**********************************************************************************************************************/
 
+static inline f3_t polynomial_eval( const f3_t* c, uz_t degree, f3_t t )
+{
+    f3_t v = c[ degree ];
+    for( uz_t i = degree; i > 0; i-- ) v = v * t + c[ i - 1 ];
+    return v;
+}
+
+/// root in [a, b] where the polynomial is monotonic and f( a ), f( b ) have different signs
+static f3_t polynomial_refine( const f3_t* c, const f3_t* dc, uz_t degree, f3_t a, f3_t b, f3_t fa )
+{
+    f3_t lo = a, hi = b;
+    bl_t neg_lo = fa < 0;
+    f3_t t = 0.5 * ( lo + hi );
+    for( uz_t i = 0; i < 100; i++ )
+    {
+        f3_t f = polynomial_eval( c, degree, t );
+        if( f == 0 ) return t;
+        if( ( f < 0 ) == neg_lo ) lo = t; else hi = t;
+        if( hi - lo <= 1E-14 * ( 1.0 + f3_abs( lo ) + f3_abs( hi ) ) ) break;
+
+        // Newton step; bisection when it leaves the bracket
+        f3_t df = polynomial_eval( dc, degree - 1, t );
+        f3_t tn = ( df != 0 ) ? t - f / df : lo;
+        t = ( tn > lo && tn < hi ) ? tn : 0.5 * ( lo + hi );
+    }
+    return t;
+}
+
+uz_t polynomial_roots( const f3_t* c, uz_t degree, f3_t t0, f3_t t1, f3_t* roots )
+{
+    ASSERT( degree <= POLYNOMIAL_MAX_DEGREE );
+    if( t0 > t1 ) return 0;
+
+    // leading zero coefficients reduce the degree
+    while( degree > 0 && c[ degree ] == 0 ) degree--;
+    if( degree == 0 ) return 0;
+
+    if( degree == 1 )
+    {
+        f3_t t = -c[ 0 ] / c[ 1 ];
+        if( t < t0 || t > t1 ) return 0;
+        roots[ 0 ] = t;
+        return 1;
+    }
+
+    // the derivative's roots partition [t0, t1] into monotonic intervals
+    f3_t dc[ POLYNOMIAL_MAX_DEGREE ];
+    for( uz_t i = 0; i < degree; i++ ) dc[ i ] = c[ i + 1 ] * ( i + 1 );
+    f3_t crit[ POLYNOMIAL_MAX_DEGREE + 1 ];
+    uz_t crit_size = polynomial_roots( dc, degree - 1, t0, t1, crit );
+    crit[ crit_size++ ] = t1;
+
+    uz_t size = 0;
+    f3_t a = t0;
+    f3_t fa = polynomial_eval( c, degree, a );
+    for( uz_t i = 0; i < crit_size; i++ )
+    {
+        f3_t b = crit[ i ];
+        f3_t fb = polynomial_eval( c, degree, b );
+        if( fa == 0 )
+        {
+            if( size == 0 || roots[ size - 1 ] < a ) roots[ size++ ] = a;
+        }
+        else if( ( fa < 0 ) != ( fb < 0 ) && fb != 0 )
+        {
+            roots[ size++ ] = polynomial_refine( c, dc, degree, a, b, fa );
+        }
+        a = b;
+        fa = fb;
+    }
+    if( fa == 0 && ( size == 0 || roots[ size - 1 ] < a ) ) roots[ size++ ] = a;
+
+    return size;
+}
+
+/**********************************************************************************************************************/
+
 vd_t gmath_signal_handler( const bcore_signal_s* o )
 {
     switch( bcore_signal_s_handle_type( o, typeof( "gmath" ) ) )
@@ -137,6 +137,80 @@ static inline bl_t sphere_intersects_half_sphere( v3d_s pos, f3_t r, const ray_s
 
 /**********************************************************************************************************************/
 
+/** component-wise inverse of the ray direction (used by slab tests)
+ *  Zero components are replaced by a miniscule value: An infinite inverse would yield NaN (0 * inf)
+ *  for a ray origin exactly on a slab boundary and reject boxes the ray actually touches.
+ */
+static inline f3_t ray_inv_dir_component( f3_t d )
+{
+    return 1.0 / ( d != 0 ? d : 1.0 / f3_mag );
+}
+
+static inline v3d_s ray_inv_dir( const ray_s* ray )
+{
+    return ( v3d_s ) { .x = ray_inv_dir_component( ray->d.x ), .y = ray_inv_dir_component( ray->d.y ), .z = ray_inv_dir_component( ray->d.z ) };
+}
+
+/** Slab test: Computes offsets where the ray (line) enters (t_near) and exits (t_far) the box.
+ *  Returns false in case the line misses the box.
+ *  p: ray position; inv_d: ray_inv_dir( ray )
+ */
+static inline bl_t box_ray_span( const box_s* box, v3d_s p, v3d_s inv_d, f3_t* t_near, f3_t* t_far )
+{
+    f3_t x1 = ( box->min.x - p.x ) * inv_d.x, x2 = ( box->max.x - p.x ) * inv_d.x;
+    f3_t y1 = ( box->min.y - p.y ) * inv_d.y, y2 = ( box->max.y - p.y ) * inv_d.y;
+    f3_t z1 = ( box->min.z - p.z ) * inv_d.z, z2 = ( box->max.z - p.z ) * inv_d.z;
+
+    f3_t tn = -f3_inf;
+    f3_t tf =  f3_inf;
+    tn = x1 < x2 ? ( x1 > tn ? x1 : tn ) : ( x2 > tn ? x2 : tn );
+    tf = x1 < x2 ? ( x2 < tf ? x2 : tf ) : ( x1 < tf ? x1 : tf );
+    tn = y1 < y2 ? ( y1 > tn ? y1 : tn ) : ( y2 > tn ? y2 : tn );
+    tf = y1 < y2 ? ( y2 < tf ? y2 : tf ) : ( y1 < tf ? y1 : tf );
+    tn = z1 < z2 ? ( z1 > tn ? z1 : tn ) : ( z2 > tn ? z2 : tn );
+    tf = z1 < z2 ? ( z2 < tf ? z2 : tf ) : ( z1 < tf ? z1 : tf );
+
+    *t_near = tn;
+    *t_far  = tf;
+    return tn <= tf;
+}
+
+/** Slab test: Returns the offset at which the ray enters the box or f3_inf in case the box is missed.
+ *  Returns 0 when the ray starts inside the box.
+ *  p: ray position; inv_d: ray_inv_dir( ray )
+ */
+static inline f3_t box_ray_entry( const box_s* box, v3d_s p, v3d_s inv_d )
+{
+    f3_t x1 = ( box->min.x - p.x ) * inv_d.x, x2 = ( box->max.x - p.x ) * inv_d.x;
+    f3_t y1 = ( box->min.y - p.y ) * inv_d.y, y2 = ( box->max.y - p.y ) * inv_d.y;
+    f3_t z1 = ( box->min.z - p.z ) * inv_d.z, z2 = ( box->max.z - p.z ) * inv_d.z;
+
+    f3_t t_near = 0;
+    f3_t t_far  = f3_inf;
+    t_near = x1 < x2 ? ( x1 > t_near ? x1 : t_near ) : ( x2 > t_near ? x2 : t_near );
+    t_far  = x1 < x2 ? ( x2 < t_far  ? x2 : t_far  ) : ( x1 < t_far  ? x1 : t_far  );
+    t_near = y1 < y2 ? ( y1 > t_near ? y1 : t_near ) : ( y2 > t_near ? y2 : t_near );
+    t_far  = y1 < y2 ? ( y2 < t_far  ? y2 : t_far  ) : ( y1 < t_far  ? y1 : t_far  );
+    t_near = z1 < z2 ? ( z1 > t_near ? z1 : t_near ) : ( z2 > t_near ? z2 : t_near );
+    t_far  = z1 < z2 ? ( z2 < t_far  ? z2 : t_far  ) : ( z1 < t_far  ? z1 : t_far  );
+
+    return ( t_near <= t_far ) ? t_near : f3_inf;
+}
+
+/**********************************************************************************************************************/
+
+/// maximum degree accepted by polynomial_roots
+#define POLYNOMIAL_MAX_DEGREE 4
+
+/** Real roots of the polynomial c[0] + c[1] * t + ... + c[degree] * t^degree inside the interval [t0, t1].
+ *  Roots are isolated between the roots of the derivative (recursively) and refined by safeguarded Newton steps.
+ *  Roots without sign change (tangent contact) may be missed.
+ *  Roots are stored ascending in roots[ 0 ... degree - 1 ]; returns the number of roots.
+ */
+uz_t polynomial_roots( const f3_t* c, uz_t degree, f3_t t0, f3_t t1, f3_t* roots );
+
+/**********************************************************************************************************************/
+
 vd_t gmath_signal_handler( const bcore_signal_s* o );
 
 #endif // GMATH_H
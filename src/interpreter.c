@@ -739,6 +739,17 @@ static sr_s meval_s_mul( meval_s* o, sr_s v1, sr_s v2 )
         }
         break;
 
+        case TYPEOF_instance_s:
+        {
+            switch( t2 )
+            {
+                case TYPEOF_s3_t:  r = sr_clone( v1 ); v1 = sr_null(); instance_s_scale(  r.o, *( s3_t* )v2.o ); break;
+                case TYPEOF_f3_t:  r = sr_clone( v1 ); v1 = sr_null(); instance_s_scale(  r.o, *( f3_t* )v2.o ); break;
+                case TYPEOF_m3d_s: r = sr_clone( v1 ); v1 = sr_null(); instance_s_rotate( r.o,  ( m3d_s* )v2.o ); break;
+            }
+        }
+        break;
+
         case TYPEOF_bclos_signature_s:
         {
             bclos_signature_s* sig = v1.o;
@@ -898,6 +909,15 @@ static sr_s meval_s_add( meval_s* o, sr_s v1, sr_s v2 )
         }
         break;
 
+        case TYPEOF_instance_s:
+        {
+            switch( t2 )
+            {
+                case TYPEOF_v3d_s: r = sr_clone( v1 ); v1 = sr_null(); instance_s_move(  r.o,  ( v3d_s* )v2.o ); break;
+            }
+        }
+        break;
+
         default:
         {
             if( bcore_trait_is_of( t1, TYPEOF_spect_obj ) )
@@ -1018,7 +1038,14 @@ static sr_s meval_s_logic_and( meval_s* o, sr_s v1, sr_s v2 )
     }
     else if( bcore_trait_is_of( t1, TYPEOF_spect_obj ) && bcore_trait_is_of( t2, TYPEOF_spect_obj ) )
     {
-        r = sr_asd( obj_pair_inside_s_create_pair( v1.o, v2.o ) );
+        if( obj_polyhedron_s_is_mergeable( v1.o ) && obj_polyhedron_s_is_mergeable( v2.o ) )
+        {
+            r = sr_asd( obj_polyhedron_s_create_pair( v1.o, v2.o ) );
+        }
+        else
+        {
+            r = sr_asd( obj_pair_inside_s_create_pair( v1.o, v2.o ) );
+        }
     }
     else
     {
@@ -1504,6 +1531,7 @@ sr_s meval_s_eval( meval_s* o, sr_s front_obj )
                     case TYPEOF_map_s:      ret =      map_s_meval_key( &front_obj, o, key ); break;
                     case TYPEOF_arr_s:      ret =      arr_s_meval_key( &front_obj, o, key ); break;
                     case TYPEOF_compound_s: ret = compound_s_meval_key( &front_obj, o, key ); break;
+                    case TYPEOF_instance_s: ret = instance_s_meval_key( &front_obj, o, key ); break;
                     default:
                     {
                         if( bcore_trait_is_of( type, TYPEOF_spect_obj ) )
@@ -1982,14 +2010,37 @@ sr_s mclosure_s_interpret( const mclosure_s* const_o, sr_s source )
 
     /// object creation functions
     bclos_frame_s_set( frame, typeof( "create_plane"        ), sr_create( typeof( "create_plane_s"        ) ) );
+    bclos_frame_s_set( frame, typeof( "create_polyhedron"   ), sr_create( typeof( "create_polyhedron_s"   ) ) );
     bclos_frame_s_set( frame, typeof( "create_sphere"       ), sr_create( typeof( "create_sphere_s"       ) ) );
     bclos_frame_s_set( frame, typeof( "create_squaroid"     ), sr_create( typeof( "create_squaroid_s"     ) ) );
     bclos_frame_s_set( frame, typeof( "create_cylinder"     ), sr_create( typeof( "create_cylinder_s"     ) ) );
     bclos_frame_s_set( frame, typeof( "create_torus"        ), sr_create( typeof( "create_torus_s"        ) ) );
+    bclos_frame_s_set( frame, typeof( "create_distance_torus" ), sr_create( typeof( "create_distance_torus_s" ) ) );
+    bclos_frame_s_set( frame, typeof( "create_mesh"         ), sr_create( typeof( "create_mesh_s"         ) ) );
+    bclos_frame_s_set( frame, typeof( "convert_mesh"        ), sr_create( typeof( "convert_mesh_s"        ) ) );
+    bclos_frame_s_set( frame, typeof( "create_sphere_cloud" ), sr_create( typeof( "create_sphere_cloud_s" ) ) );
     bclos_frame_s_set( frame, typeof( "create_hyperboloid1" ), sr_create( typeof( "create_hyperboloid1_s" ) ) );
     bclos_frame_s_set( frame, typeof( "create_hyperboloid2" ), sr_create( typeof( "create_hyperboloid2_s" ) ) );
     bclos_frame_s_set( frame, typeof( "create_ellipsoid"    ), sr_create( typeof( "create_ellipsoid_s"    ) ) );
     bclos_frame_s_set( frame, typeof( "create_cone"         ), sr_create( typeof( "create_cone_s"         ) ) );
+    bclos_frame_s_set( frame, typeof( "create_envelope_box" ), sr_create( typeof( "create_envelope_box_s" ) ) );
+
+    /// distance graph
+    bclos_frame_s_set( frame, typeof( "sdf_sphere"         ), sr_create( typeof( "sdf_sphere_s"         ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_box"            ), sr_create( typeof( "sdf_box_s"            ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_torus"          ), sr_create( typeof( "sdf_torus_s"          ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_cylinder"       ), sr_create( typeof( "sdf_cylinder_s"       ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_plane"          ), sr_create( typeof( "sdf_plane_s"          ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_union"          ), sr_create( typeof( "sdf_union_s"          ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_intersection"   ), sr_create( typeof( "sdf_intersection_s"   ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_difference"     ), sr_create( typeof( "sdf_difference_s"     ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_smooth_union"   ), sr_create( typeof( "sdf_smooth_union_s"   ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_move"           ), sr_create( typeof( "sdf_move_s"           ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_rotate"         ), sr_create( typeof( "sdf_rotate_s"         ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_scale"          ), sr_create( typeof( "sdf_scale_s"          ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_repeat"         ), sr_create( typeof( "sdf_repeat_s"         ) ) );
+    bclos_frame_s_set( frame, typeof( "sdf_displace"       ), sr_create( typeof( "sdf_displace_s"       ) ) );
+    bclos_frame_s_set( frame, typeof( "create_sdf"         ), sr_create( typeof( "create_sdf_s"         ) ) );
 
     /// special functions
     bclos_frame_s_set( frame, typeof( "string_fa"     ), sr_create( typeof( "create_string_fa_s"   ) ) );
@@ -28,6 +28,9 @@
 #include "gmath.h"
 #include "quicktypes.h"
 #include "distance.h"
+#include "bvh.h"
+#include "mesh.h"
+#include "sphere_cloud.h"
 
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -36,15 +39,18 @@ vd_t main_signal_handler( const bcore_signal_s* o )
     bcore_fp_signal_handler arr[] =
     {
         vectors_signal_handler,
+        bvh_signal_handler,
+        mesh_signal_handler,
+        sphere_cloud_signal_handler,
         textures_signal_handler,
         objects_signal_handler,
         compound_signal_handler,
         scene_signal_handler,
         interpreter_signal_handler,
         container_signal_handler,
+        distance_signal_handler,
         closures_signal_handler,
         gmath_signal_handler,
-        distance_signal_handler,
     };
     return bcore_signal_s_broadcast( o, arr, sizeof( arr ) / sizeof( bcore_fp_signal_handler ) );
 }
@@ -0,0 +1,1108 @@
+/** Triangle Mesh */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bcore_spect_inst.h"
+#include "bcore_life.h"
+#include "bcore_spect.h"
+#include "bcore_spect_array.h"
+#include "bcore_sinks.h"
+#include "bcore_file.h"
+
+#include "mesh.h"
+
+/**********************************************************************************************************************/
+/// mesh_s
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( mesh_f2_arr_s, "mesh_f2_arr_s = bcore_inst { aware_t _; f2_t [] arr; }" )
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST
+(
+    mesh_s,
+    "mesh_s = bcore_inst"
+    "{"
+        "aware_t _;"
+        "mesh_f2_arr_s vtx_arr;"
+        "bvh_u2_arr_s tri_arr;"
+        "bvh_s        bvh;"
+    "}"
+)
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** appends to a plain data array (growing space geometrically; size may be increased within space)
+ *  a weak array (space < size) is turned into an owned array
+ */
+static inline void mesh_f2_arr_push( mesh_f2_arr_s* o, f2_t v )
+{
+    if( o->size >= o->space ) bcore_array_a_set_space( (bcore_array*)o, o->size > 0 ? o->size * 2 : 256 );
+    o->data[ o->size++ ] = v;
+}
+
+static inline void mesh_u2_arr_push( bvh_u2_arr_s* o, u2_t v )
+{
+    if( o->size >= o->space ) bcore_array_a_set_space( (bcore_array*)o, o->size > 0 ? o->size * 2 : 256 );
+    o->data[ o->size++ ] = v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void mesh_s_clear( mesh_s* o )
+{
+    // reinitialization also detaches weak arrays referencing a mapped file
+    mesh_s_down( o );
+    mesh_s_init( o );
+}
+
+void mesh_s_push_vertex( mesh_s* o, v3d_s v )
+{
+    mesh_f2_arr_push( &o->vtx_arr, v.x );
+    mesh_f2_arr_push( &o->vtx_arr, v.y );
+    mesh_f2_arr_push( &o->vtx_arr, v.z );
+}
+
+void mesh_s_push_triangle( mesh_s* o, u2_t a, u2_t b, u2_t c )
+{
+    mesh_u2_arr_push( &o->tri_arr, a );
+    mesh_u2_arr_push( &o->tri_arr, b );
+    mesh_u2_arr_push( &o->tri_arr, c );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline v3d_s mesh_s_vtx( const mesh_s* o, u2_t index )
+{
+    const f2_t* v = o->vtx_arr.data + 3 * ( uz_t )index;
+    return ( v3d_s ) { v[ 0 ], v[ 1 ], v[ 2 ] };
+}
+
+/// outward unit normal of triangle
+static inline v3d_s mesh_s_tri_normal( const mesh_s* o, uz_t tri )
+{
+    const u2_t* idx = o->tri_arr.data + 3 * tri;
+    v3d_s a = mesh_s_vtx( o, idx[ 0 ] );
+    v3d_s b = mesh_s_vtx( o, idx[ 1 ] );
+    v3d_s c = mesh_s_vtx( o, idx[ 2 ] );
+    return v3d_s_of_length( v3d_s_mlx( v3d_s_sub( b, a ), v3d_s_sub( c, a ) ), 1.0 );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void mesh_s_prepare( mesh_s* o )
+{
+    uz_t vertices  = mesh_s_vertices( o );
+    uz_t triangles = mesh_s_triangles( o );
+    u2_t* idx = o->tri_arr.data;
+
+    for( uz_t i = 0; i < triangles * 3; i++ )
+    {
+        if( idx[ i ] >= vertices ) ERR_fa( "Triangle #<uz_t> references vertex #<u2_t> (mesh has #<uz_t> vertices).", i / 3, idx[ i ], vertices );
+    }
+
+    // a negative enclosed volume indicates inverted faces
+    f3_t volume = 0;
+    for( uz_t i = 0; i < triangles; i++ )
+    {
+        v3d_s a = mesh_s_vtx( o, idx[ 3 * i     ] );
+        v3d_s b = mesh_s_vtx( o, idx[ 3 * i + 1 ] );
+        v3d_s c = mesh_s_vtx( o, idx[ 3 * i + 2 ] );
+        volume += v3d_s_mlv( a, v3d_s_mlx( b, c ) );
+    }
+
+    if( volume < 0 )
+    {
+        for( uz_t i = 0; i < triangles; i++ )
+        {
+            u2_t t = idx[ 3 * i + 1 ];
+            idx[ 3 * i + 1 ] = idx[ 3 * i + 2 ];
+            idx[ 3 * i + 2 ] = t;
+        }
+    }
+
+    box_s* box_arr = bcore_u_alloc( sizeof( box_s ), NULL, triangles, NULL );
+    for( uz_t i = 0; i < triangles; i++ )
+    {
+        box_s box = box_s_empty();
+        box = box_s_union_pos( box, mesh_s_vtx( o, idx[ 3 * i     ] ) );
+        box = box_s_union_pos( box, mesh_s_vtx( o, idx[ 3 * i + 1 ] ) );
+        box = box_s_union_pos( box, mesh_s_vtx( o, idx[ 3 * i + 2 ] ) );
+        box_arr[ i ] = box;
+    }
+    bvh_s_build( &o->bvh, box_arr, triangles );
+    bcore_free( box_arr );
+}
+
+box_s mesh_s_get_box( const mesh_s* o )
+{
+    return bvh_s_get_box( &o->bvh );
+}
+
+/**********************************************************************************************************************/
+/// parsing
+
+/// memory mapped file
+typedef struct mesh_map_s
+{
+    const char* data;
+    uz_t size;
+} mesh_map_s;
+
+static mesh_map_s mesh_map_open( sc_t file )
+{
+    mesh_map_s map = { NULL, 0 };
+    int fd = open( file, O_RDONLY );
+    if( fd < 0 ) ERR_fa( "Could not open '#<sc_t>'.", file );
+    struct stat st;
+    if( fstat( fd, &st ) != 0 ) ERR_fa( "Could not access '#<sc_t>'.", file );
+    map.size = st.st_size;
+    if( map.size > 0 )
+    {
+        vd_t data = mmap( NULL, map.size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( data == MAP_FAILED ) ERR_fa( "Could not map '#<sc_t>'.", file );
+        map.data = data;
+    }
+    close( fd );
+    return map;
+}
+
+static void mesh_map_close( mesh_map_s* map )
+{
+    if( map->data ) munmap( ( vd_t )map->data, map->size );
+    map->data = NULL;
+    map->size = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Parsing works on a range [ p, end ) of the mapped file, which is not terminated.
+ *  Numbers are parsed by hand for that reason (and because it is considerably faster than strtod).
+ */
+
+static inline bl_t mesh_is_digit( char c ) { return c >= '0' && c <= '9'; }
+static inline bl_t mesh_is_blank( char c ) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static inline const char* mesh_skip_blank( const char* p, const char* end )
+{
+    while( p < end && mesh_is_blank( *p ) ) p++;
+    return p;
+}
+
+/// position after the end of the current line
+static inline const char* mesh_skip_line( const char* p, const char* end )
+{
+    while( p < end && *p != '\n' ) p++;
+    return ( p < end ) ? p + 1 : p;
+}
+
+/// position after the current token (non-blank characters)
+static inline const char* mesh_skip_token( const char* p, const char* end )
+{
+    while( p < end && !mesh_is_blank( *p ) && *p != '\n' ) p++;
+    return p;
+}
+
+static const f3_t mesh_pow10[] =
+{
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+};
+
+static inline f3_t mesh_scale10( f3_t v, s2_t exp10 )
+{
+    if( exp10 >= 0 ) return v * ( exp10 <= 22 ? mesh_pow10[ exp10 ] : pow( 10, exp10 ) );
+    return v / ( -exp10 <= 22 ? mesh_pow10[ -exp10 ] : pow( 10, -exp10 ) );
+}
+
+/// parses a decimal number (leading blanks are skipped); returns false if there is none
+static bl_t mesh_parse_f3( const char** p_p, const char* end, f3_t* val )
+{
+    const char* p = mesh_skip_blank( *p_p, end );
+    bl_t neg = false;
+    if( p < end && ( *p == '-' || *p == '+' ) ) neg = ( *p++ == '-' );
+
+    u3_t mant = 0;
+    s2_t exp10 = 0;
+    uz_t digits = 0;
+    for( ; p < end && mesh_is_digit( *p ); p++, digits++ )
+    {
+        if( mant < 100000000000000000ull ) mant = mant * 10 + ( *p - '0' ); else exp10++;
+    }
+
+    if( p < end && *p == '.' )
+    {
+        for( p++; p < end && mesh_is_digit( *p ); p++, digits++ )
+        {
+            if( mant < 100000000000000000ull ) { mant = mant * 10 + ( *p - '0' ); exp10--; }
+        }
+    }
+
+    if( digits == 0 ) return false;
+
+    if( p < end && ( *p == 'e' || *p == 'E' ) )
+    {
+        const char* q = p + 1;
+        bl_t neg_exp = false;
+        if( q < end && ( *q == '-' || *q == '+' ) ) neg_exp = ( *q++ == '-' );
+        if( q < end && mesh_is_digit( *q ) )
+        {
+            s2_t e = 0;
+            for( ; q < end && mesh_is_digit( *q ); q++ ) if( e < 10000 ) e = e * 10 + ( *q - '0' );
+            exp10 += neg_exp ? -e : e;
+            p = q;
+        }
+    }
+
+    f3_t v = mesh_scale10( mant, exp10 );
+    *val = neg ? -v : v;
+    *p_p = p;
+    return true;
+}
+
+/// parses a decimal integer (leading blanks are skipped); returns false if there is none
+static bl_t mesh_parse_s3( const char** p_p, const char* end, s3_t* val )
+{
+    const char* p = mesh_skip_blank( *p_p, end );
+    bl_t neg = false;
+    if( p < end && ( *p == '-' || *p == '+' ) ) neg = ( *p++ == '-' );
+    if( p == end || !mesh_is_digit( *p ) ) return false;
+    s3_t v = 0;
+    for( ; p < end && mesh_is_digit( *p ); p++ ) v = v * 10 + ( *p - '0' );
+    *val = neg ? -v : v;
+    *p_p = p;
+    return true;
+}
+
+/// true when the token at p equals word
+static bl_t mesh_token_is( const char* p, const char* end, sc_t word )
+{
+    for( ; *word; word++, p++ ) if( p == end || *p != *word ) return false;
+    return p == end || mesh_is_blank( *p ) || *p == '\n';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Wavefront obj: 'v x y z' and 'f i j k ...' (indices may be given as i/t/n; negative indices are relative).
+ *  All other statements are ignored.
+ */
+static void mesh_s_parse_obj( mesh_s* o, const char* p, const char* end, sc_t file )
+{
+    uz_t line = 1;
+    for( ; p < end; line++ )
+    {
+        p = mesh_skip_blank( p, end );
+        if( end - p > 1 && p[ 0 ] == 'v' && mesh_is_blank( p[ 1 ] ) )
+        {
+            p++;
+            v3d_s v;
+            if( !mesh_parse_f3( &p, end, &v.x ) || !mesh_parse_f3( &p, end, &v.y ) || !mesh_parse_f3( &p, end, &v.z ) )
+            {
+                ERR_fa( "#<sc_t>:#<uz_t>: Vertex coordinates expected.", file, line );
+            }
+            mesh_s_push_vertex( o, v );
+        }
+        else if( end - p > 1 && p[ 0 ] == 'f' && mesh_is_blank( p[ 1 ] ) )
+        {
+            p++;
+            s3_t vertices = mesh_s_vertices( o );
+            uz_t count = 0;
+            u2_t first = 0, prev = 0;
+            s3_t index;
+            while( mesh_parse_s3( &p, end, &index ) )
+            {
+                if( index < 0 ) index += vertices; else index -= 1;
+                if( index < 0 || index >= vertices ) ERR_fa( "#<sc_t>:#<uz_t>: Invalid vertex index.", file, line );
+                p = mesh_skip_token( p, end ); // texture and normal indices
+
+                if( count == 0 ) first = index;
+                if( count >= 2 ) mesh_s_push_triangle( o, first, prev, index );
+                prev = index;
+                count++;
+            }
+            if( count < 3 ) ERR_fa( "#<sc_t>:#<uz_t>: Face with less than three vertices.", file, line );
+        }
+        p = mesh_skip_line( p, end );
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Stanford ply (ascii, binary_little_endian, binary_big_endian)
+ *  Used are element 'vertex' (properties x, y, z) and element 'face' (list property vertex_indices or vertex_index).
+ *  All other elements and properties are skipped.
+ */
+
+#define MESH_PLY_MAX_ELEMENTS   16
+#define MESH_PLY_MAX_PROPERTIES 32
+
+enum
+{
+    MESH_PLY_NONE = 0,
+    MESH_PLY_S0,
+    MESH_PLY_U0,
+    MESH_PLY_S1,
+    MESH_PLY_U1,
+    MESH_PLY_S2,
+    MESH_PLY_U2,
+    MESH_PLY_F2,
+    MESH_PLY_F3,
+};
+
+enum
+{
+    MESH_PLY_ASCII = 0,
+    MESH_PLY_BINARY_LE,
+    MESH_PLY_BINARY_BE,
+};
+
+static const uz_t mesh_ply_type_size[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+
+typedef struct mesh_ply_property_s
+{
+    u0_t type;
+    u0_t count_type; // list: type of element count; MESH_PLY_NONE: scalar property
+    s2_t role;       // vertex: 0, 1, 2 for x, y, z; face: 0 for vertex indices; -1: unused
+} mesh_ply_property_s;
+
+typedef struct mesh_ply_element_s
+{
+    s2_t kind; // 1: vertex; 2: face; 0: other
+    uz_t count;
+    uz_t size;
+    mesh_ply_property_s property[ MESH_PLY_MAX_PROPERTIES ];
+} mesh_ply_element_s;
+
+static u0_t mesh_ply_type( const char* p, const char* end )
+{
+    if( mesh_token_is( p, end, "char"    ) || mesh_token_is( p, end, "int8"    ) ) return MESH_PLY_S0;
+    if( mesh_token_is( p, end, "uchar"   ) || mesh_token_is( p, end, "uint8"   ) ) return MESH_PLY_U0;
+    if( mesh_token_is( p, end, "short"   ) || mesh_token_is( p, end, "int16"   ) ) return MESH_PLY_S1;
+    if( mesh_token_is( p, end, "ushort"  ) || mesh_token_is( p, end, "uint16"  ) ) return MESH_PLY_U1;
+    if( mesh_token_is( p, end, "int"     ) || mesh_token_is( p, end, "int32"   ) ) return MESH_PLY_S2;
+    if( mesh_token_is( p, end, "uint"    ) || mesh_token_is( p, end, "uint32"  ) ) return MESH_PLY_U2;
+    if( mesh_token_is( p, end, "float"   ) || mesh_token_is( p, end, "float32" ) ) return MESH_PLY_F2;
+    if( mesh_token_is( p, end, "double"  ) || mesh_token_is( p, end, "float64" ) ) return MESH_PLY_F3;
+    return MESH_PLY_NONE;
+}
+
+/// reads one value of given type
+static f3_t mesh_ply_read( const char** p_p, const char* end, u0_t type, s2_t format, sc_t file )
+{
+    if( format == MESH_PLY_ASCII )
+    {
+        // values of an element may continue on the next line
+        while( *p_p < end && ( mesh_is_blank( **p_p ) || **p_p == '\n' ) ) ( *p_p )++;
+        f3_t v;
+        if( !mesh_parse_f3( p_p, end, &v ) ) ERR_fa( "#<sc_t>: Number expected.", file );
+        return v;
+    }
+
+    uz_t size = mesh_ply_type_size[ type ];
+    if( ( uz_t )( end - *p_p ) < size ) ERR_fa( "#<sc_t>: Unexpected end of data.", file );
+
+    // assemble value as little endian integer
+    const u0_t* b = ( const u0_t* )*p_p;
+    u3_t u = 0;
+    if( format == MESH_PLY_BINARY_LE )
+    {
+        for( uz_t i = size; i > 0; i-- ) u = ( u << 8 ) | b[ i - 1 ];
+    }
+    else
+    {
+        for( uz_t i = 0; i < size; i++ ) u = ( u << 8 ) | b[ i ];
+    }
+    *p_p += size;
+
+    switch( type )
+    {
+        case MESH_PLY_S0: return ( s0_t )u;
+        case MESH_PLY_U0: return ( u0_t )u;
+        case MESH_PLY_S1: return ( s1_t )u;
+        case MESH_PLY_U1: return ( u1_t )u;
+        case MESH_PLY_S2: return ( s2_t )u;
+        case MESH_PLY_U2: return ( u2_t )u;
+        case MESH_PLY_F2: { union { u2_t u; f2_t f; } c; c.u = u; return c.f; }
+        case MESH_PLY_F3: { union { u3_t u; f3_t f; } c; c.u = u; return c.f; }
+        default: break;
+    }
+    return 0;
+}
+
+static void mesh_s_parse_ply( mesh_s* o, const char* p, const char* end, sc_t file )
+{
+    mesh_ply_element_s element[ MESH_PLY_MAX_ELEMENTS ];
+    uz_t elements = 0;
+    s2_t format = -1;
+
+    if( !mesh_token_is( p, end, "ply" ) ) ERR_fa( "#<sc_t>: Not a ply file.", file );
+
+    // header
+    for( p = mesh_skip_line( p, end ); ; p = mesh_skip_line( p, end ) )
+    {
+        if( p == end ) ERR_fa( "#<sc_t>: Missing 'end_header'.", file );
+        p = mesh_skip_blank( p, end );
+        if( mesh_token_is( p, end, "end_header" ) )
+        {
+            p = mesh_skip_line( p, end );
+            break;
+        }
+        else if( mesh_token_is( p, end, "format" ) )
+        {
+            p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+            if(      mesh_token_is( p, end, "ascii"                ) ) format = MESH_PLY_ASCII;
+            else if( mesh_token_is( p, end, "binary_little_endian" ) ) format = MESH_PLY_BINARY_LE;
+            else if( mesh_token_is( p, end, "binary_big_endian"    ) ) format = MESH_PLY_BINARY_BE;
+            else ERR_fa( "#<sc_t>: Unknown format.", file );
+        }
+        else if( mesh_token_is( p, end, "element" ) )
+        {
+            if( elements == MESH_PLY_MAX_ELEMENTS ) ERR_fa( "#<sc_t>: Too many elements.", file );
+            mesh_ply_element_s* e = &element[ elements++ ];
+            p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+            e->kind = mesh_token_is( p, end, "vertex" ) ? 1 : mesh_token_is( p, end, "face" ) ? 2 : 0;
+            p = mesh_skip_token( p, end );
+            s3_t count;
+            if( !mesh_parse_s3( &p, end, &count ) || count < 0 ) ERR_fa( "#<sc_t>: Element count expected.", file );
+            e->count = count;
+            e->size = 0;
+        }
+        else if( mesh_token_is( p, end, "property" ) )
+        {
+            if( elements == 0 ) ERR_fa( "#<sc_t>: Property without element.", file );
+            mesh_ply_element_s* e = &element[ elements - 1 ];
+            if( e->size == MESH_PLY_MAX_PROPERTIES ) ERR_fa( "#<sc_t>: Too many properties.", file );
+            mesh_ply_property_s* prop = &e->property[ e->size++ ];
+            prop->count_type = MESH_PLY_NONE;
+            prop->role = -1;
+
+            p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+            if( mesh_token_is( p, end, "list" ) )
+            {
+                p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+                prop->count_type = mesh_ply_type( p, end );
+                if( prop->count_type == MESH_PLY_NONE ) ERR_fa( "#<sc_t>: Unknown property type.", file );
+                p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+            }
+            prop->type = mesh_ply_type( p, end );
+            if( prop->type == MESH_PLY_NONE ) ERR_fa( "#<sc_t>: Unknown property type.", file );
+            p = mesh_skip_blank( mesh_skip_token( p, end ), end );
+
+            if( e->kind == 1 && prop->count_type == MESH_PLY_NONE )
+            {
+                if( mesh_token_is( p, end, "x" ) ) prop->role = 0;
+                if( mesh_token_is( p, end, "y" ) ) prop->role = 1;
+                if( mesh_token_is( p, end, "z" ) ) prop->role = 2;
+            }
+            else if( e->kind == 2 && prop->count_type != MESH_PLY_NONE )
+            {
+                if( mesh_token_is( p, end, "vertex_indices" ) || mesh_token_is( p, end, "vertex_index" ) ) prop->role = 0;
+            }
+        }
+    }
+
+    if( format < 0 ) ERR_fa( "#<sc_t>: Missing format.", file );
+
+    // data
+    for( uz_t i = 0; i < elements; i++ )
+    {
+        const mesh_ply_element_s* e = &element[ i ];
+        if( e->kind == 1 ) bcore_array_a_set_space( (bcore_array*)&o->vtx_arr, o->vtx_arr.size + e->count * 3 );
+        if( e->kind == 2 ) bcore_array_a_set_space( (bcore_array*)&o->tri_arr, o->tri_arr.size + e->count * 3 );
+
+        for( uz_t j = 0; j < e->count; j++ )
+        {
+            v3d_s v = v3d_s_zero();
+            for( uz_t k = 0; k < e->size; k++ )
+            {
+                const mesh_ply_property_s* prop = &e->property[ k ];
+                if( prop->count_type == MESH_PLY_NONE )
+                {
+                    f3_t val = mesh_ply_read( &p, end, prop->type, format, file );
+                    if( e->kind == 1 && prop->role >= 0 ) ( &v.x )[ prop->role ] = val;
+                }
+                else
+                {
+                    s3_t count = mesh_ply_read( &p, end, prop->count_type, format, file );
+                    s3_t vertices = mesh_s_vertices( o );
+                    bl_t use = ( e->kind == 2 && prop->role == 0 );
+                    if( use && count < 3 ) ERR_fa( "#<sc_t>: Face with less than three vertices.", file );
+                    u2_t first = 0, prev = 0;
+                    for( s3_t l = 0; l < count; l++ )
+                    {
+                        s3_t index = mesh_ply_read( &p, end, prop->type, format, file );
+                        if( !use ) continue;
+                        if( index < 0 || index >= vertices ) ERR_fa( "#<sc_t>: Invalid vertex index.", file );
+                        if( l == 0 ) first = index;
+                        if( l >= 2 ) mesh_s_push_triangle( o, first, prev, index );
+                        prev = index;
+                    }
+                }
+            }
+            if( e->kind == 1 ) mesh_s_push_vertex( o, v );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// true when file name ends with ext (case insensitive)
+static bl_t mesh_has_extension( sc_t file, sc_t ext )
+{
+    uz_t n_file = strlen( file );
+    uz_t n_ext  = strlen( ext );
+    if( n_file < n_ext ) return false;
+    sc_t p = file + n_file - n_ext;
+    for( uz_t i = 0; i < n_ext; i++ )
+    {
+        char c = p[ i ];
+        if( c >= 'A' && c <= 'Z' ) c += 'a' - 'A';
+        if( c != ext[ i ] ) return false;
+    }
+    return true;
+}
+
+/**********************************************************************************************************************/
+/// binary format
+
+/// section identifiers
+enum
+{
+    MESH_SECTION_VTX = 0,  // vertices
+    MESH_SECTION_TRI,      // triangles
+    MESH_SECTION_NODE,     // bvh nodes
+    MESH_SECTION_NODE_BOX, // bvh node bounds
+    MESH_SECTION_IDX,      // bvh slots
+    MESH_SECTIONS
+};
+
+static const uz_t mesh_section_unit[] = { sizeof( f2_t ), sizeof( u2_t ), sizeof( bvh_node_s ), sizeof( f3_t ), sizeof( u2_t ) };
+
+/// magic: "AMESH" + format version
+static const char mesh_file_magic[ 8 ] = { 'A', 'M', 'E', 'S', 'H', '0', '0', '1' };
+
+typedef struct mesh_file_header_s
+{
+    char magic[ 8 ];
+    u2_t byte_order; // 0x01020304 as written by the host
+    u2_t unit[ MESH_SECTIONS ];   // sizes of elements (guards against incompatible type layouts)
+    u3_t offs[ MESH_SECTIONS ];   // byte offset of section in file; multiple of MESH_FILE_ALIGN
+    u3_t size[ MESH_SECTIONS ];   // number of elements in section
+} mesh_file_header_s;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Mapped binary files remain open until shutdown (mesh_signal_handler: down1) because meshes reference them.
+ *  A file is mapped once per path: loading it again (e.g. when a script rebuilds the scene for each frame
+ *  of an animation) attaches the existing mapping without any file access.
+ */
+typedef struct mesh_file_s
+{
+    tp_t key; // hash of path; 0 when detached (file was overwritten)
+    mesh_map_s map;
+} mesh_file_s;
+
+static mesh_file_s* mesh_file_arr_g  = NULL;
+static uz_t         mesh_file_size_g = 0;
+
+static const mesh_map_s* mesh_file_get_map( sc_t file )
+{
+    tp_t key = typeof( file );
+    for( uz_t i = 0; i < mesh_file_size_g; i++ )
+    {
+        if( mesh_file_arr_g[ i ].key == key ) return &mesh_file_arr_g[ i ].map;
+    }
+
+    mesh_file_arr_g = bcore_u_alloc( sizeof( mesh_file_s ), mesh_file_arr_g, mesh_file_size_g + 1, NULL );
+    mesh_file_s* entry = &mesh_file_arr_g[ mesh_file_size_g++ ];
+    entry->key = key;
+    entry->map = mesh_map_open( file );
+    return &entry->map;
+}
+
+/// detaches the mapping of a file (which is about to be replaced) from its path
+static void mesh_file_detach( sc_t file )
+{
+    tp_t key = typeof( file );
+    for( uz_t i = 0; i < mesh_file_size_g; i++ )
+    {
+        if( mesh_file_arr_g[ i ].key == key ) mesh_file_arr_g[ i ].key = 0;
+    }
+}
+
+static void mesh_file_close_all( void )
+{
+    for( uz_t i = 0; i < mesh_file_size_g; i++ ) mesh_map_close( &mesh_file_arr_g[ i ].map );
+    bcore_free( mesh_file_arr_g );
+    mesh_file_arr_g = NULL;
+    mesh_file_size_g = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// lets a plain data array reference external data (weak array: space == 0)
+static void mesh_arr_set_weak( bcore_array_dyn_solid_static_s* arr, const mesh_map_s* map, const mesh_file_header_s* header, uz_t section )
+{
+    arr->data  = ( vd_t )( map->data + header->offs[ section ] );
+    arr->size  = header->size[ section ];
+    arr->space = 0;
+}
+
+/** Attaches mesh to the mapped file.
+ *  Only the header is verified; the content is used as written by mesh_s_save.
+ */
+static void mesh_s_open_binary( mesh_s* o, sc_t file )
+{
+    const mesh_map_s* map = mesh_file_get_map( file );
+    if( map->size < sizeof( mesh_file_header_s ) ) ERR_fa( "#<sc_t>: Not a binary mesh file.", file );
+    const mesh_file_header_s* header = ( const mesh_file_header_s* )map->data;
+
+    if( memcmp( header->magic, mesh_file_magic, sizeof( mesh_file_magic ) ) != 0 ) ERR_fa( "#<sc_t>: Not a binary mesh file (or unsupported version).", file );
+    if( header->byte_order != 0x01020304 ) ERR_fa( "#<sc_t>: File was written on a host of different byte order. Convert the source mesh on this host.", file );
+
+    for( uz_t i = 0; i < MESH_SECTIONS; i++ )
+    {
+        if( header->unit[ i ] != mesh_section_unit[ i ] ) ERR_fa( "#<sc_t>: Incompatible element size in section #<uz_t>.", file, i );
+        if( ( header->offs[ i ] % MESH_FILE_ALIGN ) != 0 ) ERR_fa( "#<sc_t>: Misaligned section #<uz_t>.", file, i );
+        if( header->offs[ i ] > map->size || header->size[ i ] > ( map->size - header->offs[ i ] ) / mesh_section_unit[ i ] )
+        {
+            ERR_fa( "#<sc_t>: Section #<uz_t> exceeds file size (truncated file?).", file, i );
+        }
+    }
+
+    uz_t triangles = header->size[ MESH_SECTION_TRI ] / 3;
+    uz_t nodes     = header->size[ MESH_SECTION_NODE ];
+    if
+    (
+        ( header->size[ MESH_SECTION_VTX ] % 3 ) != 0 ||
+        ( header->size[ MESH_SECTION_TRI ] % 3 ) != 0 ||
+        header->size[ MESH_SECTION_NODE_BOX ] != nodes * 6 ||
+        header->size[ MESH_SECTION_IDX ] != ( nodes > 0 ? triangles : 0 )
+    )
+    {
+        ERR_fa( "#<sc_t>: Inconsistent section sizes.", file );
+    }
+
+    mesh_arr_set_weak( &o->vtx_arr.arr,       map, header, MESH_SECTION_VTX );
+    mesh_arr_set_weak( &o->tri_arr.arr,       map, header, MESH_SECTION_TRI );
+    mesh_arr_set_weak( &o->bvh.node_arr.arr,  map, header, MESH_SECTION_NODE );
+    mesh_arr_set_weak( &o->bvh.node_box.arr,  map, header, MESH_SECTION_NODE_BOX );
+    mesh_arr_set_weak( &o->bvh.idx_arr.arr,   map, header, MESH_SECTION_IDX );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void mesh_sink_push_padding( vd_t sink, uz_t* pos )
+{
+    static const u0_t zero[ 256 ] = { 0 };
+    while( ( *pos % MESH_FILE_ALIGN ) != 0 )
+    {
+        uz_t n = MESH_FILE_ALIGN - ( *pos % MESH_FILE_ALIGN );
+        if( n > sizeof( zero ) ) n = sizeof( zero );
+        bcore_sink_a_push_data( sink, zero, n );
+        *pos += n;
+    }
+}
+
+/** The file is written under a temporary name and renamed thereafter,
+ *  so that a mapping of a previous version remains valid.
+ */
+void mesh_s_save( const mesh_s* o, sc_t file )
+{
+    if( mesh_s_triangles( o ) > 0 && o->bvh.node_arr.size == 0 ) ERR_fa( "Saving '#<sc_t>': Mesh is not prepared.", file );
+
+    const vc_t data[ MESH_SECTIONS ] = { o->vtx_arr.data, o->tri_arr.data, o->bvh.node_arr.data, o->bvh.node_box.data, o->bvh.idx_arr.data };
+
+    mesh_file_header_s header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, mesh_file_magic, sizeof( mesh_file_magic ) );
+    header.byte_order = 0x01020304;
+    header.size[ MESH_SECTION_VTX      ] = o->vtx_arr.size;
+    header.size[ MESH_SECTION_TRI      ] = o->tri_arr.size;
+    header.size[ MESH_SECTION_NODE     ] = o->bvh.node_arr.size;
+    header.size[ MESH_SECTION_NODE_BOX ] = o->bvh.node_box.size;
+    header.size[ MESH_SECTION_IDX      ] = o->bvh.idx_arr.size;
+
+    uz_t pos = sizeof( header );
+    for( uz_t i = 0; i < MESH_SECTIONS; i++ )
+    {
+        pos += ( MESH_FILE_ALIGN - ( pos % MESH_FILE_ALIGN ) ) % MESH_FILE_ALIGN;
+        header.unit[ i ] = mesh_section_unit[ i ];
+        header.offs[ i ] = pos;
+        pos += header.size[ i ] * mesh_section_unit[ i ];
+    }
+
+    st_s* tmp_file = st_s_create_fa( "#<sc_t>.tmp", file );
+    vd_t sink = bcore_sink_open_file( tmp_file->sc );
+
+    pos = 0;
+    bcore_sink_a_push_data( sink, &header, sizeof( header ) );
+    pos += sizeof( header );
+    for( uz_t i = 0; i < MESH_SECTIONS; i++ )
+    {
+        mesh_sink_push_padding( sink, &pos );
+        uz_t size = header.size[ i ] * mesh_section_unit[ i ];
+        if( size > 0 ) bcore_sink_a_push_data( sink, data[ i ], size );
+        pos += size;
+    }
+
+    bcore_inst_a_discard( sink );
+
+    mesh_file_detach( file );
+    if( !bcore_file_rename( tmp_file->sc, file ) ) ERR_fa( "Could not rename '#<sc_t>' to '#<sc_t>'.", tmp_file->sc, file );
+    st_s_discard( tmp_file );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void mesh_convert( sc_t src_file, sc_t dst_file )
+{
+    mesh_s* mesh = mesh_s_create_load( src_file );
+    mesh_s_save( mesh, dst_file );
+    mesh_s_discard( mesh );
+}
+
+/**********************************************************************************************************************/
+/// loading
+
+void mesh_s_load( mesh_s* o, sc_t file )
+{
+    mesh_s_clear( o );
+
+    if( mesh_has_extension( file, MESH_FILE_EXTENSION ) )
+    {
+        mesh_s_open_binary( o, file );
+        return;
+    }
+
+    mesh_map_s map = mesh_map_open( file );
+    const char* end = map.data + map.size;
+
+    if( mesh_has_extension( file, ".obj" ) )
+    {
+        mesh_s_parse_obj( o, map.data, end, file );
+    }
+    else if( mesh_has_extension( file, ".ply" ) )
+    {
+        mesh_s_parse_ply( o, map.data, end, file );
+    }
+    else
+    {
+        mesh_map_close( &map );
+        ERR_fa( "Unknown mesh format of file '#<sc_t>' (use .obj, .ply or #<sc_t>).", file, MESH_FILE_EXTENSION );
+    }
+
+    mesh_map_close( &map );
+    mesh_s_prepare( o );
+}
+
+mesh_s* mesh_s_create_load( sc_t file )
+{
+    mesh_s* o = mesh_s_create();
+    mesh_s_load( o, file );
+    return o;
+}
+
+/**********************************************************************************************************************/
+/// intersection
+
+/** Ray prepared for the watertight test:
+ *  kz is the dominant axis of the direction; the shear ( sx, sy, sz ) maps the direction onto the kz-axis.
+ */
+typedef struct mesh_ray_s
+{
+    v3d_s p;
+    v3d_s inv_d;
+    uz_t kx, ky, kz;
+    f3_t sx, sy, sz;
+} mesh_ray_s;
+
+static mesh_ray_s mesh_ray_create( const ray_s* r )
+{
+    mesh_ray_s o;
+    o.p = r->p;
+    o.inv_d = ray_inv_dir( r );
+
+    f3_t ax = f3_abs( r->d.x );
+    f3_t ay = f3_abs( r->d.y );
+    f3_t az = f3_abs( r->d.z );
+    o.kz = ( ax > ay ) ? ( ax > az ? 0 : 2 ) : ( ay > az ? 1 : 2 );
+    o.kx = ( o.kz + 1 ) % 3;
+    o.ky = ( o.kx + 1 ) % 3;
+
+    const f3_t* d = &r->d.x;
+    o.sz = 1.0 / d[ o.kz ];
+    o.sx = d[ o.kx ] * o.sz;
+    o.sy = d[ o.ky ] * o.sz;
+    return o;
+}
+
+/// offset of crossing with triangle or f3_inf
+static inline f3_t mesh_s_tri_hit( const mesh_s* o, const mesh_ray_s* r, uz_t tri )
+{
+    const u2_t* idx = o->tri_arr.data + 3 * tri;
+    const f2_t* va  = o->vtx_arr.data + 3 * ( uz_t )idx[ 0 ];
+    const f2_t* vb  = o->vtx_arr.data + 3 * ( uz_t )idx[ 1 ];
+    const f2_t* vc  = o->vtx_arr.data + 3 * ( uz_t )idx[ 2 ];
+    const f3_t* p   = &r->p.x;
+
+    f3_t az = va[ r->kz ] - p[ r->kz ];
+    f3_t bz = vb[ r->kz ] - p[ r->kz ];
+    f3_t cz = vc[ r->kz ] - p[ r->kz ];
+    f3_t ax = va[ r->kx ] - p[ r->kx ] - r->sx * az;
+    f3_t ay = va[ r->ky ] - p[ r->ky ] - r->sy * az;
+    f3_t bx = vb[ r->kx ] - p[ r->kx ] - r->sx * bz;
+    f3_t by = vb[ r->ky ] - p[ r->ky ] - r->sy * bz;
+    f3_t cx = vc[ r->kx ] - p[ r->kx ] - r->sx * cz;
+    f3_t cy = vc[ r->ky ] - p[ r->ky ] - r->sy * cz;
+
+    // scaled barycentric coordinates; edges shared by two triangles yield identical values of opposite sign
+    f3_t u = cx * by - cy * bx;
+    f3_t v = ax * cy - ay * cx;
+    f3_t w = bx * ay - by * ax;
+    if( ( u < 0 || v < 0 || w < 0 ) && ( u > 0 || v > 0 || w > 0 ) ) return f3_inf;
+
+    f3_t det = u + v + w;
+    if( det == 0 ) return f3_inf;
+    return r->sz * ( u * az + v * bz + w * cz ) / det;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+f3_t mesh_s_ray_hit( const mesh_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    const bvh_s* bvh = &o->bvh;
+    if( bvh->node_arr.size == 0 ) return f3_inf;
+
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    const u2_t* idx_arr = bvh->idx_arr.data;
+    mesh_ray_s ray = mesh_ray_create( r );
+
+    uz_t stack_node[ BVH_MAX_DEPTH ];
+    f3_t stack_offs[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+
+    f3_t min_a = f3_inf;
+    uz_t min_tri = 0;
+    if( !( bvh_s_node_ray_entry( bvh, 0, ray.p, ray.inv_d ) < min_a ) ) return f3_inf;
+
+    // front-to-back traversal (see compound_s_bvh_hit)
+    uz_t node = 0;
+    bl_t active = true;
+    while( active )
+    {
+        const bvh_node_s* nd = &node_arr[ node ];
+        if( nd->count > 0 )
+        {
+            for( uz_t i = nd->offs; i < nd->offs + nd->count; i++ )
+            {
+                f3_t a = mesh_s_tri_hit( o, &ray, idx_arr[ i ] );
+                if( a > 0 && a < min_a )
+                {
+                    min_a = a;
+                    min_tri = idx_arr[ i ];
+                }
+            }
+        }
+        else
+        {
+            uz_t near = node + 1;
+            uz_t far  = nd->offs;
+            f3_t near_offs = bvh_s_node_ray_entry( bvh, near, ray.p, ray.inv_d );
+            f3_t far_offs  = bvh_s_node_ray_entry( bvh, far,  ray.p, ray.inv_d );
+            if( far_offs < near_offs )
+            {
+                uz_t t = near; near = far; far = t;
+                f3_t t_offs = near_offs; near_offs = far_offs; far_offs = t_offs;
+            }
+
+            if( near_offs < min_a )
+            {
+                if( far_offs < min_a )
+                {
+                    stack_node[ stack_size ] = far;
+                    stack_offs[ stack_size ] = far_offs;
+                    stack_size++;
+                }
+                node = near;
+                continue;
+            }
+        }
+
+        active = false;
+        while( stack_size > 0 )
+        {
+            stack_size--;
+            if( stack_offs[ stack_size ] < min_a )
+            {
+                node = stack_node[ stack_size ];
+                active = true;
+                break;
+            }
+        }
+    }
+
+    if( min_a < f3_inf && p_nor ) *p_nor = mesh_s_tri_normal( o, min_tri );
+    return min_a;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+typedef struct mesh_crossing_s
+{
+    f3_t a;
+    uz_t tri;
+    bl_t entry; // ray enters the inside area
+} mesh_crossing_s;
+
+bl_t mesh_s_ray_crossings( const mesh_s* o, const ray_s* r, f3_t* offs, v3d_s* nor, uz_t max_size, uz_t* size )
+{
+    *size = 0;
+    const bvh_s* bvh = &o->bvh;
+    if( bvh->node_arr.size == 0 ) return true;
+
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    const u2_t* idx_arr = bvh->idx_arr.data;
+    mesh_ray_s ray = mesh_ray_create( r );
+
+    // one additional slot to detect overflow after merging coincident crossings
+    mesh_crossing_s crs[ MESH_MAX_CROSSINGS + 1 ];
+    uz_t crs_max = max_size < MESH_MAX_CROSSINGS ? max_size + 1 : MESH_MAX_CROSSINGS + 1;
+    uz_t crs_size = 0;
+
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+    if( bvh_s_node_ray_entry( bvh, 0, ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = 0;
+
+    while( stack_size > 0 )
+    {
+        const bvh_node_s* nd = &node_arr[ stack[ --stack_size ] ];
+        if( nd->count > 0 )
+        {
+            for( uz_t i = nd->offs; i < nd->offs + nd->count; i++ )
+            {
+                uz_t tri = idx_arr[ i ];
+                f3_t a = mesh_s_tri_hit( o, &ray, tri );
+                if( !( a > 0 && a < f3_inf ) ) continue;
+
+                bl_t entry = v3d_s_mlv( mesh_s_tri_normal( o, tri ), r->d ) < 0;
+
+                // insertion in ascending order; coincident crossings of equal orientation are merged
+                uz_t j = crs_size;
+                while( j > 0 && crs[ j - 1 ].a > a ) j--;
+                if( j > 0 && crs[ j - 1 ].a == a && crs[ j - 1 ].entry == entry ) continue;
+                if( crs_size == crs_max ) return false;
+                for( uz_t k = crs_size; k > j; k-- ) crs[ k ] = crs[ k - 1 ];
+                crs[ j ] = ( mesh_crossing_s ) { .a = a, .tri = tri, .entry = entry };
+                crs_size++;
+            }
+        }
+        else
+        {
+            uz_t left  = ( nd - node_arr ) + 1;
+            uz_t right = nd->offs;
+            if( bvh_s_node_ray_entry( bvh, right, ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = right;
+            if( bvh_s_node_ray_entry( bvh, left,  ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = left;
+        }
+    }
+
+    if( crs_size > max_size ) return false;
+
+    for( uz_t i = 0; i < crs_size; i++ )
+    {
+        offs[ i ] = crs[ i ].a;
+        if( nor ) nor[ i ] = mesh_s_tri_normal( o, crs[ i ].tri );
+    }
+    *size = crs_size;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+s2_t mesh_s_side( const mesh_s* o, v3d_s pos )
+{
+    const bvh_s* bvh = &o->bvh;
+    if( bvh->node_arr.size == 0 ) return 1;
+
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    const u2_t* idx_arr = bvh->idx_arr.data;
+
+    /** Parity of crossings along a fixed direction.
+     *  The direction is chosen oblique to the coordinate axes such that rays rarely pass exactly through
+     *  vertices or edges of axis aligned meshes.
+     */
+    ray_s r = { .p = pos, .d = v3d_s_of_length( ( v3d_s ) { 0.5410, 0.6299, 0.5571 }, 1.0 ) };
+    mesh_ray_s ray = mesh_ray_create( &r );
+
+    uz_t crossings = 0;
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+    if( bvh_s_node_ray_entry( bvh, 0, ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = 0;
+
+    while( stack_size > 0 )
+    {
+        const bvh_node_s* nd = &node_arr[ stack[ --stack_size ] ];
+        if( nd->count > 0 )
+        {
+            for( uz_t i = nd->offs; i < nd->offs + nd->count; i++ )
+            {
+                f3_t a = mesh_s_tri_hit( o, &ray, idx_arr[ i ] );
+                if( a > 0 && a < f3_inf ) crossings++;
+            }
+        }
+        else
+        {
+            uz_t left  = ( nd - node_arr ) + 1;
+            uz_t right = nd->offs;
+            if( bvh_s_node_ray_entry( bvh, right, ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = right;
+            if( bvh_s_node_ray_entry( bvh, left,  ray.p, ray.inv_d ) < f3_inf ) stack[ stack_size++ ] = left;
+        }
+    }
+
+    return ( crossings & 1 ) ? -1 : 1;
+}
+
+/**********************************************************************************************************************/
+
+vd_t mesh_signal_handler( const bcore_signal_s* o )
+{
+    switch( bcore_signal_s_handle_type( o, typeof( "mesh" ) ) )
+    {
+        case TYPEOF_init1:
+        {
+            BCORE_REGISTER_OBJECT( mesh_f2_arr_s );
+            BCORE_REGISTER_OBJECT( mesh_s );
+        }
+        break;
+
+        case TYPEOF_down1:
+        {
+            mesh_file_close_all();
+        }
+        break;
+
+        default: break;
+    }
+    return NULL;
+}
+
+/**********************************************************************************************************************/
+
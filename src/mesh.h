@@ -0,0 +1,131 @@
+/** Triangle Mesh */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef MESH_H
+#define MESH_H
+
+#include "bcore_std.h"
+
+#include "quicktypes.h"
+#include "vectors.h"
+#include "gmath.h"
+#include "bvh.h"
+
+/**********************************************************************************************************************/
+/** Indexed triangle mesh with its own bounding volume hierarchy
+ *
+ *  vtx_arr holds x, y, z of each vertex; tri_arr holds three vertex indices per triangle.
+ *  Triangles are intersected with the watertight algorithm of Woop, Benthin and Wald (2013),
+ *  so rays cannot slip through shared edges.
+ *  Inside and outside are determined by the parity of surface crossings, which requires a closed mesh.
+ *  Faces are oriented such that ( b - a ) x ( c - a ) points outward (mesh_s_prepare corrects inverted meshes).
+ *  Vertices are stored in single precision, which keeps large meshes compact and allows
+ *  the binary format (see below) to be used in place.
+ */
+
+/// maximum number of crossings collected along a ray by mesh_s_ray_crossings
+#define MESH_MAX_CROSSINGS 64
+
+#define TYPEOF_mesh_f2_arr_s typeof( "mesh_f2_arr_s" )
+typedef struct mesh_f2_arr_s
+{
+    aware_t _;
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            f2_t* data;
+            uz_t size, space;
+        };
+    };
+} mesh_f2_arr_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( mesh_f2_arr_s )
+
+#define TYPEOF_mesh_s typeof( "mesh_s" )
+typedef struct mesh_s
+{
+    aware_t _;
+    mesh_f2_arr_s vtx_arr;
+    bvh_u2_arr_s tri_arr;
+    bvh_s        bvh; // built by mesh_s_prepare
+} mesh_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( mesh_s )
+
+static inline uz_t mesh_s_vertices(  const mesh_s* o ) { return o->vtx_arr.size / 3; }
+static inline uz_t mesh_s_triangles( const mesh_s* o ) { return o->tri_arr.size / 3; }
+
+void mesh_s_clear(         mesh_s* o );
+void mesh_s_push_vertex(   mesh_s* o, v3d_s v );
+void mesh_s_push_triangle( mesh_s* o, u2_t a, u2_t b, u2_t c );
+
+/// validates indices, corrects orientation and builds the hierarchy; to be called after the mesh was assembled
+void mesh_s_prepare( mesh_s* o );
+
+/** Loads a wavefront (.obj), stanford (.ply; ascii or binary) or binary mesh (MESH_FILE_EXTENSION) file.
+ *  Text and stanford files are memory-mapped and parsed in place; polygons are triangulated as fans.
+ *  Binary mesh files are used in place (see mesh_s_save).
+ */
+void mesh_s_load( mesh_s* o, sc_t file );
+mesh_s* mesh_s_create_load( sc_t file );
+
+/**********************************************************************************************************************/
+/** Binary mesh format
+ *
+ *  A header followed by sections, each starting at a multiple of MESH_FILE_ALIGN bytes:
+ *    vertices (f2_t x3), triangles (u2_t x3), hierarchy nodes (bvh_node_s), node bounds (f3_t x6), slots (u2_t).
+ *  Data is stored in host byte order; the header identifies the byte order of the writing host.
+ *  Opening a binary mesh maps the file read-only: the mesh arrays reference the sections of the
+ *  mapping directly (weak arrays), so neither parsing nor copying takes place and pages are loaded
+ *  on demand. Each file is mapped once per process; reopening it (e.g. when a script rebuilds its scene
+ *  for each frame of an animation) reuses the mapping.
+ *  Primitive bounds are not stored, so the hierarchy of a mapped mesh cannot be refitted.
+ */
+
+#define MESH_FILE_EXTENSION ".amesh"
+#define MESH_FILE_ALIGN     4096
+
+/// writes a prepared mesh in binary format
+void mesh_s_save( const mesh_s* o, sc_t file );
+
+/// loads a mesh in any supported format and writes it in binary format
+void mesh_convert( sc_t src_file, sc_t dst_file );
+
+/// bounds of all vertices (empty box for an empty mesh)
+box_s mesh_s_get_box( const mesh_s* o );
+
+/// closest crossing at offset > 0 (not corrected by f3_eps) or f3_inf; p_nor: outward unit normal
+f3_t mesh_s_ray_hit( const mesh_s* o, const ray_s* r, v3d_s* p_nor );
+
+/** All crossings at offset > 0 in ascending order.
+ *  Coincident crossings of the same orientation (ray through a shared edge) are counted once.
+ *  nor (optional) receives the outward unit normals.
+ *  Returns false when more than max_size crossings exist.
+ */
+bl_t mesh_s_ray_crossings( const mesh_s* o, const ray_s* r, f3_t* offs, v3d_s* nor, uz_t max_size, uz_t* size );
+
+/// 1: outside; -1: inside
+s2_t mesh_s_side( const mesh_s* o, v3d_s pos );
+
+/**********************************************************************************************************************/
+
+vd_t mesh_signal_handler( const bcore_signal_s* o );
+
+#endif // MESH_H
+
@@ -22,21 +22,28 @@
 #include "bcore_spect_array.h"
 #include "bcore_trait.h"
 #include "bcore_threads.h"
+#include "bcore_file.h"
+#include "bcore_bin_ml.h"
 
 #include "textures.h"
 #include "objects.h"
 #include "gmath.h"
 #include "quicktypes.h"
 #include "distance.h"
+#include "mesh.h"
+#include "sphere_cloud.h"
 #include "container.h"
 
 /**********************************************************************************************************************/
-/// envelope_s  (sphere used to define object boundaries)
+/// envelope_s  (sphere or box used to define object boundaries)
 static sc_t envelope_s_def =
 "envelope_s = bcore_inst"
 "{"
     "v3d_s pos;"
     "f3_t radius;"
+    "bl_t box;"
+    "v3d_s ext;"
+    "m3d_s rax;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( envelope_s, envelope_s_def )
@@ -49,12 +56,31 @@ void envelope_s_move( envelope_s* o, const v3d_s* vec )
 void envelope_s_rotate( envelope_s* o, const m3d_s* mat )
 {
     o->pos = m3d_s_mlv( mat, o->pos );
+    if( o->box ) o->rax = m3d_s_mlm( mat, &o->rax );
 }
 
 void envelope_s_scale( envelope_s* o, f3_t fac )
 {
     v3d_s_o_mlf( &o->pos, fac );
     o->radius *= fac;
+    if( o->box ) v3d_s_o_mlf( &o->ext, fac );
+}
+
+void envelope_s_scale_axes( envelope_s* o, v3d_s scale )
+{
+    if( o->box )
+    {
+        box_s box = envelope_s_get_box( o );
+        v3d_s p1 = v3d_s_mld( box.min, scale );
+        v3d_s p2 = v3d_s_mld( box.max, scale );
+        box = box_s_union_pos( box_s_union_pos( box_s_empty(), p1 ), p2 );
+        *o = envelope_of_box( box );
+    }
+    else
+    {
+        o->pos = v3d_s_mld( o->pos, scale );
+        o->radius *= v3d_s_max( scale );
+    }
 }
 
 bl_t envelope_s_is_in_fov( const envelope_s* o, const ray_cone_s* fov )
@@ -87,31 +113,111 @@ ray_cone_s envelope_s_fov( const envelope_s* o, v3d_s pos )
     return cne;
 }
 
+/// slab test in the box's frame
+static inline bl_t envelope_s_box_span( const envelope_s* o, const ray_s* r, f3_t* t_near, f3_t* t_far )
+{
+    ray_s ray;
+    ray.p = m3d_s_mlv( &o->rax, v3d_s_sub( r->p, o->pos ) );
+    ray.d = m3d_s_mlv( &o->rax, r->d );
+    box_s box = { .min = v3d_s_neg( o->ext ), .max = o->ext };
+    return box_ray_span( &box, ray.p, ray_inv_dir( &ray ), t_near, t_far );
+}
+
 bl_t envelope_s_ray_hits( const envelope_s* o, const ray_s* r )
 {
+    if( o->box )
+    {
+        f3_t t_near, t_far;
+        return envelope_s_box_span( o, r, &t_near, &t_far ) && t_far >= 0;
+    }
     return sphere_ray_hit( o->pos, o->radius, r, NULL ) < f3_inf;
 }
 
 f3_t envelope_s_ray_hit( const envelope_s* o, const ray_s* r )
 {
+    if( o->box )
+    {
+        f3_t t_near, t_far;
+        if( !envelope_s_box_span( o, r, &t_near, &t_far ) ) return f3_inf;
+        if( t_near > 0 ) return t_near - f3_eps; // entry hit is positive
+        if( t_far  > 0 ) return t_far  - f3_eps; // exit hit is positive
+        return f3_inf;
+    }
     return sphere_ray_hit( o->pos, o->radius, r, NULL );
 }
 
 s3_t envelope_s_side( const envelope_s* o, v3d_s pos )
 {
+    if( o->box )
+    {
+        v3d_s p = m3d_s_mlv( &o->rax, v3d_s_sub( pos, o->pos ) );
+        return ( f3_abs( p.x ) > o->ext.x || f3_abs( p.y ) > o->ext.y || f3_abs( p.z ) > o->ext.z ) ? 1 : -1;
+    }
     return sphere_observer_side( o->pos, o->radius, pos );
 }
 
+f3_t envelope_s_area( const envelope_s* o )
+{
+    if( o->box ) return 8.0 * ( o->ext.x * o->ext.y + o->ext.y * o->ext.z + o->ext.z * o->ext.x );
+    return 4.0 * M_PI * f3_sqr( o->radius );
+}
+
+box_s envelope_s_get_box( const envelope_s* o )
+{
+    if( !o->box ) return box_s_of_sphere( o->pos, o->radius );
+
+    // world half-extents of the oriented box
+    const m3d_s* m = &o->rax;
+    v3d_s e;
+    e.x = f3_abs( m->x.x ) * o->ext.x + f3_abs( m->y.x ) * o->ext.y + f3_abs( m->z.x ) * o->ext.z;
+    e.y = f3_abs( m->x.y ) * o->ext.x + f3_abs( m->y.y ) * o->ext.y + f3_abs( m->z.y ) * o->ext.z;
+    e.z = f3_abs( m->x.z ) * o->ext.x + f3_abs( m->y.z ) * o->ext.y + f3_abs( m->z.z ) * o->ext.z;
+    return ( box_s ) { .min = v3d_s_sub( o->pos, e ), .max = v3d_s_add( o->pos, e ) };
+}
+
 envelope_s envelope_create( v3d_s pos, f3_t radius )
 {
     envelope_s env;
+    envelope_s_init( &env );
     env.pos = pos;
     env.radius = radius;
     return env;
 }
 
+envelope_s envelope_create_obb( v3d_s pos, v3d_s ext, const m3d_s* rax )
+{
+    envelope_s env;
+    envelope_s_init( &env );
+    env.pos = pos;
+    env.ext.x = f3_abs( ext.x );
+    env.ext.y = f3_abs( ext.y );
+    env.ext.z = f3_abs( ext.z );
+    env.rax = *rax;
+    env.radius = sqrt( v3d_s_sqr( env.ext ) );
+    env.box = true;
+    return env;
+}
+
+envelope_s envelope_of_box( box_s box )
+{
+    m3d_s rax = m3d_s_ident();
+    return envelope_create_obb( box_s_center( box ), v3d_s_mlf( v3d_s_sub( box.max, box.min ), 0.5 ), &rax );
+}
+
+envelope_s envelope_create_box( v3d_s min, v3d_s max )
+{
+    return envelope_of_box( box_s_union_pos( box_s_union_pos( box_s_empty(), min ), max ) );
+}
+
+/// returns the envelope with the smaller surface
+static inline envelope_s envelope_min_area( const envelope_s* env1, const envelope_s* env2 )
+{
+    return ( envelope_s_area( env2 ) < envelope_s_area( env1 ) ) ? *env2 : *env1;
+}
+
 envelope_s envelope_of_pair( const envelope_s* env1, const envelope_s* env2 )
 {
+    envelope_s sph;
     f3_t r1 = env1->radius;
     f3_t r2 = env2->radius;
     v3d_s diff = v3d_s_sub( env1->pos, env2->pos );
@@ -122,17 +228,30 @@ envelope_s envelope_of_pair( const envelope_s* env1, const envelope_s* env2 )
 
     if( rmin + d <= rmax ) // the smaller envelope is completely inside the bigger one
     {
-        return r1 > r2 ? *env1 : *env2;
+        sph = envelope_create( r1 > r2 ? env1->pos : env2->pos, rmax );
     }
     else
     {
         v3d_s p1 = v3d_s_add( env1->pos, v3d_s_of_length( diff, r1 ) );
         v3d_s p2 = v3d_s_sub( env2->pos, v3d_s_of_length( diff, r2 ) );
-        envelope_s env;
-        env.pos = v3d_s_mlf( v3d_s_add( p1, p2 ), 0.5 );
-        env.radius = ( r1 + r2 + d ) * 0.5;
-        return env;
+        sph = envelope_create( v3d_s_mlf( v3d_s_add( p1, p2 ), 0.5 ), ( r1 + r2 + d ) * 0.5 );
     }
+
+    envelope_s box = envelope_of_box( box_s_union( envelope_s_get_box( env1 ), envelope_s_get_box( env2 ) ) );
+
+    return envelope_min_area( &sph, &box );
+}
+
+envelope_s envelope_of_intersection( const envelope_s* env1, const envelope_s* env2 )
+{
+    envelope_s env = envelope_min_area( env1, env2 );
+    box_s box = box_s_intersection( envelope_s_get_box( env1 ), envelope_s_get_box( env2 ) );
+    if( !box_s_is_empty( box ) )
+    {
+        envelope_s env_box = envelope_of_box( box );
+        env = envelope_min_area( &env, &env_box );
+    }
+    return env;
 }
 
 /**********************************************************************************************************************/
@@ -201,6 +320,7 @@ void properties_s_scale( properties_s* o, f3_t fac )
 /// features
 typedef v2d_s      (*projection_fp   )( vc_t o, v3d_s pos );
 typedef f3_t       (*ray_hit_fp      )( vc_t o, const ray_s* ray, v3d_s* p_nor );
+typedef bl_t       (*ray_occluded_fp )( vc_t o, const ray_s* ray, f3_t max_dist );
 typedef s2_t       (*side_fp         )( vc_t o, v3d_s pos );
 typedef ray_cone_s (*fov_fp          )( vc_t o, v3d_s pos );
 typedef bl_t       (*is_in_fov_fp    )( vc_t o, const ray_cone_s* fov );
@@ -208,6 +328,8 @@ typedef bl_t       (*is_reachable_fp )( vc_t o, const ray_s* ray, f3_t length );
 typedef void       (*move_fp         )( vd_t o, const v3d_s* vec );
 typedef void       (*rotate_fp       )( vd_t o, const m3d_s* mat );
 typedef void       (*scale_fp        )( vd_t o, f3_t fac );
+typedef bl_t       (*bounds_fp       )( vc_t o, envelope_s* env );
+typedef bl_t       (*ray_spans_fp    )( vc_t o, const ray_s* ray, spans_s* spans );
 
 typedef struct spect_obj_s
 {
@@ -216,12 +338,15 @@ typedef struct spect_obj_s
     projection_fp   fp_projection;
     fov_fp          fp_fov;
     ray_hit_fp      fp_ray_hit;
+    ray_occluded_fp fp_ray_occluded;
     side_fp         fp_side;
     move_fp         fp_move;
     rotate_fp       fp_rotate;
     scale_fp        fp_scale;
     is_in_fov_fp    fp_is_in_fov;
     is_reachable_fp fp_is_reachable;
+    bounds_fp       fp_bounds;
+    ray_spans_fp    fp_ray_spans;
 } spect_obj_s;
 
 //static const tp_t spect_obj_s_parent_type_g = TYPEOF_bcore_inst;
@@ -232,12 +357,15 @@ static sc_t spect_obj_s_def = "spect_obj_s = spect"
     "       feature projection_fp   fp_projection   ~> func projection_fp   projection;"
     "       feature fov_fp          fp_fov          ~> func fov_fp          fov;"
     "strict feature ray_hit_fp      fp_ray_hit      ~> func ray_hit_fp      ray_hit;"
+    "       feature ray_occluded_fp fp_ray_occluded ~> func ray_occluded_fp ray_occluded;"
     "strict feature side_fp         fp_side         ~> func side_fp         side;"
     "strict feature move_fp         fp_move         ~> func move_fp         move;"
     "strict feature rotate_fp       fp_rotate       ~> func rotate_fp       rotate;"
     "strict feature scale_fp        fp_scale        ~> func scale_fp        scale;"
     "       feature is_in_fov_fp    fp_is_in_fov    ~> func is_in_fov_fp    is_in_fov;"
     "       feature is_reachable_fp fp_is_reachable ~> func is_reachable_fp is_reachable;"
+    "       feature bounds_fp       fp_bounds       ~> func bounds_fp       bounds;"
+    "       feature ray_spans_fp    fp_ray_spans    ~> func ray_spans_fp    ray_spans;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( spect_obj_s, spect_obj_s_def )
@@ -283,9 +411,47 @@ f3_t obj_ray_hit( vc_t o, const ray_s* ray, v3d_s* p_nor )
     return a;
 }
 
+bl_t obj_ray_occluded( vc_t o, const ray_s* ray, f3_t max_dist )
+{
+    const obj_hdr_s* hdr = o;
+    if( hdr->prp.envelope && !envelope_s_ray_hits( hdr->prp.envelope, ray ) ) return false;
+    if( hdr->p->fp_ray_occluded ) return hdr->p->fp_ray_occluded( o, ray, max_dist );
+    return hdr->p->fp_ray_hit( o, ray, NULL ) <= max_dist;
+}
+
 f3_t obj_ray_exit( vc_t o, const ray_s* ray, v3d_s* p_nor )
 {
+    // closed form: end of the last interval
+    spans_s spans;
+    if( obj_ray_spans( o, ray, &spans ) )
+    {
+        if( spans.size == 0 ) return f3_inf;
+        const span_s* span = &spans.data[ spans.size - 1 ];
+        if( span->a1 >= f3_inf ) return f3_inf;
+        if( p_nor ) *p_nor = span->n1;
+        return span->a1;
+    }
+
+    const obj_hdr_s* hdr = o;
     v3d_s nor;
+
+    // enveloped objects: the exit is the first hit of the reversed ray starting beyond the envelope
+    if( hdr->prp.envelope )
+    {
+        f3_t a_far = v3d_s_sub_mlv( hdr->prp.envelope->pos, ray->p, ray->d ) + hdr->prp.envelope->radius + f3_eps;
+        if( a_far <= 0 ) return f3_inf;
+        ray_s ray_l;
+        ray_l.p = ray_s_pos( ray, a_far );
+        ray_l.d = v3d_s_neg( ray->d );
+        f3_t a = obj_ray_hit( o, &ray_l, &nor );
+        if( a >= f3_inf ) return f3_inf;
+        a = a_far - ( a + f3_eps );
+        if( a <= 0 || v3d_s_mlv( nor, ray->d ) <= 0 ) return f3_inf;
+        if( p_nor ) *p_nor = nor;
+        return a;
+    }
+
+    // stepping through all surfaces
     f3_t a = obj_ray_hit( o, ray, &nor );
     if( a >= f3_inf ) return f3_inf;
     ray_s ray_l = *ray;
@@ -309,6 +475,131 @@ f3_t obj_ray_exit( vc_t o, const ray_s* ray, v3d_s* p_nor )
     }
 }
 
+bl_t obj_bounds( vc_t o, envelope_s* env )
+{
+    const obj_hdr_s* hdr = o;
+    envelope_s env_l;
+    bl_t bounded = hdr->p->fp_bounds && hdr->p->fp_bounds( o, &env_l );
+    if( hdr->prp.envelope )
+    {
+        *env = bounded ? envelope_min_area( &env_l, hdr->prp.envelope ) : *hdr->prp.envelope;
+        return true;
+    }
+    if( bounded ) *env = env_l;
+    return bounded;
+}
+
+bl_t obj_ray_spans( vc_t o, const ray_s* ray, spans_s* spans )
+{
+    const obj_hdr_s* hdr = o;
+    if( !hdr->p->fp_ray_spans ) return false;
+
+    // the envelope encloses the inside area (see obj_bounds)
+    if( hdr->prp.envelope && !envelope_s_ray_hits( hdr->prp.envelope, ray ) )
+    {
+        spans->size = 0;
+        return true;
+    }
+    return hdr->p->fp_ray_spans( o, ray, spans );
+}
+
+/// appends a span; returns false on overflow
+static inline bl_t spans_s_push( spans_s* o, f3_t a0, v3d_s n0, f3_t a1, v3d_s n1 )
+{
+    if( a1 <= 0 || a0 >= a1 ) return true; // nothing to add
+    if( o->size == SPANS_MAX ) return false;
+    span_s* span = &o->data[ o->size++ ];
+    span->a0 = a0;
+    span->a1 = a1;
+    span->n0 = n0;
+    span->n1 = n1;
+    return true;
+}
+
+/// r = a AND b (r must differ from a and b)
+static bl_t spans_s_intersect( const spans_s* a, const spans_s* b, spans_s* r )
+{
+    r->size = 0;
+    uz_t i = 0, j = 0;
+    while( i < a->size && j < b->size )
+    {
+        const span_s* sa = &a->data[ i ];
+        const span_s* sb = &b->data[ j ];
+        const span_s* s0 = ( sa->a0 > sb->a0 ) ? sa : sb; // later entry
+        const span_s* s1 = ( sa->a1 < sb->a1 ) ? sa : sb; // earlier exit
+        if( !spans_s_push( r, s0->a0, s0->n0, s1->a1, s1->n1 ) ) return false;
+        if( sa->a1 < sb->a1 ) i++; else j++;
+    }
+    return true;
+}
+
+/// r = a OR b (r must differ from a and b)
+static bl_t spans_s_unite( const spans_s* a, const spans_s* b, spans_s* r )
+{
+    r->size = 0;
+    uz_t i = 0, j = 0;
+    span_s cur;
+    bl_t active = false;
+    while( i < a->size || j < b->size )
+    {
+        const span_s* s = ( j == b->size || ( i < a->size && a->data[ i ].a0 < b->data[ j ].a0 ) ) ? &a->data[ i++ ] : &b->data[ j++ ];
+        if( active && s->a0 <= cur.a1 )
+        {
+            if( s->a1 > cur.a1 )
+            {
+                cur.a1 = s->a1;
+                cur.n1 = s->n1;
+            }
+        }
+        else
+        {
+            if( active && !spans_s_push( r, cur.a0, cur.n0, cur.a1, cur.n1 ) ) return false;
+            cur = *s;
+            active = true;
+        }
+    }
+    if( active && !spans_s_push( r, cur.a0, cur.n0, cur.a1, cur.n1 ) ) return false;
+    return true;
+}
+
+/// r = NOT a (r must differ from a); normals are inverted
+static bl_t spans_s_invert( const spans_s* a, spans_s* r )
+{
+    r->size = 0;
+    f3_t a0 = -f3_inf;
+    v3d_s n0 = v3d_s_zero();
+    for( uz_t i = 0; i < a->size; i++ )
+    {
+        const span_s* s = &a->data[ i ];
+        if( !spans_s_push( r, a0, n0, s->a0, v3d_s_neg( s->n0 ) ) ) return false;
+        a0 = s->a1;
+        n0 = v3d_s_neg( s->n1 );
+    }
+    return spans_s_push( r, a0, n0, f3_inf, v3d_s_zero() );
+}
+
+/// first surface offset > 0 (corrected by f3_eps as in ray_hit_fp) or f3_inf
+static f3_t spans_s_ray_hit( const spans_s* o, v3d_s* p_nor )
+{
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        const span_s* s = &o->data[ i ];
+        if( s->a0 > 0 )
+        {
+            if( s->a0 >= f3_inf ) return f3_inf;
+            if( p_nor ) *p_nor = s->n0;
+            return s->a0 - f3_eps;
+        }
+        if( s->a1 > 0 )
+        {
+            if( s->a1 >= f3_inf ) return f3_inf;
+            if( p_nor ) *p_nor = s->n1;
+            return s->a1 - f3_eps;
+        }
+    }
+    return f3_inf;
+}
+
 envelope_s obj_estimate_envelope( vc_t o, uz_t samples, u2_t rseed, f3_t radius_factor )
 {
     const obj_hdr_s* hdr = o;
@@ -340,21 +631,37 @@ envelope_s obj_estimate_envelope( vc_t o, uz_t samples, u2_t rseed, f3_t radius_
         }
     }
 
-    envelope_s env;
-    env.pos = ray.p;
-    env.radius = f3_mag;
+    envelope_s env = envelope_create( ray.p, f3_mag );
 
     if( pos_arr->size > 0 )
     {
+        // candidates: sphere, box aligned to world axes, box aligned to the object's reference axes
         f3_t max_r2 = 0;
+        box_s box_w = box_s_empty();
+        box_s box_l = box_s_empty();
         for( uz_t i = 0; i < pos_arr->size; i++ )
         {
             v3d_s pos = pos_arr->data[ i ];
             f3_t r = v3d_s_diff_sqr( ray.p, pos );
             max_r2 = r > max_r2 ? r : max_r2;
+            box_w = box_s_union_pos( box_w, pos );
+            box_l = box_s_union_pos( box_l, m3d_s_mlv( &hdr->prp.rax, pos ) );
         }
 
         env.radius = sqrt( max_r2 ) * radius_factor;
+
+        v3d_s ext_w = v3d_s_mlf( v3d_s_sub( box_w.max, box_w.min ), 0.5 * radius_factor );
+        v3d_s ext_l = v3d_s_mlf( v3d_s_sub( box_l.max, box_l.min ), 0.5 * radius_factor );
+        v3d_s_o_add( &ext_w, ( v3d_s ){ 2 * f3_eps, 2 * f3_eps, 2 * f3_eps } );
+        v3d_s_o_add( &ext_l, ( v3d_s ){ 2 * f3_eps, 2 * f3_eps, 2 * f3_eps } );
+
+        m3d_s rax_w = m3d_s_ident();
+        envelope_s env_w = envelope_create_obb( box_s_center( box_w ), ext_w, &rax_w );
+        envelope_s env_l = envelope_create_obb( m3d_s_tmlv( &hdr->prp.rax, box_s_center( box_l ) ), ext_l, &hdr->prp.rax );
+
+        // the envelope with the smallest surface is taken
+        if( envelope_s_area( &env_w ) < envelope_s_area( &env ) ) env = env_w;
+        if( envelope_s_area( &env_l ) < envelope_s_area( &env ) ) env = env_l;
     }
 
     bcore_inst_t_discard( pos_arr_type, pos_arr );
@@ -467,12 +774,23 @@ void obj_set_envelope( vd_t obj, const envelope_s* env )
     o->prp.envelope = envelope_s_clone( env );
 }
 
+bl_t obj_auto_envelope( vc_t obj, envelope_s* env )
+{
+    const obj_hdr_s* o = obj;
+    if( o->p->fp_bounds && o->p->fp_bounds( obj, env ) ) return true;
+
+    // no analytic bounds: sampling; no exit point found (radius f3_mag) means unbounded
+    *env = obj_estimate_envelope( obj, 1000, 123, 1.1 );
+    return env->radius < f3_mag;
+}
+
 void obj_set_auto_envelope( vd_t obj )
 {
-    envelope_s env = obj_estimate_envelope( obj, 1000, 123, 1.1 );
     obj_hdr_s* o = obj;
+    envelope_s env;
+    bl_t bounded = obj_auto_envelope( obj, &env );
     if( o->prp.envelope ) envelope_s_discard( o->prp.envelope );
-    o->prp.envelope = envelope_s_clone( &env );
+    o->prp.envelope = bounded ? envelope_s_clone( &env ) : NULL;
 }
 
 /**********************************************************************************************************************/
@@ -504,6 +822,7 @@ static sc_t obj_plane_s_def =
     "func ray_hit_fp    ray_hit    = obj_plane_s_ray_hit;"
     "func side_fp       side       = obj_plane_s_side;"
     "func is_in_fov_fp  is_in_fov  = obj_plane_s_is_in_fov;"
+    "func ray_spans_fp  ray_spans  = obj_plane_s_ray_spans;"
     "func move_fp       move       = obj_plane_s_move;"
     "func rotate_fp     rotate     = obj_plane_s_rotate;"
     "func scale_fp      scale      = obj_plane_s_scale;"
@@ -546,14 +865,36 @@ bl_t obj_plane_s_is_in_fov( const obj_plane_s* o, const ray_cone_s* fov )
     return cos_a > fov->cos_rs;
 }
 
+bl_t obj_plane_s_ray_spans( const obj_plane_s* o, const ray_s* r, spans_s* spans )
+{
+    v3d_s nor = o->prp.rax.z;
+    f3_t div  = v3d_s_mlv( nor, r->d );
+    f3_t dist = v3d_s_sub_mlv( o->prp.pos, r->p, nor ); // > 0: ray origin inside
+    spans->size = 0;
+    if( div == 0 ) return ( dist >= 0 ) ? spans_s_push( spans, -f3_inf, nor, f3_inf, nor ) : true;
+    f3_t a = dist / div;
+    return ( div > 0 ) ? spans_s_push( spans, -f3_inf, nor, a, nor ) : spans_s_push( spans, a, nor, f3_inf, nor );
+}
+
 void obj_plane_s_move(   obj_plane_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
 void obj_plane_s_rotate( obj_plane_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
 void obj_plane_s_scale(  obj_plane_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); }
 
 /**********************************************************************************************************************/
-/// obj_sphere_s
+/** obj_polyhedron_s
+ *  Convex polyhedron: intersection of half-spaces { x | nor * x <= offs } in world coordinates.
+ *  A ray is clipped against all planes in a single pass (replaces chains of obj_pair_inside_s over planes).
+ */
 
-typedef struct obj_sphere_s
+typedef struct half_space_s
+{
+    v3d_s nor; // outward normal (unit length)
+    f3_t offs; // nor * x for points x on the boundary plane
+} half_space_s;
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( half_space_s, "half_space_s = bcore_inst { v3d_s nor; f3_t offs; }" )
+
+typedef struct obj_polyhedron_s
 {
     union
     {
@@ -565,105 +906,416 @@ typedef struct obj_sphere_s
             properties_s prp;
         };
     };
-    f3_t  radius;
-} obj_sphere_s;
 
-static sc_t obj_sphere_s_def =
-"obj_sphere_s = spect_obj"
+    union
+    {
+        bcore_array_dyn_solid_static_s arr;
+        struct
+        {
+            half_space_s* data;
+            uz_t size, space;
+        };
+    };
+} obj_polyhedron_s;
+
+static sc_t obj_polyhedron_s_def =
+"obj_polyhedron_s = spect_obj"
 "{"
     "aware_t _;"
     "spect spect_obj_s -> p;"
     "properties_s prp;"
-    "f3_t radius = 1.0;"
-
-    "func projection_fp   projection      = obj_sphere_s_projection;"
-    "func fov_fp          fov             = obj_sphere_s_fov;"
-    "func ray_hit_fp      ray_hit         = obj_sphere_s_ray_hit;"
-    "func side_fp         side            = obj_sphere_s_side;"
-    "func is_in_fov_fp    is_in_fov       = obj_sphere_s_is_in_fov;"
-    "func is_reachable_fp is_reachable    = obj_sphere_s_is_reachable;"
-    "func move_fp         move            = obj_sphere_s_move;"
-    "func rotate_fp       rotate          = obj_sphere_s_rotate;"
-    "func scale_fp        scale           = obj_sphere_s_scale;"
+    "half_space_s [] arr;"
+
+    "func fov_fp          fov             = obj_polyhedron_s_fov;"
+    "func ray_hit_fp      ray_hit         = obj_polyhedron_s_ray_hit;"
+    "func side_fp         side            = obj_polyhedron_s_side;"
+    "func ray_spans_fp    ray_spans       = obj_polyhedron_s_ray_spans;"
+    "func move_fp         move            = obj_polyhedron_s_move;"
+    "func rotate_fp       rotate          = obj_polyhedron_s_rotate;"
+    "func scale_fp        scale           = obj_polyhedron_s_scale;"
+    "func bounds_fp       bounds          = obj_polyhedron_s_bounds;"
 "}";
 
-BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_sphere_s, obj_sphere_s_def )
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_polyhedron_s, obj_polyhedron_s_def )
 
-void obj_sphere_s_set_radius( obj_sphere_s* o, f3_t radius )
+static void obj_polyhedron_s_push_half_space( obj_polyhedron_s* o, half_space_s hsp )
 {
-    o->radius = radius;
+    bcore_array_a_set_size( (bcore_array*)o, o->size + 1 );
+    o->data[ o->size - 1 ] = hsp;
 }
 
-f3_t obj_sphere_s_get_radius( const obj_sphere_s* o )
+void obj_polyhedron_s_push_plane( obj_polyhedron_s* o, v3d_s pos, v3d_s nor )
 {
-    return o->radius;
+    half_space_s hsp;
+    hsp.nor  = v3d_s_of_length( nor, 1.0 );
+    hsp.offs = v3d_s_mlv( hsp.nor, pos );
+    obj_polyhedron_s_push_half_space( o, hsp );
 }
 
-v2d_s obj_sphere_s_projection( const obj_sphere_s* o, v3d_s pos )
+bl_t obj_polyhedron_s_is_mergeable( vc_t o )
 {
-    v3d_s r = v3d_s_of_length( v3d_s_sub( pos, o->prp.pos ), 1.0 );
-    f3_t x = v3d_s_mlv( r, o->prp.rax.x );
-    f3_t y = v3d_s_mlv( r, v3d_s_mlx( o->prp.rax.z, o->prp.rax.x ) );
-    f3_t z = v3d_s_mlv( r, o->prp.rax.z );
-
-    f3_t azimuth = atan2( x, y );
+    tp_t type = *( aware_t* )o;
+    if( type != TYPEOF_obj_plane_s && type != TYPEOF_obj_polyhedron_s ) return false;
+    return ( ( const obj_hdr_s* )o )->prp.envelope == NULL;
+}
 
-    /// correct rounding errors
-    z = z >  1.0 ?  1.0 : z;
-    z = z < -1.0 ? -1.0 : z;
-    f3_t elevation = asin( z );
+/// appends all half-spaces of a mergeable object
+static void obj_polyhedron_s_merge( obj_polyhedron_s* o, vc_t obj )
+{
+    if( *( aware_t* )obj == TYPEOF_obj_plane_s )
+    {
+        const obj_hdr_s* plane = obj;
+        obj_polyhedron_s_push_plane( o, plane->prp.pos, plane->prp.rax.z );
+    }
+    else
+    {
+        const obj_polyhedron_s* poly = obj;
+        for( uz_t i = 0; i < poly->size; i++ ) obj_polyhedron_s_push_half_space( o, poly->data[ i ] );
+    }
+}
 
-    return ( v2d_s ) { azimuth, elevation };
+obj_polyhedron_s* obj_polyhedron_s_create_pair( vc_t o1, vc_t o2 )
+{
+    ASSERT( obj_polyhedron_s_is_mergeable( o1 ) && obj_polyhedron_s_is_mergeable( o2 ) );
+    obj_polyhedron_s* o = obj_polyhedron_s_create();
+    properties_s_copy( &o->prp, &( ( obj_hdr_s* )o1 )->prp );
+    obj_polyhedron_s_merge( o, o1 );
+    obj_polyhedron_s_merge( o, o2 );
+    return o;
 }
 
-ray_cone_s obj_sphere_s_fov( const obj_sphere_s* o, v3d_s pos )
+ray_cone_s obj_polyhedron_s_fov( const obj_polyhedron_s* o, v3d_s pos )
 {
+    if( o->prp.envelope ) return envelope_s_fov( o->prp.envelope, pos );
     ray_cone_s cne;
     v3d_s diff = v3d_s_sub( o->prp.pos, pos );
     cne.ray.d = v3d_s_of_length( diff, 1.0 );
     cne.ray.p = pos;
-    f3_t diff_sqr = v3d_s_sqr( diff );
-    f3_t radius_sqr = f3_sqr( o->radius );
+    cne.cos_rs = 0;
+    return cne;
+}
 
-    if( diff_sqr > radius_sqr )
+f3_t obj_polyhedron_s_ray_hit( const obj_polyhedron_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    f3_t a_enter = -f3_inf;
+    f3_t a_exit  =  f3_inf;
+    const half_space_s* hsp_enter = NULL;
+    const half_space_s* hsp_exit  = NULL;
+
+    for( uz_t i = 0; i < o->size; i++ )
     {
-        cne.cos_rs = sqrt( 1.0 - ( radius_sqr / diff_sqr ) );
+        const half_space_s* hsp = &o->data[ i ];
+        f3_t div  = v3d_s_mlv( hsp->nor, r->d );
+        f3_t dist = hsp->offs - v3d_s_mlv( hsp->nor, r->p ); // > 0: ray origin inside half-space
+        if( div == 0 )
+        {
+            if( dist < 0 ) return f3_inf; // parallel and outside
+            continue;
+        }
+
+        f3_t a = dist / div;
+        if( div < 0 )
+        {
+            if( a > a_enter ) { a_enter = a; hsp_enter = hsp; }
+        }
+        else
+        {
+            if( a < a_exit  ) { a_exit  = a; hsp_exit  = hsp; }
+        }
+        if( a_enter > a_exit ) return f3_inf;
     }
-    else
+
+    const half_space_s* hsp = NULL;
+    f3_t a = f3_inf;
+    if( a_enter > 0 )
     {
-        cne.cos_rs = -1;
+        a = a_enter;
+        hsp = hsp_enter;
     }
-    return cne;
+    else if( a_exit > 0 && hsp_exit )
+    {
+        a = a_exit;
+        hsp = hsp_exit;
+    }
+
+    if( !hsp ) return f3_inf;
+    if( p_nor ) *p_nor = hsp->nor;
+    return a - f3_eps;
 }
 
-bl_t obj_sphere_s_is_in_fov( const obj_sphere_s* o, const ray_cone_s* fov )
+bl_t obj_polyhedron_s_ray_spans( const obj_polyhedron_s* o, const ray_s* r, spans_s* spans )
 {
-    return sphere_is_in_fov( o->prp.pos, o->radius, fov );
+    f3_t a_enter = -f3_inf;
+    f3_t a_exit  =  f3_inf;
+    v3d_s n_enter = v3d_s_zero();
+    v3d_s n_exit  = v3d_s_zero();
+    spans->size = 0;
+
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        const half_space_s* hsp = &o->data[ i ];
+        f3_t div  = v3d_s_mlv( hsp->nor, r->d );
+        f3_t dist = hsp->offs - v3d_s_mlv( hsp->nor, r->p );
+        if( div == 0 )
+        {
+            if( dist < 0 ) return true;
+            continue;
+        }
+
+        f3_t a = dist / div;
+        if( div < 0 )
+        {
+            if( a > a_enter ) { a_enter = a; n_enter = hsp->nor; }
+        }
+        else
+        {
+            if( a < a_exit  ) { a_exit  = a; n_exit  = hsp->nor; }
+        }
+        if( a_enter >= a_exit ) return true;
+    }
+
+    return spans_s_push( spans, a_enter, n_enter, a_exit, n_exit );
 }
 
-bl_t obj_sphere_s_is_reachable( const obj_sphere_s* o, const ray_s* ray_field, f3_t length )
+s2_t obj_polyhedron_s_side( const obj_polyhedron_s* o, v3d_s pos )
 {
-    return sphere_intersects_half_sphere( o->prp.pos, o->radius, ray_field, length );
+    for( uz_t i = 0; i < o->size; i++ )
+    {
+        if( v3d_s_mlv( o->data[ i ].nor, pos ) > o->data[ i ].offs ) return 1;
+    }
+    return -1;
 }
 
-f3_t obj_sphere_s_ray_hit( const obj_sphere_s* o, const ray_s* r, v3d_s* p_nor )
+/** Bounds are the axis aligned box of all vertices (intersections of plane triples inside all half-spaces).
+ *  The polyhedron is unbounded when a direction d exists with nor * d <= 0 for all planes;
+ *  such a direction is a (+/-) cross product of two normals.
+ */
+bl_t obj_polyhedron_s_bounds( const obj_polyhedron_s* o, envelope_s* env )
 {
-    return sphere_ray_hit( o->prp.pos, o->radius, r, p_nor );
+    const half_space_s* hsp = o->data;
+    uz_t size = o->size;
+
+    for( uz_t i = 0; i < size; i++ )
+    {
+        for( uz_t j = i + 1; j < size; j++ )
+        {
+            v3d_s d = v3d_s_mlx( hsp[ i ].nor, hsp[ j ].nor );
+            if( v3d_s_sqr( d ) < f3_sqr( f3_eps ) ) continue;
+            d = v3d_s_of_length( d, 1.0 );
+            bl_t pos_open = true;
+            bl_t neg_open = true;
+            for( uz_t k = 0; k < size && ( pos_open || neg_open ); k++ )
+            {
+                f3_t f = v3d_s_mlv( hsp[ k ].nor, d );
+                if( f >  f3_eps ) pos_open = false;
+                if( f < -f3_eps ) neg_open = false;
+            }
+            if( pos_open || neg_open ) return false;
+        }
+    }
+
+    box_s box = box_s_empty();
+    bl_t has_vertex = false;
+    for( uz_t i = 0; i < size; i++ )
+    {
+        for( uz_t j = i + 1; j < size; j++ )
+        {
+            v3d_s n1xn2 = v3d_s_mlx( hsp[ i ].nor, hsp[ j ].nor );
+            for( uz_t k = j + 1; k < size; k++ )
+            {
+                v3d_s n1 = hsp[ i ].nor, n2 = hsp[ j ].nor, n3 = hsp[ k ].nor;
+                f3_t det = v3d_s_mlv( n1xn2, n3 );
+                if( f3_abs( det ) < f3_eps ) continue;
+
+                // Cramer's rule: x = ( d1 * ( n2 x n3 ) + d2 * ( n3 x n1 ) + d3 * ( n1 x n2 ) ) / det
+                v3d_s x = v3d_s_mlf( v3d_s_mlx( n2, n3 ), hsp[ i ].offs );
+                x = v3d_s_add( x, v3d_s_mlf( v3d_s_mlx( n3, n1 ), hsp[ j ].offs ) );
+                x = v3d_s_add( x, v3d_s_mlf( n1xn2, hsp[ k ].offs ) );
+                x = v3d_s_mlf( x, 1.0 / det );
+
+                bl_t inside = true;
+                for( uz_t l = 0; l < size && inside; l++ ) inside = v3d_s_mlv( hsp[ l ].nor, x ) <= hsp[ l ].offs + f3_eps;
+                if( inside )
+                {
+                    box = box_s_union_pos( box, x );
+                    has_vertex = true;
+                }
+            }
+        }
+    }
+
+    if( !has_vertex ) return false;
+
+    v3d_s pad = { 2 * f3_eps, 2 * f3_eps, 2 * f3_eps };
+    box.min = v3d_s_sub( box.min, pad );
+    box.max = v3d_s_add( box.max, pad );
+
+    envelope_s env_box = envelope_of_box( box );
+    envelope_s env_sph = envelope_create( box_s_center( box ), 0.5 * sqrt( v3d_s_sqr( v3d_s_sub( box.max, box.min ) ) ) );
+    *env = envelope_min_area( &env_sph, &env_box );
+    return true;
 }
 
-s2_t obj_sphere_s_side( const obj_sphere_s* o, v3d_s pos )
+void obj_polyhedron_s_move( obj_polyhedron_s* o, const v3d_s* vec )
 {
-    return sphere_observer_side( o->prp.pos, o->radius, pos );
+    properties_s_move( &o->prp, vec );
+    for( uz_t i = 0; i < o->size; i++ ) o->data[ i ].offs += v3d_s_mlv( o->data[ i ].nor, *vec );
 }
 
-void obj_sphere_s_move(   obj_sphere_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
-void obj_sphere_s_rotate( obj_sphere_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
-void obj_sphere_s_scale(  obj_sphere_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->radius *= fac; }
+void obj_polyhedron_s_rotate( obj_polyhedron_s* o, const m3d_s* mat )
+{
+    properties_s_rotate( &o->prp, mat );
+    for( uz_t i = 0; i < o->size; i++ ) o->data[ i ].nor = m3d_s_mlv( mat, o->data[ i ].nor );
+}
+
+void obj_polyhedron_s_scale( obj_polyhedron_s* o, f3_t fac )
+{
+    properties_s_scale( &o->prp, fac );
+    for( uz_t i = 0; i < o->size; i++ ) o->data[ i ].offs *= fac;
+}
 
 /**********************************************************************************************************************/
-/** obj_squaroid_s
+/// obj_sphere_s
+
+typedef struct obj_sphere_s
+{
+    union
+    {
+        obj_hdr_s hdr;
+        struct
+        {
+            aware_t _;
+            const spect_obj_s* p;
+            properties_s prp;
+        };
+    };
+    f3_t  radius;
+} obj_sphere_s;
+
+static sc_t obj_sphere_s_def =
+"obj_sphere_s = spect_obj"
+"{"
+    "aware_t _;"
+    "spect spect_obj_s -> p;"
+    "properties_s prp;"
+    "f3_t radius = 1.0;"
+
+    "func projection_fp   projection      = obj_sphere_s_projection;"
+    "func fov_fp          fov             = obj_sphere_s_fov;"
+    "func ray_hit_fp      ray_hit         = obj_sphere_s_ray_hit;"
+    "func side_fp         side            = obj_sphere_s_side;"
+    "func is_in_fov_fp    is_in_fov       = obj_sphere_s_is_in_fov;"
+    "func is_reachable_fp is_reachable    = obj_sphere_s_is_reachable;"
+    "func move_fp         move            = obj_sphere_s_move;"
+    "func rotate_fp       rotate          = obj_sphere_s_rotate;"
+    "func scale_fp        scale           = obj_sphere_s_scale;"
+    "func bounds_fp       bounds          = obj_sphere_s_bounds;"
+    "func ray_spans_fp    ray_spans       = obj_sphere_s_ray_spans;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_sphere_s, obj_sphere_s_def )
+
+void obj_sphere_s_set_radius( obj_sphere_s* o, f3_t radius )
+{
+    o->radius = radius;
+}
+
+f3_t obj_sphere_s_get_radius( const obj_sphere_s* o )
+{
+    return o->radius;
+}
+
+v2d_s obj_sphere_s_projection( const obj_sphere_s* o, v3d_s pos )
+{
+    v3d_s r = v3d_s_of_length( v3d_s_sub( pos, o->prp.pos ), 1.0 );
+    f3_t x = v3d_s_mlv( r, o->prp.rax.x );
+    f3_t y = v3d_s_mlv( r, v3d_s_mlx( o->prp.rax.z, o->prp.rax.x ) );
+    f3_t z = v3d_s_mlv( r, o->prp.rax.z );
+
+    f3_t azimuth = atan2( x, y );
+
+    /// correct rounding errors
+    z = z >  1.0 ?  1.0 : z;
+    z = z < -1.0 ? -1.0 : z;
+    f3_t elevation = asin( z );
+
+    return ( v2d_s ) { azimuth, elevation };
+}
+
+ray_cone_s obj_sphere_s_fov( const obj_sphere_s* o, v3d_s pos )
+{
+    ray_cone_s cne;
+    v3d_s diff = v3d_s_sub( o->prp.pos, pos );
+    cne.ray.d = v3d_s_of_length( diff, 1.0 );
+    cne.ray.p = pos;
+    f3_t diff_sqr = v3d_s_sqr( diff );
+    f3_t radius_sqr = f3_sqr( o->radius );
+
+    if( diff_sqr > radius_sqr )
+    {
+        cne.cos_rs = sqrt( 1.0 - ( radius_sqr / diff_sqr ) );
+    }
+    else
+    {
+        cne.cos_rs = -1;
+    }
+    return cne;
+}
+
+bl_t obj_sphere_s_is_in_fov( const obj_sphere_s* o, const ray_cone_s* fov )
+{
+    return sphere_is_in_fov( o->prp.pos, o->radius, fov );
+}
+
+bl_t obj_sphere_s_is_reachable( const obj_sphere_s* o, const ray_s* ray_field, f3_t length )
+{
+    return sphere_intersects_half_sphere( o->prp.pos, o->radius, ray_field, length );
+}
+
+f3_t obj_sphere_s_ray_hit( const obj_sphere_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    return sphere_ray_hit( o->prp.pos, o->radius, r, p_nor );
+}
+
+bl_t obj_sphere_s_ray_spans( const obj_sphere_s* o, const ray_s* r, spans_s* spans )
+{
+    v3d_s p = v3d_s_sub( r->p, o->prp.pos );
+    f3_t s = v3d_s_mlv( p, r->d );
+    f3_t q = v3d_s_sqr( p ) - f3_sqr( o->radius );
+    spans->size = 0;
+    if( s * s <= q ) return true;
+    f3_t w = sqrt( s * s - q );
+    f3_t a0 = -s - w;
+    f3_t a1 = -s + w;
+    if( a1 <= 0 ) return true;
+    v3d_s n0 = v3d_s_of_length( v3d_s_add( p, v3d_s_mlf( r->d, a0 ) ), 1.0 );
+    v3d_s n1 = v3d_s_of_length( v3d_s_add( p, v3d_s_mlf( r->d, a1 ) ), 1.0 );
+    return spans_s_push( spans, a0, n0, a1, n1 );
+}
+
+s2_t obj_sphere_s_side( const obj_sphere_s* o, v3d_s pos )
+{
+    return sphere_observer_side( o->prp.pos, o->radius, pos );
+}
+
+bl_t obj_sphere_s_bounds( const obj_sphere_s* o, envelope_s* env )
+{
+    *env = envelope_create( o->prp.pos, f3_abs( o->radius ) + 2 * f3_eps );
+    return true;
+}
+
+void obj_sphere_s_move(   obj_sphere_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
+void obj_sphere_s_rotate( obj_sphere_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
+void obj_sphere_s_scale(  obj_sphere_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->radius *= fac; }
+
+/**********************************************************************************************************************/
+/** obj_squaroid_s
  *  A surface with distance function a*x^2 + b*y^2 + c*z^2 + r = 0;
  *  Many basic surfaces like sphere, ellipsoid, hyperboloid, cone, plane, etc are special cases of the squaroid
+ *
+ *  Clipping (optional) restricts the surface to the local z-range z0 ... z1.
+ *  With caps the clipped inside area is closed by planar caps at z0 and z1 (finite cylinder, cone, ...);
+ *  without caps the remaining surface is open and has no well defined inside area (no ray spans).
  */
 
 typedef struct obj_squaroid_s
@@ -680,6 +1332,16 @@ typedef struct obj_squaroid_s
     };
 
     f3_t a, b, c, r;
+
+    /** Cached quadric matrix in world orientation: q = rax^T * diag( a, b, c ) * rax (symmetric)
+     *  Surface: ( x - pos )^T * q * ( x - pos ) + r = 0
+     *  Updated by obj_squaroid_s_update_quadric whenever parameters or properties change.
+     */
+    f3_t qxx, qyy, qzz, qxy, qxz, qyz;
+
+    bl_t clip;   // restricts surface to local z-range z0 ... z1
+    f3_t z0, z1;
+    bl_t caps;   // closes clipped surface at z0 and z1
 } obj_squaroid_s;
 
 static sc_t obj_squaroid_s_def =
@@ -692,22 +1354,73 @@ static sc_t obj_squaroid_s_def =
     "f3_t b =  1.0;"
     "f3_t c =  1.0;"
     "f3_t r = -1.0;"
-
+    "f3_t qxx;"
+    "f3_t qyy;"
+    "f3_t qzz;"
+    "f3_t qxy;"
+    "f3_t qxz;"
+    "f3_t qyz;"
+    "bl_t clip = false;"
+    "f3_t z0;"
+    "f3_t z1;"
+    "bl_t caps = true;"
+
+    "func ap_t            init            = obj_squaroid_s_init_a;"
     "func ray_hit_fp      ray_hit         = obj_squaroid_s_ray_hit;"
     "func side_fp         side            = obj_squaroid_s_side;"
     "func move_fp         move            = obj_squaroid_s_move;"
     "func rotate_fp       rotate          = obj_squaroid_s_rotate;"
     "func scale_fp        scale           = obj_squaroid_s_scale;"
+    "func bounds_fp       bounds          = obj_squaroid_s_bounds;"
+    "func ray_spans_fp    ray_spans       = obj_squaroid_s_ray_spans;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_squaroid_s, obj_squaroid_s_def )
 
+static void obj_squaroid_s_update_quadric( obj_squaroid_s* o )
+{
+    const m3d_s* m = &o->prp.rax;
+    o->qxx = o->a * m->x.x * m->x.x + o->b * m->y.x * m->y.x + o->c * m->z.x * m->z.x;
+    o->qyy = o->a * m->x.y * m->x.y + o->b * m->y.y * m->y.y + o->c * m->z.y * m->z.y;
+    o->qzz = o->a * m->x.z * m->x.z + o->b * m->y.z * m->y.z + o->c * m->z.z * m->z.z;
+    o->qxy = o->a * m->x.x * m->x.y + o->b * m->y.x * m->y.y + o->c * m->z.x * m->z.y;
+    o->qxz = o->a * m->x.x * m->x.z + o->b * m->y.x * m->y.z + o->c * m->z.x * m->z.z;
+    o->qyz = o->a * m->x.y * m->x.z + o->b * m->y.y * m->y.z + o->c * m->z.y * m->z.z;
+}
+
+/// q * v
+static inline v3d_s obj_squaroid_s_qmlv( const obj_squaroid_s* o, v3d_s v )
+{
+    return ( v3d_s )
+    {
+        o->qxx * v.x + o->qxy * v.y + o->qxz * v.z,
+        o->qxy * v.x + o->qyy * v.y + o->qyz * v.z,
+        o->qxz * v.x + o->qyz * v.y + o->qzz * v.z
+    };
+}
+
+static void obj_squaroid_s_init_a( vd_t nc )
+{
+    struct { ap_t a; vc_t p; obj_squaroid_s* o; } * nc_l = nc;
+    nc_l->a( nc ); // default
+    obj_squaroid_s_update_quadric( nc_l->o );
+}
+
 void obj_squaroid_s_set_param( obj_squaroid_s* o, f3_t a, f3_t b, f3_t c, f3_t r )
 {
     o->a = a;
     o->b = b;
     o->c = c;
     o->r = r;
+    obj_squaroid_s_update_quadric( o );
+}
+
+void obj_squaroid_s_set_clip( obj_squaroid_s* o, f3_t z0, f3_t z1, bl_t caps )
+{
+    o->clip = true;
+    o->z0   = z0 < z1 ? z0 : z1;
+    o->z1   = z0 < z1 ? z1 : z0;
+    o->caps = caps;
 }
 
 obj_squaroid_s* obj_squaroid_s_create_squaroid( f3_t a, f3_t b, f3_t c, f3_t r )
@@ -717,6 +1430,7 @@ obj_squaroid_s* obj_squaroid_s_create_squaroid( f3_t a, f3_t b, f3_t c, f3_t r )
     o->b = b;
     o->c = c;
     o->r = r;
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
@@ -732,6 +1446,7 @@ obj_squaroid_s* obj_squaroid_s_create_ellipsoid( f3_t rx, f3_t ry, f3_t rz )
     // TODO remove commented out code (envelope should not be used here because it impairs proper inversion)
     // envelope_s env = envelope_create( v3d_s_zero(), rmax + 2 * f3_eps );
     // obj_set_envelope( o, &env );
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
@@ -742,6 +1457,7 @@ obj_squaroid_s* obj_squaroid_s_create_hyperboloid1( f3_t rx, f3_t ry, f3_t rz )
     o->b =    ( ry != 0 ) ? 1.0 / f3_sqr( ry ) : 1.0;
     o->c = -( ( rz != 0 ) ? 1.0 / f3_sqr( rz ) : 1.0 );
     o->r = -1;
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
@@ -752,6 +1468,7 @@ obj_squaroid_s* obj_squaroid_s_create_hyperboloid2( f3_t rx, f3_t ry, f3_t rz )
     o->b =    ( ry != 0 ) ? 1.0 / f3_sqr( ry ) : 1.0;
     o->c = -( ( rz != 0 ) ? 1.0 / f3_sqr( rz ) : 1.0 );
     o->r =  1;
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
@@ -762,6 +1479,7 @@ obj_squaroid_s* obj_squaroid_s_create_cone( f3_t rx, f3_t ry, f3_t rz )
     o->b =    ( ry != 0 ) ? 1.0 / f3_sqr( ry ) : 1.0;
     o->c = -( ( rz != 0 ) ? 1.0 / f3_sqr( rz ) : 1.0 );
     o->r = 0;
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
@@ -772,63 +1490,772 @@ obj_squaroid_s* obj_squaroid_s_create_cylinder( f3_t rx, f3_t ry )
     o->b =    ( ry != 0 ) ? 1.0 / f3_sqr( ry ) : 1.0;
     o->c =  0;
     o->r = -1;
+    obj_squaroid_s_update_quadric( o );
     return o;
 }
 
+/** The inside area is where the quadric is negative:
+ *  f > 0: between both roots; f < 0: outside the roots (or everywhere without roots); f = 0: one side of a single root
+ */
+static bl_t obj_squaroid_s_quadric_spans( const obj_squaroid_s* o, const ray_s* r, spans_s* spans )
+{
+    v3d_s p  = v3d_s_sub( r->p, o->prp.pos );
+    v3d_s d  = r->d;
+    v3d_s qp = obj_squaroid_s_qmlv( o, p );
+    v3d_s qd = obj_squaroid_s_qmlv( o, d );
+
+    f3_t f  = v3d_s_mlv( d, qd );
+    f3_t fs = v3d_s_mlv( d, qp );
+    f3_t fq = v3d_s_mlv( p, qp ) + o->r;
+
+    v3d_s n_inf = v3d_s_zero(); // normal at unbounded ends (never used as surface)
+    spans->size = 0;
+
+    if( f == 0 )
+    {
+        if( fs == 0 ) return ( fq < 0 ) ? spans_s_push( spans, -f3_inf, n_inf, f3_inf, n_inf ) : true;
+        f3_t a = -fq / ( 2 * fs );
+        v3d_s n = v3d_s_of_length( v3d_s_add( qp, v3d_s_mlf( qd, a ) ), 1.0 );
+        return ( fs > 0 ) ? spans_s_push( spans, -f3_inf, n_inf, a, n ) : spans_s_push( spans, a, n, f3_inf, n_inf );
+    }
+
+    f3_t s = fs / f;
+    f3_t q = fq / f;
+    f3_t w = s * s - q;
+    if( w <= 0 ) return ( f < 0 ) ? spans_s_push( spans, -f3_inf, n_inf, f3_inf, n_inf ) : true;
+
+    w = sqrt( w );
+    f3_t a0 = -s - w;
+    f3_t a1 = -s + w;
+    v3d_s n0 = v3d_s_of_length( v3d_s_add( qp, v3d_s_mlf( qd, a0 ) ), 1.0 );
+    v3d_s n1 = v3d_s_of_length( v3d_s_add( qp, v3d_s_mlf( qd, a1 ) ), 1.0 );
+
+    if( f > 0 ) return spans_s_push( spans, a0, n0, a1, n1 );
+    return spans_s_push( spans, -f3_inf, n_inf, a0, n0 ) && spans_s_push( spans, a1, n1, f3_inf, n_inf );
+}
+
+/// slab z0 <= z <= z1 (local z); caps face away from the slab
+static bl_t obj_squaroid_s_clip_spans( const obj_squaroid_s* o, const ray_s* r, spans_s* spans )
+{
+    v3d_s axis = o->prp.rax.z;
+    f3_t pz = v3d_s_mlv( axis, v3d_s_sub( r->p, o->prp.pos ) );
+    f3_t dz = v3d_s_mlv( axis, r->d );
+    spans->size = 0;
+
+    if( dz == 0 )
+    {
+        v3d_s n_inf = v3d_s_zero();
+        return ( pz >= o->z0 && pz <= o->z1 ) ? spans_s_push( spans, -f3_inf, n_inf, f3_inf, n_inf ) : true;
+    }
+
+    f3_t a0 = ( o->z0 - pz ) / dz;
+    f3_t a1 = ( o->z1 - pz ) / dz;
+    v3d_s n0 = v3d_s_neg( axis );
+    v3d_s n1 = axis;
+    return ( dz > 0 ) ? spans_s_push( spans, a0, n0, a1, n1 ) : spans_s_push( spans, a1, n1, a0, n0 );
+}
+
+bl_t obj_squaroid_s_ray_spans( const obj_squaroid_s* o, const ray_s* r, spans_s* spans )
+{
+    if( !o->clip ) return obj_squaroid_s_quadric_spans( o, r, spans );
+
+    spans_s spans_q, spans_z;
+    if( !obj_squaroid_s_quadric_spans( o, r, &spans_q ) ) return false;
+    if( !obj_squaroid_s_clip_spans(    o, r, &spans_z ) ) return false;
+    return spans_s_intersect( &spans_q, &spans_z, spans );
+}
+
+/// true when offset a on ray p + a * d (p relative to pos) lies within the clip range
+static inline bl_t obj_squaroid_s_in_clip( const obj_squaroid_s* o, v3d_s p, v3d_s d, f3_t a )
+{
+    if( !o->clip ) return true;
+    f3_t z = v3d_s_mlv( o->prp.rax.z, v3d_s_add( p, v3d_s_mlf( d, a ) ) );
+    return z >= o->z0 && z <= o->z1;
+}
+
 f3_t obj_squaroid_s_ray_hit( const obj_squaroid_s* o, const ray_s* r, v3d_s* p_nor )
 {
-    v3d_s p = m3d_s_mlv( &o->prp.rax, v3d_s_sub( r->p, o->prp.pos ) );
-    v3d_s d = m3d_s_mlv( &o->prp.rax, r->d );
+    if( o->clip && o->caps )
+    {
+        spans_s spans;
+        if( !obj_squaroid_s_ray_spans( o, r, &spans ) ) return f3_inf;
+        return spans_s_ray_hit( &spans, p_nor );
+    }
 
-    f3_t f  = o->a * d.x * d.x + o->b * d.y * d.y + o->c * d.z * d.z;
-    f3_t fs = o->a * d.x * p.x + o->b * d.y * p.y + o->c * d.z * p.z;
-    f3_t fq = o->a * p.x * p.x + o->b * p.y * p.y + o->c * p.z * p.z + o->r;
+    v3d_s p  = v3d_s_sub( r->p, o->prp.pos );
+    v3d_s d  = r->d;
+    v3d_s qp = obj_squaroid_s_qmlv( o, p );
+    v3d_s qd = obj_squaroid_s_qmlv( o, d );
+
+    f3_t f  = v3d_s_mlv( d, qd );
+    f3_t fs = v3d_s_mlv( d, qp );
+    f3_t fq = v3d_s_mlv( p, qp ) + o->r;
     f3_t a = f3_inf;
 
-    if( f != 0 )
-    {
-        f3_t f_inv = 1.0 / f;
-        f3_t s = fs * f_inv;
-        f3_t q = fq * f_inv;
-        f3_t r = s * s - q;
-        if( r < 0 )  return f3_inf; // missing object
-        r = sqrt( r );
-        a = -s - r;
-        if( a < 0 ) a = -s + r;
-        if( a < 0 ) a = f3_inf;
-    }
-    else
-    {
-        a = ( fq != 0 ) ? -fs / ( 2 * fq ) : f3_inf;
-    }
+    if( f != 0 )
+    {
+        f3_t f_inv = 1.0 / f;
+        f3_t s = fs * f_inv;
+        f3_t q = fq * f_inv;
+        f3_t r = s * s - q;
+        if( r < 0 )  return f3_inf; // missing object
+        r = sqrt( r );
+        a = -s - r;
+        if( a < 0 || !obj_squaroid_s_in_clip( o, p, d, a ) ) a = -s + r;
+        if( a < 0 || !obj_squaroid_s_in_clip( o, p, d, a ) ) a = f3_inf;
+    }
+    else
+    {
+        // single root of 2 * fs * a + fq = 0
+        a = ( fs != 0 ) ? -fq / ( 2 * fs ) : f3_inf;
+        if( a < 0 || !obj_squaroid_s_in_clip( o, p, d, a ) ) a = f3_inf;
+    }
+
+    if( a == f3_inf ) return f3_inf;
+
+    if( p_nor )
+    {
+        // gradient: q * ( p + a * d ) = qp + a * qd
+        *p_nor = v3d_s_of_length( v3d_s_add( qp, v3d_s_mlf( qd, a ) ), 1.0 );
+    }
+
+    return a - f3_eps;
+}
+
+s2_t obj_squaroid_s_side( const obj_squaroid_s* o, v3d_s pos )
+{
+    v3d_s p = v3d_s_sub( pos, o->prp.pos );
+    if( o->clip )
+    {
+        f3_t z = v3d_s_mlv( o->prp.rax.z, p );
+        if( z < o->z0 || z > o->z1 ) return 1;
+    }
+    return ( v3d_s_mlv( p, obj_squaroid_s_qmlv( o, p ) ) + o->r ) > 0  ? 1 : -1;
+}
+
+bl_t obj_squaroid_s_bounds( const obj_squaroid_s* o, envelope_s* env )
+{
+    if( o->clip && o->a > 0 && o->b > 0 )
+    {
+        // cross section a*x^2 + b*y^2 <= w( z ) = -r - c*z^2; w takes its maximum at the largest (c < 0) or smallest (c > 0) |z|
+        f3_t abs0 = fabs( o->z0 );
+        f3_t abs1 = fabs( o->z1 );
+        f3_t zmax = abs0 > abs1 ? abs0 : abs1;
+        f3_t zmin = ( o->z0 <= 0 && o->z1 >= 0 ) ? 0 : ( abs0 < abs1 ? abs0 : abs1 );
+        f3_t z = ( o->c < 0 ) ? zmax : zmin;
+        f3_t w = -o->r - o->c * f3_sqr( z );
+        if( w < 0 ) w = 0;
+
+        v3d_s ext;
+        ext.x = sqrt( w / o->a ) + 2 * f3_eps;
+        ext.y = sqrt( w / o->b ) + 2 * f3_eps;
+        ext.z = 0.5 * ( o->z1 - o->z0 ) + 2 * f3_eps;
+
+        v3d_s center = v3d_s_add( o->prp.pos, v3d_s_mlf( o->prp.rax.z, 0.5 * ( o->z0 + o->z1 ) ) );
+        envelope_s env_box = envelope_create_obb( center, ext, &o->prp.rax );
+        envelope_s env_sph = envelope_create( center, sqrt( v3d_s_sqr( ext ) ) );
+        *env = envelope_min_area( &env_sph, &env_box );
+        return true;
+    }
+
+    // the inside area is bounded only for the ellipsoid: a, b, c > 0; r < 0
+    if( o->a <= 0 || o->b <= 0 || o->c <= 0 || o->r >= 0 ) return false;
+
+    v3d_s ext;
+    ext.x = sqrt( -o->r / o->a ) + 2 * f3_eps;
+    ext.y = sqrt( -o->r / o->b ) + 2 * f3_eps;
+    ext.z = sqrt( -o->r / o->c ) + 2 * f3_eps;
+
+    envelope_s env_box = envelope_create_obb( o->prp.pos, ext, &o->prp.rax );
+    envelope_s env_sph = envelope_create( o->prp.pos, v3d_s_max( ext ) );
+    *env = envelope_min_area( &env_sph, &env_box );
+    return true;
+}
+
+void obj_squaroid_s_move(   obj_squaroid_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
+void obj_squaroid_s_rotate( obj_squaroid_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); obj_squaroid_s_update_quadric( o ); }
+void obj_squaroid_s_scale(  obj_squaroid_s* o, f3_t fac         )
+{
+    properties_s_scale ( &o->prp, fac );
+    o->r *= f3_sqr( fac );
+    o->z0 *= fac;
+    o->z1 *= fac;
+
+    // a negative factor reverses the z-range
+    if( fac < 0 )
+    {
+        f3_t z0 = o->z0;
+        o->z0 = o->z1;
+        o->z1 = z0;
+    }
+}
+
+/**********************************************************************************************************************/
+/** obj_torus_s
+ *  Torus around the local z-axis: ( sqrt( x^2 + y^2 ) - radius1 )^2 + z^2 = radius2^2
+ *  radius1: distance of the tube's center from the axis; radius2: tube radius
+ */
+
+typedef struct obj_torus_s
+{
+    union
+    {
+        obj_hdr_s hdr;
+        struct
+        {
+            aware_t _;
+            const spect_obj_s* p;
+            properties_s prp;
+        };
+    };
+    f3_t radius1;
+    f3_t radius2;
+} obj_torus_s;
+
+static sc_t obj_torus_s_def =
+"obj_torus_s = spect_obj"
+"{"
+    "aware_t _;"
+    "spect spect_obj_s -> p;"
+    "properties_s prp;"
+    "f3_t radius1 = 1.0;"
+    "f3_t radius2 = 0.5;"
+
+    "func projection_fp   projection      = obj_torus_s_projection;"
+    "func fov_fp          fov             = obj_torus_s_fov;"
+    "func ray_hit_fp      ray_hit         = obj_torus_s_ray_hit;"
+    "func side_fp         side            = obj_torus_s_side;"
+    "func is_in_fov_fp    is_in_fov       = obj_torus_s_is_in_fov;"
+    "func is_reachable_fp is_reachable    = obj_torus_s_is_reachable;"
+    "func move_fp         move            = obj_torus_s_move;"
+    "func rotate_fp       rotate          = obj_torus_s_rotate;"
+    "func scale_fp        scale           = obj_torus_s_scale;"
+    "func bounds_fp       bounds          = obj_torus_s_bounds;"
+    "func ray_spans_fp    ray_spans       = obj_torus_s_ray_spans;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_torus_s, obj_torus_s_def )
+
+void obj_torus_s_set_radii( obj_torus_s* o, f3_t radius1, f3_t radius2 )
+{
+    o->radius1 = f3_abs( radius1 );
+    o->radius2 = f3_abs( radius2 );
+}
+
+obj_torus_s* obj_torus_s_create_torus( f3_t radius1, f3_t radius2 )
+{
+    obj_torus_s* o = obj_torus_s_create();
+    obj_torus_s_set_radii( o, radius1, radius2 );
+    return o;
+}
+
+/// radius of the bounding sphere
+static inline f3_t obj_torus_s_outer_radius( const obj_torus_s* o )
+{
+    return o->radius1 + o->radius2;
+}
+
+/// position in the local frame
+static inline v3d_s obj_torus_s_local_pos( const obj_torus_s* o, v3d_s pos )
+{
+    return m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) );
+}
+
+/// outward surface normal (global frame) at local position p
+static v3d_s obj_torus_s_normal( const obj_torus_s* o, v3d_s p )
+{
+    // p minus the closest point on the tube's center circle
+    f3_t f = sqrt( f3_sqr( p.x ) + f3_sqr( p.y ) );
+    v3d_s n = p;
+    if( f > 0 )
+    {
+        f3_t s = o->radius1 / f;
+        n.x -= p.x * s;
+        n.y -= p.y * s;
+    }
+    return v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, n ), 1.0 );
+}
+
+v2d_s obj_torus_s_projection( const obj_torus_s* o, v3d_s pos )
+{
+    v3d_s p = obj_torus_s_local_pos( o, pos );
+    f3_t f = sqrt( f3_sqr( p.x ) + f3_sqr( p.y ) );
+    f3_t azimuth   = atan2( p.x, p.y );
+    f3_t elevation = atan2( p.z, f - o->radius1 );
+    return ( v2d_s ) { azimuth, elevation };
+}
+
+ray_cone_s obj_torus_s_fov( const obj_torus_s* o, v3d_s pos )
+{
+    ray_cone_s cne;
+    v3d_s diff = v3d_s_sub( o->prp.pos, pos );
+    cne.ray.d = v3d_s_of_length( diff, 1.0 );
+    cne.ray.p = pos;
+    f3_t diff_sqr = v3d_s_sqr( diff );
+    f3_t radius_sqr = f3_sqr( obj_torus_s_outer_radius( o ) );
+    cne.cos_rs = ( diff_sqr > radius_sqr ) ? sqrt( 1.0 - ( radius_sqr / diff_sqr ) ) : -1;
+    return cne;
+}
+
+bl_t obj_torus_s_is_in_fov( const obj_torus_s* o, const ray_cone_s* fov )
+{
+    return sphere_is_in_fov( o->prp.pos, obj_torus_s_outer_radius( o ), fov );
+}
+
+bl_t obj_torus_s_is_reachable( const obj_torus_s* o, const ray_s* ray_field, f3_t length )
+{
+    return sphere_intersects_half_sphere( o->prp.pos, obj_torus_s_outer_radius( o ), ray_field, length );
+}
+
+/** Computes all surface intersections of the ray's line (ascending offsets; inside between an even and the following odd root).
+ *  The quartic is solved on the chord through the bounding sphere with origin moved to the chord's entry,
+ *  which keeps the coefficients well conditioned for distant rays.
+ *  Returns the number of roots; p_loc, d_loc receive the ray in the local frame.
+ */
+static uz_t obj_torus_s_line_roots( const obj_torus_s* o, const ray_s* r, f3_t* roots, v3d_s* p_loc, v3d_s* d_loc )
+{
+    v3d_s p = obj_torus_s_local_pos( o, r->p );
+    v3d_s d = m3d_s_mlv( &o->prp.rax, r->d );
+    *p_loc = p;
+    *d_loc = d;
+
+    // chord through the bounding sphere (slightly enlarged so that its boundary is outside the torus)
+    f3_t rs = obj_torus_s_outer_radius( o ) + f3_eps;
+    f3_t dd = v3d_s_sqr( d );
+    f3_t s  = v3d_s_mlv( p, d ) / dd;
+    f3_t q  = ( v3d_s_sqr( p ) - rs * rs ) / dd;
+    if( s * s <= q ) return 0;
+    f3_t w  = sqrt( s * s - q );
+    f3_t t0 = -s - w;
+    f3_t t1 = -s + w;
+    if( t1 <= 0 ) return 0;
+
+    v3d_s p0 = v3d_s_add( p, v3d_s_mlf( d, t0 ) );
+
+    /** ( |p0 + t * d|^2 + R^2 - r^2 )^2 - 4 * R^2 * ( ( p0.x + t * d.x )^2 + ( p0.y + t * d.y )^2 ) = 0
+     *  with |p0 + t * d|^2 + R^2 - r^2 = A * t^2 + B * t + C
+     */
+    f3_t R2 = f3_sqr( o->radius1 );
+    f3_t A = dd;
+    f3_t B = 2 * v3d_s_mlv( p0, d );
+    f3_t C = v3d_s_sqr( p0 ) + R2 - f3_sqr( o->radius2 );
+    f3_t c[ 5 ];
+    c[ 4 ] = A * A;
+    c[ 3 ] = 2 * A * B;
+    c[ 2 ] = B * B + 2 * A * C - 4 * R2 * ( d.x * d.x + d.y * d.y );
+    c[ 1 ] = 2 * B * C - 8 * R2 * ( p0.x * d.x + p0.y * d.y );
+    c[ 0 ] = C * C - 4 * R2 * ( p0.x * p0.x + p0.y * p0.y );
+
+    uz_t size = polynomial_roots( c, 4, 0, t1 - t0, roots );
+    for( uz_t i = 0; i < size; i++ ) roots[ i ] += t0;
+    return size;
+}
+
+f3_t obj_torus_s_ray_hit( const obj_torus_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    f3_t roots[ 4 ];
+    v3d_s p, d;
+    uz_t size = obj_torus_s_line_roots( o, r, roots, &p, &d );
+    for( uz_t i = 0; i < size; i++ )
+    {
+        f3_t a = roots[ i ];
+        if( a > 0 )
+        {
+            if( p_nor ) *p_nor = obj_torus_s_normal( o, v3d_s_add( p, v3d_s_mlf( d, a ) ) );
+            return a - f3_eps;
+        }
+    }
+    return f3_inf;
+}
+
+bl_t obj_torus_s_ray_spans( const obj_torus_s* o, const ray_s* r, spans_s* spans )
+{
+    f3_t roots[ 4 ];
+    v3d_s p, d;
+    uz_t size = obj_torus_s_line_roots( o, r, roots, &p, &d );
+    spans->size = 0;
+
+    // the chord starts outside the torus: roots alternate between entry and exit
+    for( uz_t i = 0; i + 1 < size; i += 2 )
+    {
+        f3_t a0 = roots[ i ];
+        f3_t a1 = roots[ i + 1 ];
+        v3d_s n0 = obj_torus_s_normal( o, v3d_s_add( p, v3d_s_mlf( d, a0 ) ) );
+        v3d_s n1 = obj_torus_s_normal( o, v3d_s_add( p, v3d_s_mlf( d, a1 ) ) );
+        if( !spans_s_push( spans, a0, n0, a1, n1 ) ) return false;
+    }
+    return true;
+}
+
+s2_t obj_torus_s_side( const obj_torus_s* o, v3d_s pos )
+{
+    v3d_s p = obj_torus_s_local_pos( o, pos );
+    f3_t f = sqrt( f3_sqr( p.x ) + f3_sqr( p.y ) );
+    return ( f3_sqr( f - o->radius1 ) + f3_sqr( p.z ) > f3_sqr( o->radius2 ) ) ? 1 : -1;
+}
+
+bl_t obj_torus_s_bounds( const obj_torus_s* o, envelope_s* env )
+{
+    f3_t re = obj_torus_s_outer_radius( o ) + 2 * f3_eps;
+    v3d_s ext = { re, re, o->radius2 + 2 * f3_eps };
+    envelope_s env_box = envelope_create_obb( o->prp.pos, ext, &o->prp.rax );
+    envelope_s env_sph = envelope_create( o->prp.pos, re );
+    *env = envelope_min_area( &env_sph, &env_box );
+    return true;
+}
+
+void obj_torus_s_move(   obj_torus_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
+void obj_torus_s_rotate( obj_torus_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
+void obj_torus_s_scale(  obj_torus_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->radius1 *= f3_abs( fac ); o->radius2 *= f3_abs( fac ); }
+
+/**********************************************************************************************************************/
+/** obj_mesh_s
+ *  Triangle mesh placed in the local frame: local = rax * ( world - pos ) / scale
+ *  The mesh (incl. its hierarchy) is shared among all copies of the object.
+ *  Rays are transformed into the mesh's frame; offsets are invariant under this transform.
+ */
+
+typedef struct obj_mesh_s
+{
+    union
+    {
+        obj_hdr_s hdr;
+        struct
+        {
+            aware_t _;
+            const spect_obj_s* p;
+            properties_s prp;
+        };
+    };
+    mesh_s* mesh;
+    f3_t scale;
+} obj_mesh_s;
+
+static sc_t obj_mesh_s_def =
+"obj_mesh_s = spect_obj"
+"{"
+    "aware_t _;"
+    "spect spect_obj_s -> p;"
+    "properties_s prp;"
+    "mesh_s -> mesh;"
+    "f3_t scale = 1.0;"
+
+    "func projection_fp   projection      = obj_mesh_s_projection;"
+    "func fov_fp          fov             = obj_mesh_s_fov;"
+    "func ray_hit_fp      ray_hit         = obj_mesh_s_ray_hit;"
+    "func side_fp         side            = obj_mesh_s_side;"
+    "func is_in_fov_fp    is_in_fov       = obj_mesh_s_is_in_fov;"
+    "func is_reachable_fp is_reachable    = obj_mesh_s_is_reachable;"
+    "func move_fp         move            = obj_mesh_s_move;"
+    "func rotate_fp       rotate          = obj_mesh_s_rotate;"
+    "func scale_fp        scale           = obj_mesh_s_scale;"
+    "func bounds_fp       bounds          = obj_mesh_s_bounds;"
+    "func ray_spans_fp    ray_spans       = obj_mesh_s_ray_spans;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_mesh_s, obj_mesh_s_def )
+
+obj_mesh_s* obj_mesh_s_create_mesh( sc_t file )
+{
+    obj_mesh_s* o = obj_mesh_s_create();
+    o->mesh = mesh_s_create_load( file );
+    return o;
+}
+
+/// position in the mesh's frame
+static inline v3d_s obj_mesh_s_local_pos( const obj_mesh_s* o, v3d_s pos )
+{
+    return v3d_s_mlf( m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) ), 1.0 / o->scale );
+}
+
+static inline ray_s obj_mesh_s_local_ray( const obj_mesh_s* o, const ray_s* r )
+{
+    ray_s ray;
+    ray.p = obj_mesh_s_local_pos( o, r->p );
+    ray.d = v3d_s_mlf( m3d_s_mlv( &o->prp.rax, r->d ), 1.0 / o->scale );
+    return ray;
+}
+
+/// bounding sphere (global frame)
+static void obj_mesh_s_sphere( const obj_mesh_s* o, v3d_s* center, f3_t* radius )
+{
+    box_s box = mesh_s_get_box( o->mesh );
+    if( box_s_is_empty( box ) )
+    {
+        *center = o->prp.pos;
+        *radius = 0;
+        return;
+    }
+    *center = v3d_s_add( o->prp.pos, m3d_s_tmlv( &o->prp.rax, v3d_s_mlf( box_s_center( box ), o->scale ) ) );
+    *radius = 0.5 * sqrt( v3d_s_diff_sqr( box.max, box.min ) ) * o->scale;
+}
+
+v2d_s obj_mesh_s_projection( const obj_mesh_s* o, v3d_s pos )
+{
+    v3d_s p = v3d_s_sub( obj_mesh_s_local_pos( o, pos ), box_s_center( mesh_s_get_box( o->mesh ) ) );
+    f3_t azimuth   = atan2( p.x, p.y );
+    f3_t elevation = atan2( p.z, sqrt( f3_sqr( p.x ) + f3_sqr( p.y ) ) );
+    return ( v2d_s ) { azimuth, elevation };
+}
+
+ray_cone_s obj_mesh_s_fov( const obj_mesh_s* o, v3d_s pos )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_mesh_s_sphere( o, &center, &radius );
+    ray_cone_s cne;
+    v3d_s diff = v3d_s_sub( center, pos );
+    cne.ray.d = v3d_s_of_length( diff, 1.0 );
+    cne.ray.p = pos;
+    f3_t diff_sqr = v3d_s_sqr( diff );
+    f3_t radius_sqr = f3_sqr( radius );
+    cne.cos_rs = ( diff_sqr > radius_sqr ) ? sqrt( 1.0 - ( radius_sqr / diff_sqr ) ) : -1;
+    return cne;
+}
+
+bl_t obj_mesh_s_is_in_fov( const obj_mesh_s* o, const ray_cone_s* fov )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_mesh_s_sphere( o, &center, &radius );
+    return sphere_is_in_fov( center, radius, fov );
+}
+
+bl_t obj_mesh_s_is_reachable( const obj_mesh_s* o, const ray_s* ray_field, f3_t length )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_mesh_s_sphere( o, &center, &radius );
+    return sphere_intersects_half_sphere( center, radius, ray_field, length );
+}
+
+f3_t obj_mesh_s_ray_hit( const obj_mesh_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    ray_s ray = obj_mesh_s_local_ray( o, r );
+    v3d_s nor;
+    f3_t a = mesh_s_ray_hit( o->mesh, &ray, p_nor ? &nor : NULL );
+    if( a == f3_inf ) return f3_inf;
+    if( p_nor ) *p_nor = m3d_s_tmlv( &o->prp.rax, nor );
+    return a - f3_eps;
+}
+
+/// crossings alternate between entry and exit; an odd number of crossings means the ray starts inside
+bl_t obj_mesh_s_ray_spans( const obj_mesh_s* o, const ray_s* r, spans_s* spans )
+{
+    ray_s ray = obj_mesh_s_local_ray( o, r );
+    f3_t  offs[ SPANS_MAX * 2 ];
+    v3d_s nor[  SPANS_MAX * 2 ];
+    uz_t size = 0;
+    spans->size = 0;
+    if( !mesh_s_ray_crossings( o->mesh, &ray, offs, nor, SPANS_MAX * 2, &size ) ) return false;
+    for( uz_t i = 0; i < size; i++ ) nor[ i ] = m3d_s_tmlv( &o->prp.rax, nor[ i ] );
+
+    uz_t i = 0;
+    if( size & 1 )
+    {
+        if( !spans_s_push( spans, -f3_inf, v3d_s_zero(), offs[ 0 ], nor[ 0 ] ) ) return false;
+        i = 1;
+    }
+    for( ; i + 1 < size; i += 2 )
+    {
+        if( !spans_s_push( spans, offs[ i ], nor[ i ], offs[ i + 1 ], nor[ i + 1 ] ) ) return false;
+    }
+    return true;
+}
+
+s2_t obj_mesh_s_side( const obj_mesh_s* o, v3d_s pos )
+{
+    return mesh_s_side( o->mesh, obj_mesh_s_local_pos( o, pos ) );
+}
+
+bl_t obj_mesh_s_bounds( const obj_mesh_s* o, envelope_s* env )
+{
+    box_s box = mesh_s_get_box( o->mesh );
+    if( box_s_is_empty( box ) ) return false;
+
+    v3d_s center;
+    f3_t radius;
+    obj_mesh_s_sphere( o, &center, &radius );
+    v3d_s ext = v3d_s_mlf( v3d_s_sub( box.max, box.min ), 0.5 * o->scale );
+    ext = v3d_s_add( ext, ( v3d_s ) { 2 * f3_eps, 2 * f3_eps, 2 * f3_eps } );
+
+    envelope_s env_box = envelope_create_obb( center, ext, &o->prp.rax );
+    envelope_s env_sph = envelope_create( center, radius + 2 * f3_eps );
+    *env = envelope_min_area( &env_sph, &env_box );
+    return true;
+}
+
+void obj_mesh_s_move(   obj_mesh_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
+void obj_mesh_s_rotate( obj_mesh_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
+void obj_mesh_s_scale(  obj_mesh_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->scale *= fac; }
+
+/**********************************************************************************************************************/
+/** obj_sphere_cloud_s
+ *  Set of spheres sharing the object's properties (see sphere_cloud_s).
+ *  Spheres are placed in the local frame: local = rax * ( world - pos ) / scale
+ *  The hierarchy is built by obj_bake; offsets scale with the frame.
+ */
+
+typedef struct obj_sphere_cloud_s
+{
+    union
+    {
+        obj_hdr_s hdr;
+        struct
+        {
+            aware_t _;
+            const spect_obj_s* p;
+            properties_s prp;
+        };
+    };
+    sphere_cloud_s cloud;
+    f3_t scale;
+} obj_sphere_cloud_s;
+
+static sc_t obj_sphere_cloud_s_def =
+"obj_sphere_cloud_s = spect_obj"
+"{"
+    "aware_t _;"
+    "spect spect_obj_s -> p;"
+    "properties_s prp;"
+    "sphere_cloud_s cloud;"
+    "f3_t scale = 1.0;"
+
+    "func projection_fp   projection      = obj_sphere_cloud_s_projection;"
+    "func fov_fp          fov             = obj_sphere_cloud_s_fov;"
+    "func ray_hit_fp      ray_hit         = obj_sphere_cloud_s_ray_hit;"
+    "func ray_occluded_fp ray_occluded    = obj_sphere_cloud_s_ray_occluded;"
+    "func side_fp         side            = obj_sphere_cloud_s_side;"
+    "func is_in_fov_fp    is_in_fov       = obj_sphere_cloud_s_is_in_fov;"
+    "func is_reachable_fp is_reachable    = obj_sphere_cloud_s_is_reachable;"
+    "func move_fp         move            = obj_sphere_cloud_s_move;"
+    "func rotate_fp       rotate          = obj_sphere_cloud_s_rotate;"
+    "func scale_fp        scale           = obj_sphere_cloud_s_scale;"
+    "func bounds_fp       bounds          = obj_sphere_cloud_s_bounds;"
+"}";
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_sphere_cloud_s, obj_sphere_cloud_s_def )
+
+/// pos in the global frame
+void obj_sphere_cloud_s_push_sphere( obj_sphere_cloud_s* o, v3d_s pos, f3_t radius )
+{
+    v3d_s local = v3d_s_mlf( m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) ), 1.0 / o->scale );
+    sphere_cloud_s_push( &o->cloud, local, radius / o->scale );
+}
+
+void obj_sphere_cloud_s_prepare( obj_sphere_cloud_s* o )
+{
+    sphere_cloud_s_prepare( &o->cloud );
+}
+
+/// ray in the local frame with normalized direction (local offset = global offset / scale)
+static inline ray_s obj_sphere_cloud_s_local_ray( const obj_sphere_cloud_s* o, const ray_s* r )
+{
+    ray_s ray;
+    ray.p = v3d_s_mlf( m3d_s_mlv( &o->prp.rax, v3d_s_sub( r->p, o->prp.pos ) ), 1.0 / o->scale );
+    ray.d = m3d_s_mlv( &o->prp.rax, r->d );
+    return ray;
+}
+
+/// bounding sphere (global frame)
+static void obj_sphere_cloud_s_sphere( const obj_sphere_cloud_s* o, v3d_s* center, f3_t* radius )
+{
+    box_s box = sphere_cloud_s_get_box( &o->cloud );
+    if( box_s_is_empty( box ) )
+    {
+        *center = o->prp.pos;
+        *radius = 0;
+        return;
+    }
+    *center = v3d_s_add( o->prp.pos, m3d_s_tmlv( &o->prp.rax, v3d_s_mlf( box_s_center( box ), o->scale ) ) );
+    *radius = 0.5 * sqrt( v3d_s_diff_sqr( box.max, box.min ) ) * o->scale;
+}
+
+v2d_s obj_sphere_cloud_s_projection( const obj_sphere_cloud_s* o, v3d_s pos )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_sphere_cloud_s_sphere( o, &center, &radius );
+    v3d_s p = m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, center ) );
+    f3_t azimuth   = atan2( p.x, p.y );
+    f3_t elevation = atan2( p.z, sqrt( f3_sqr( p.x ) + f3_sqr( p.y ) ) );
+    return ( v2d_s ) { azimuth, elevation };
+}
+
+ray_cone_s obj_sphere_cloud_s_fov( const obj_sphere_cloud_s* o, v3d_s pos )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_sphere_cloud_s_sphere( o, &center, &radius );
+    ray_cone_s cne;
+    v3d_s diff = v3d_s_sub( center, pos );
+    cne.ray.d = v3d_s_of_length( diff, 1.0 );
+    cne.ray.p = pos;
+    f3_t diff_sqr = v3d_s_sqr( diff );
+    f3_t radius_sqr = f3_sqr( radius );
+    cne.cos_rs = ( diff_sqr > radius_sqr ) ? sqrt( 1.0 - ( radius_sqr / diff_sqr ) ) : -1;
+    return cne;
+}
+
+bl_t obj_sphere_cloud_s_is_in_fov( const obj_sphere_cloud_s* o, const ray_cone_s* fov )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_sphere_cloud_s_sphere( o, &center, &radius );
+    return sphere_is_in_fov( center, radius, fov );
+}
+
+bl_t obj_sphere_cloud_s_is_reachable( const obj_sphere_cloud_s* o, const ray_s* ray_field, f3_t length )
+{
+    v3d_s center;
+    f3_t radius;
+    obj_sphere_cloud_s_sphere( o, &center, &radius );
+    return sphere_intersects_half_sphere( center, radius, ray_field, length );
+}
 
+f3_t obj_sphere_cloud_s_ray_hit( const obj_sphere_cloud_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    ray_s ray = obj_sphere_cloud_s_local_ray( o, r );
+    v3d_s nor;
+    f3_t a = sphere_cloud_s_ray_hit( &o->cloud, &ray, p_nor ? &nor : NULL );
     if( a == f3_inf ) return f3_inf;
+    if( p_nor ) *p_nor = m3d_s_tmlv( &o->prp.rax, nor );
+    return a * o->scale - f3_eps;
+}
 
-    if( p_nor )
-    {
-        f3_t x = p.x + a * d.x;
-        f3_t y = p.y + a * d.y;
-        f3_t z = p.z + a * d.z;
-
-        v3d_s n1;
-        n1.x = x * o->a;
-        n1.y = y * o->b;
-        n1.z = z * o->c;
-        *p_nor = v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, n1 ), 1.0 );
-    }
+/// equivalent to obj_sphere_cloud_s_ray_hit( o, r, NULL ) <= max_dist
+bl_t obj_sphere_cloud_s_ray_occluded( const obj_sphere_cloud_s* o, const ray_s* r, f3_t max_dist )
+{
+    ray_s ray = obj_sphere_cloud_s_local_ray( o, r );
+    return sphere_cloud_s_ray_occluded( &o->cloud, &ray, ( max_dist + f3_eps ) / o->scale );
+}
 
-    return a - f3_eps;
+s2_t obj_sphere_cloud_s_side( const obj_sphere_cloud_s* o, v3d_s pos )
+{
+    v3d_s local = v3d_s_mlf( m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) ), 1.0 / o->scale );
+    return sphere_cloud_s_side( &o->cloud, local );
 }
 
-s2_t obj_squaroid_s_side( const obj_squaroid_s* o, v3d_s pos )
+bl_t obj_sphere_cloud_s_bounds( const obj_sphere_cloud_s* o, envelope_s* env )
 {
-    v3d_s p = m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) );
-    return ( o->a * p.x * p.x + o->b * p.y * p.y + o->c * p.z * p.z + o->r ) > 0  ? 1 : -1;
+    box_s box = sphere_cloud_s_get_box( &o->cloud );
+    if( box_s_is_empty( box ) ) return false;
+
+    v3d_s center;
+    f3_t radius;
+    obj_sphere_cloud_s_sphere( o, &center, &radius );
+    v3d_s ext = v3d_s_mlf( v3d_s_sub( box.max, box.min ), 0.5 * o->scale );
+    ext = v3d_s_add( ext, ( v3d_s ) { 2 * f3_eps, 2 * f3_eps, 2 * f3_eps } );
+
+    envelope_s env_box = envelope_create_obb( center, ext, &o->prp.rax );
+    envelope_s env_sph = envelope_create( center, radius + 2 * f3_eps );
+    *env = envelope_min_area( &env_sph, &env_box );
+    return true;
 }
 
-void obj_squaroid_s_move(   obj_squaroid_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
-void obj_squaroid_s_rotate( obj_squaroid_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
-void obj_squaroid_s_scale(  obj_squaroid_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->r *= f3_sqr( fac ); }
+void obj_sphere_cloud_s_move(   obj_sphere_cloud_s* o, const v3d_s* vec ) { properties_s_move  ( &o->prp, vec ); }
+void obj_sphere_cloud_s_rotate( obj_sphere_cloud_s* o, const m3d_s* mat ) { properties_s_rotate( &o->prp, mat ); }
+void obj_sphere_cloud_s_scale(  obj_sphere_cloud_s* o, f3_t fac         ) { properties_s_scale ( &o->prp, fac ); o->scale *= fac; }
 
 /**********************************************************************************************************************/
 /// obj_distance_s  (object based on distance function)
@@ -847,6 +2274,11 @@ typedef struct obj_distance_s
     };
     f3_t inv_scale;
     uz_t cycles;
+    f3_t lipschitz; // upper bound of the gradient magnitude of the distance function (enhanced marcher)
+    bl_t reference; // true: plain sphere tracing with forward difference normals (reference for comparisons)
+    uz_t bake_resolution; // > 0: obj_distance_s_bake samples the distance function (cells per envelope diameter)
+    st_s* bake_folder;    // folder of cached bakes (optional)
+    distance_cache_s* cache; // baked distance function (local frame)
     vd_t distance;
 } obj_distance_s;
 
@@ -858,6 +2290,11 @@ static sc_t obj_distance_s_def =
     "properties_s prp;"
     "f3_t inv_scale = 1.0;"
     "uz_t cycles = 200;"
+    "f3_t lipschitz = 1.0;"
+    "bl_t reference = false;"
+    "uz_t bake_resolution = 0;"
+    "st_s => bake_folder;"
+    "distance_cache_s => cache;"
     "aware => distance;"
 
     "func projection_fp   projection      = obj_distance_s_projection;"
@@ -871,8 +2308,19 @@ static sc_t obj_distance_s_def =
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_distance_s, obj_distance_s_def )
 
+/// discards the baked distance function (needed whenever the distance function changes)
+static void obj_distance_s_reset_cache( obj_distance_s* o )
+{
+    if( o->cache )
+    {
+        distance_cache_s_discard( o->cache );
+        o->cache = NULL;
+    }
+}
+
 void obj_distance_s_set_distance( obj_distance_s* o, vc_t distance )
 {
+    obj_distance_s_reset_cache( o );
     o->distance = bcore_inst_a_clone( distance );
 }
 
@@ -881,6 +2329,70 @@ void obj_distance_s_set_cycles( obj_distance_s* o, uz_t cycles )
     o->cycles = cycles;
 }
 
+void obj_distance_s_set_lipschitz( obj_distance_s* o, f3_t lipschitz )
+{
+    obj_distance_s_reset_cache( o );
+    o->lipschitz = ( lipschitz > 0 ) ? lipschitz : 1.0;
+}
+
+void obj_distance_s_set_bake( obj_distance_s* o, uz_t resolution, sc_t folder )
+{
+    obj_distance_s_reset_cache( o );
+    o->bake_resolution = resolution;
+    st_s* bake_folder = folder ? st_s_create_sc( folder ) : NULL; // folder may refer to o->bake_folder
+    if( o->bake_folder ) st_s_discard( o->bake_folder );
+    o->bake_folder = bake_folder;
+}
+
+void obj_distance_s_bake( obj_distance_s* o, uz_t threads )
+{
+    if( o->bake_resolution == 0 || !o->distance ) return;
+    if( !o->prp.envelope )
+    {
+        bcore_msg_fa( "obj_distance_s: Baking requires an envelope. Object is not baked.\n" );
+        return;
+    }
+
+    // cube around the envelope in the local frame
+    f3_t radius = o->prp.envelope->radius * f3_abs( o->inv_scale );
+    v3d_s center = v3d_s_mlf( m3d_s_mlv( &o->prp.rax, v3d_s_sub( o->prp.envelope->pos, o->prp.pos ) ), o->inv_scale );
+    v3d_s min = v3d_s_sub( center, ( v3d_s ){ radius, radius, radius } );
+    f3_t size = 2 * radius;
+
+    tp_t fingerprint = distance_cache_s_fingerprint( o->distance, min, size, o->bake_resolution, o->lipschitz );
+    if( o->cache && distance_cache_s_get_fingerprint( o->cache ) == fingerprint ) return;
+    obj_distance_s_reset_cache( o );
+
+    st_s* file = NULL;
+    if( o->bake_folder )
+    {
+        file = st_s_create_fa( "#<sc_t>/distance_cache_#<tp_t>.bin", o->bake_folder->sc, fingerprint );
+        if( bcore_file_exists( file->sc ) )
+        {
+            sr_s sr = bcore_bin_ml_from_file( file->sc );
+            if( sr_s_type( &sr ) == TYPEOF_distance_cache_s && distance_cache_s_get_fingerprint( sr.o ) == fingerprint )
+            {
+                o->cache = distance_cache_s_clone( sr.o );
+            }
+            sr_down( sr );
+        }
+    }
+
+    if( !o->cache )
+    {
+        o->cache = distance_cache_s_create();
+        distance_cache_s_bake( o->cache, o->distance, min, size, o->bake_resolution, o->lipschitz, threads );
+        if( file ) bcore_bin_ml_x_to_file( sr_awc( o->cache ), file->sc );
+    }
+
+    if( file ) st_s_discard( file );
+}
+
+void obj_distance_s_set_reference( obj_distance_s* o, bl_t reference )
+{
+    o->reference = reference;
+}
+
 obj_distance_s* obj_distance_s_create_distance( vc_t distance, envelope_s* envelope )
 {
     obj_distance_s* o = obj_distance_s_create();
@@ -900,6 +2412,168 @@ bl_t obj_distance_s_is_in_fov( const obj_distance_s* o, const ray_cone_s* fov )
     return true;
 }
 
+/// plain sphere tracing (reference); returns the offset where the sign of the distance changed and that distance
+static f3_t obj_distance_s_march_reference( const obj_distance_s* o, const ray_s* ray, f3_t* p_dist )
+{
+    f3_t offs = 0;
+    f3_t dist = distance( o->distance, ray->p );
+
+    if( dist > 0 )
+    {
+        for( uz_t i = 0; i < o->cycles; i++ )
+        {
+            offs += dist + f3_eps;
+            dist = distance( o->distance, ray_s_pos( ray, offs ) );
+            if( dist < 0 || dist > f3_mag ) break;
+        }
+    }
+    else
+    {
+        for( uz_t i = 0; i < o->cycles; i++ )
+        {
+            offs -= dist - f3_eps;
+            dist = distance( o->distance, ray_s_pos( ray, offs ) );
+            if( dist > 0 || dist < -f3_mag ) break;
+        }
+    }
+
+    *p_dist = dist;
+    return offs;
+}
+
+/// distance at local position p; away from the surface this can be a conservative bound from the baked cache
+static inline f3_t obj_distance_s_distance( const obj_distance_s* o, v3d_s p )
+{
+    f3_t d;
+    if( o->cache && distance_cache_s_bound( o->cache, p, &d ) ) return d;
+    return distance( o->distance, p );
+}
+
+/// batched obj_distance_s_distance (n <= DISTANCE_LANES)
+static void obj_distance_s_distance_n( const obj_distance_s* o, const v3d_s* pos, f3_t* dist, uz_t n )
+{
+    if( !o->cache )
+    {
+        distance_n( o->distance, pos, dist, n );
+        return;
+    }
+
+    // exact evaluation of the remaining positions in one batch
+    v3d_s pos_exact[ DISTANCE_LANES ];
+    f3_t dist_exact[ DISTANCE_LANES ];
+    uz_t idx_exact[ DISTANCE_LANES ];
+    uz_t size = 0;
+    for( uz_t i = 0; i < n; i++ )
+    {
+        if( !distance_cache_s_bound( o->cache, pos[ i ], &dist[ i ] ) )
+        {
+            pos_exact[ size ] = pos[ i ];
+            idx_exact[ size ] = i;
+            size++;
+        }
+    }
+    if( size == 0 ) return;
+    distance_n( o->distance, pos_exact, dist_exact, size );
+    for( uz_t i = 0; i < size; i++ ) dist[ idx_exact[ i ] ] = dist_exact[ i ];
+}
+
+/// over-relaxation factor of obj_distance_s_march
+#define DISTANCE_OVER_RELAXATION 1.6
+
+/** Over-relaxed sphere tracing (Keinert et al. 2014): steps are enlarged by DISTANCE_OVER_RELAXATION
+ *  as long as consecutive unbounding spheres overlap. Otherwise (or when the surface was crossed)
+ *  marching continues with plain steps from the unrelaxed step, which is evaluated speculatively
+ *  together with the relaxed step (one batched distance call).
+ *  Steps are scaled by 1 / lipschitz. Marching ends beyond offs_max.
+ *  Returns the offset where the sign of the distance changed and that distance (like the reference).
+ */
+static f3_t obj_distance_s_march( const obj_distance_s* o, const ray_s* ray, f3_t offs_max, f3_t* p_dist )
+{
+    f3_t l_inv = 1.0 / o->lipschitz;
+    f3_t dist  = obj_distance_s_distance( o, ray->p );
+    f3_t sign  = ( dist > 0 ) ? 1.0 : -1.0;
+
+    f3_t omega     = DISTANCE_OVER_RELAXATION;
+    f3_t offs      = 0;
+    f3_t offs_prev = 0;
+    f3_t r_prev    = 0; // unbounding radius at offs_prev
+    f3_t offs_safe = 0; // unrelaxed step from offs_prev
+    f3_t dist_safe = 0; // distance at offs_safe
+
+    for( uz_t i = 0; i < o->cycles; i++ )
+    {
+        f3_t r = sign * dist * l_inv;
+        if( omega > 1 && offs > 0 && ( r < 0 || r + r_prev < offs - offs_prev ) )
+        {
+            omega = 1;
+            offs = offs_safe;
+            dist = dist_safe;
+            continue;
+        }
+
+        if( r < 0 || dist > f3_mag || dist < -f3_mag ) break;
+        offs_prev = offs;
+        r_prev = r;
+        offs_safe = offs + r + f3_eps;
+        offs += omega * r + f3_eps;
+
+        if( offs > offs_max && omega > 1 )
+        {
+            omega = 1;
+            offs = offs_safe;
+        }
+
+        if( offs > offs_max )
+        {
+            dist = f3_inf; // left the envelope
+            break;
+        }
+
+        if( omega > 1 )
+        {
+            v3d_s pos[ 2 ] = { ray_s_pos( ray, offs ), ray_s_pos( ray, offs_safe ) };
+            f3_t d[ 2 ];
+            obj_distance_s_distance_n( o, pos, d, 2 );
+            dist      = d[ 0 ];
+            dist_safe = d[ 1 ];
+        }
+        else
+        {
+            dist = obj_distance_s_distance( o, ray_s_pos( ray, offs ) );
+        }
+    }
+
+    *p_dist = dist;
+    return offs;
+}
+
+/// forward difference gradient (reference)
+static v3d_s obj_distance_s_gradient_reference( const obj_distance_s* o, v3d_s p )
+{
+    f3_t d0 = distance( o->distance, p );
+    v3d_s n;
+    n.x = ( distance( o->distance, ( v3d_s ){ p.x + f3_eps, p.y, p.z } ) - d0 ) / f3_eps;
+    n.y = ( distance( o->distance, ( v3d_s ){ p.x, p.y + f3_eps, p.z } ) - d0 ) / f3_eps;
+    n.z = ( distance( o->distance, ( v3d_s ){ p.x, p.y, p.z + f3_eps } ) - d0 ) / f3_eps;
+    return n;
+}
+
+/// tetrahedral gradient: four samples at the corners of a tetrahedron (central difference accuracy); evaluated as one batch
+static v3d_s obj_distance_s_gradient( const obj_distance_s* o, v3d_s p )
+{
+    f3_t h = f3_eps;
+    v3d_s tap[ 4 ] =
+    {
+        { p.x + h, p.y - h, p.z - h },
+        { p.x - h, p.y - h, p.z + h },
+        { p.x - h, p.y + h, p.z - h },
+        { p.x + h, p.y + h, p.z + h }
+    };
+    f3_t d[ 4 ];
+    distance_n( o->distance, tap, d, 4 );
+    return ( v3d_s ){ d[ 0 ] - d[ 1 ] - d[ 2 ] + d[ 3 ], -d[ 0 ] - d[ 1 ] + d[ 2 ] + d[ 3 ], -d[ 0 ] + d[ 1 ] - d[ 2 ] + d[ 3 ] };
+}
+
 f3_t obj_distance_s_ray_hit( const obj_distance_s* o, const ray_s* r, v3d_s* p_nor )
 {
     ray_s ray = *r;
@@ -918,44 +2592,32 @@ f3_t obj_distance_s_ray_hit( const obj_distance_s* o, const ray_s* r, v3d_s* p_n
     ray.d = m3d_s_mlv( &o->prp.rax, ray.d );
 
     f3_t offs1 = 0;
-    f3_t dist = distance( o->distance, ray.p );
+    f3_t dist = 0;
+    v3d_s n = v3d_s_zero();
 
-    if( dist > 0 )
+    if( o->reference )
     {
-        for( uz_t i = 0; i < o->cycles; i++ )
-        {
-            offs1 += dist + f3_eps;
-            dist = distance( o->distance, ray_s_pos( &ray, offs1 ) );
-            if( dist < 0 || dist > f3_mag ) break;
-        }
+        offs1 = obj_distance_s_march_reference( o, &ray, &dist );
+        if( f3_abs( dist ) > f3_eps ) return f3_inf;
+        if( p_nor ) n = obj_distance_s_gradient_reference( o, ray_s_pos( &ray, offs1 ) );
     }
     else
     {
-        for( uz_t i = 0; i < o->cycles; i++ )
-        {
-            offs1 -= dist - f3_eps;
-            dist = distance( o->distance, ray_s_pos( &ray, offs1 ) );
-            if( dist > 0 || dist < -f3_mag ) break;
-        }
-    }
-
-    if( f3_abs( dist ) <= f3_eps )
-    {
-        // we compute p_nor by taking the (approximate) gradient from the distance field
-        if( p_nor )
+        // the envelope limits the marching range
+        f3_t offs1_max = f3_inf;
+        if( o->prp.envelope )
         {
-            v3d_s p = ray_s_pos( &ray, offs1 );
-            f3_t d0 = distance( o->distance, p );
-            v3d_s n;
-            n.x = ( distance( o->distance, ( v3d_s ){ p.x + f3_eps, p.y, p.z } ) - d0 ) / f3_eps;
-            n.y = ( distance( o->distance, ( v3d_s ){ p.x, p.y + f3_eps, p.z } ) - d0 ) / f3_eps;
-            n.z = ( distance( o->distance, ( v3d_s ){ p.x, p.y, p.z + f3_eps } ) - d0 ) / f3_eps;
-            *p_nor = v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, n ), 1.0 );
+            f3_t a_far = v3d_s_sub_mlv( o->prp.envelope->pos, r->p, r->d ) + o->prp.envelope->radius;
+            offs1_max = ( a_far - offs0 ) * f3_abs( o->inv_scale );
         }
 
-        return offs0 + ( offs1 / o->inv_scale ) - f3_eps;
+        offs1 = obj_distance_s_march( o, &ray, offs1_max, &dist );
+        if( f3_abs( dist ) > f3_eps ) return f3_inf;
+        if( p_nor ) n = obj_distance_s_gradient( o, ray_s_pos( &ray, offs1 ) );
     }
-    return f3_inf;
+
+    if( p_nor ) *p_nor = v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, n ), 1.0 );
+    return offs0 + ( offs1 / o->inv_scale ) - f3_eps;
 }
 
 s2_t obj_distance_s_side( const obj_distance_s* o, v3d_s pos )
@@ -986,6 +2648,7 @@ typedef struct obj_pair_inside_s
     };
     vd_t o1;
     vd_t o2;
+    bl_t use_spans; // both operands provide spans (set on creation)
 } obj_pair_inside_s;
 
 static sc_t obj_pair_inside_s_def =
@@ -996,14 +2659,17 @@ static sc_t obj_pair_inside_s_def =
     "properties_s prp;"
     "aware => o1;"
     "aware => o2;"
+    "bl_t use_spans;"
 
     "func fov_fp          fov             = obj_pair_inside_s_fov;"
     "func ray_hit_fp      ray_hit         = obj_pair_inside_s_ray_hit;"
     "func side_fp         side            = obj_pair_inside_s_side;"
+    "func ray_spans_fp    ray_spans       = obj_pair_inside_s_ray_spans;"
     "func is_in_fov_fp    is_in_fov       = obj_pair_inside_s_is_in_fov;"
     "func move_fp         move            = obj_pair_inside_s_move;"
     "func rotate_fp       rotate          = obj_pair_inside_s_rotate;"
     "func scale_fp        scale           = obj_pair_inside_s_scale;"
+    "func bounds_fp       bounds          = obj_pair_inside_s_bounds;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_pair_inside_s, obj_pair_inside_s_def )
@@ -1012,6 +2678,7 @@ obj_pair_inside_s* obj_pair_inside_s_create_pair( vc_t o1, vc_t o2 )
 {
     obj_pair_inside_s* o = obj_pair_inside_s_create();
     properties_s_copy( &o->prp, &( ( obj_hdr_s* )o1 )->prp );
+    o->use_spans = obj_has_ray_spans( o1 ) && obj_has_ray_spans( o2 );
     o->o1 = bcore_inst_a_clone( o1 );
     o->o2 = bcore_inst_a_clone( o2 );
     return o;
@@ -1049,8 +2716,22 @@ bl_t obj_pair_inside_s_is_in_fov( const obj_pair_inside_s* o, const ray_cone_s*
     return obj_is_in_fov( o->o1, fov ) || obj_is_in_fov( o->o2, fov );
 }
 
+bl_t obj_pair_inside_s_ray_spans( const obj_pair_inside_s* o, const ray_s* r, spans_s* spans )
+{
+    if( !o->use_spans ) return false;
+    spans_s spans1, spans2;
+    if( !obj_ray_spans( o->o1, r, &spans1 ) ) return false;
+    if( !obj_ray_spans( o->o2, r, &spans2 ) ) return false;
+    return spans_s_intersect( &spans1, &spans2, spans );
+}
+
 f3_t obj_pair_inside_s_ray_hit( const obj_pair_inside_s* o, const ray_s* r, v3d_s* p_nor )
 {
+    // interval evaluation (one pass over both operands)
+    spans_s spans;
+    if( obj_pair_inside_s_ray_spans( o, r, &spans ) ) return spans_s_ray_hit( &spans, p_nor );
+
+    // fallback: surface walk
     v3d_s n1, n2;
     f3_t a1 = obj_ray_hit( o->o1, r, &n1 );
     f3_t a2 = obj_ray_hit( o->o2, r, &n2 );
@@ -1093,6 +2774,26 @@ f3_t obj_pair_inside_s_ray_hit( const obj_pair_inside_s* o, const ray_s* r, v3d_
     return f3_inf;
 }
 
+bl_t obj_pair_inside_s_bounds( const obj_pair_inside_s* o, envelope_s* env )
+{
+    envelope_s env1, env2;
+    bl_t bounded1 = obj_bounds( o->o1, &env1 );
+    bl_t bounded2 = obj_bounds( o->o2, &env2 );
+    if( bounded1 && bounded2 )
+    {
+        *env = envelope_of_intersection( &env1, &env2 );
+    }
+    else if( bounded1 )
+    {
+        *env = env1;
+    }
+    else if( bounded2 )
+    {
+        *env = env2;
+    }
+    return bounded1 || bounded2;
+}
+
 s2_t obj_pair_inside_s_side( const obj_pair_inside_s* o, v3d_s pos )
 {
     return ( obj_side( o->o1, pos ) + obj_side( o->o2, pos ) == -2 ) ? -1 : 1;
@@ -1136,6 +2837,7 @@ typedef struct obj_pair_outside_s
     };
     vd_t o1;
     vd_t o2;
+    bl_t use_spans; // both operands provide spans (set on creation)
 } obj_pair_outside_s;
 
 static sc_t obj_pair_outside_s_def =
@@ -1146,14 +2848,17 @@ static sc_t obj_pair_outside_s_def =
     "properties_s prp;"
     "aware => o1;"
     "aware => o2;"
+    "bl_t use_spans;"
 
     "func fov_fp          fov             = obj_pair_outside_s_fov;"
     "func ray_hit_fp      ray_hit         = obj_pair_outside_s_ray_hit;"
     "func side_fp         side            = obj_pair_outside_s_side;"
+    "func ray_spans_fp    ray_spans       = obj_pair_outside_s_ray_spans;"
     "func is_in_fov_fp    is_in_fov       = obj_pair_outside_s_is_in_fov;"
     "func move_fp         move            = obj_pair_outside_s_move;"
     "func rotate_fp       rotate          = obj_pair_outside_s_rotate;"
     "func scale_fp        scale           = obj_pair_outside_s_scale;"
+    "func bounds_fp       bounds          = obj_pair_outside_s_bounds;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_pair_outside_s, obj_pair_outside_s_def )
@@ -1162,6 +2867,7 @@ obj_pair_outside_s* obj_pair_outside_s_create_pair( vc_t o1, vc_t o2 )
 {
     obj_pair_outside_s* o = obj_pair_outside_s_create();
     properties_s_copy( &o->prp, &( ( obj_hdr_s* )o1 )->prp );
+    o->use_spans = obj_has_ray_spans( o1 ) && obj_has_ray_spans( o2 );
 
     o->o1 = bcore_inst_a_clone( o1 );
     o->o2 = bcore_inst_a_clone( o2 );
@@ -1206,8 +2912,22 @@ bl_t obj_pair_outside_s_is_in_fov( const obj_pair_outside_s* o, const ray_cone_s
     if( o->prp.envelope ) envelope_s_is_in_fov( o->prp.envelope, fov );
 }
 
+bl_t obj_pair_outside_s_ray_spans( const obj_pair_outside_s* o, const ray_s* r, spans_s* spans )
+{
+    if( !o->use_spans ) return false;
+    spans_s spans1, spans2;
+    if( !obj_ray_spans( o->o1, r, &spans1 ) ) return false;
+    if( !obj_ray_spans( o->o2, r, &spans2 ) ) return false;
+    return spans_s_unite( &spans1, &spans2, spans );
+}
+
 f3_t obj_pair_outside_s_ray_hit( const obj_pair_outside_s* o, const ray_s* r, v3d_s* p_nor )
 {
+    // interval evaluation (one pass over both operands)
+    spans_s spans;
+    if( obj_pair_outside_s_ray_spans( o, r, &spans ) ) return spans_s_ray_hit( &spans, p_nor );
+
+    // fallback: surface walk
     v3d_s n1, n2;
     f3_t a1 = obj_ray_hit( o->o1, r, &n1 );
     f3_t a2 = obj_ray_hit( o->o2, r, &n2 );
@@ -1250,6 +2970,15 @@ f3_t obj_pair_outside_s_ray_hit( const obj_pair_outside_s* o, const ray_s* r, v3
     return f3_inf;
 }
 
+bl_t obj_pair_outside_s_bounds( const obj_pair_outside_s* o, envelope_s* env )
+{
+    envelope_s env1, env2;
+    if( !obj_bounds( o->o1, &env1 ) ) return false;
+    if( !obj_bounds( o->o2, &env2 ) ) return false;
+    *env = envelope_of_pair( &env1, &env2 );
+    return true;
+}
+
 s2_t obj_pair_outside_s_side( const obj_pair_outside_s* o, v3d_s pos )
 {
     return ( obj_side( o->o1, pos ) + obj_side( o->o2, pos ) == 2 ) ? 1 : -1;
@@ -1303,7 +3032,9 @@ static sc_t obj_neg_s_def =
     "aware => o1;"
 
     "func ray_hit_fp      ray_hit         = obj_neg_s_ray_hit;"
+    "func ray_occluded_fp ray_occluded    = obj_neg_s_ray_occluded;"
     "func side_fp         side            = obj_neg_s_side;"
+    "func ray_spans_fp    ray_spans       = obj_neg_s_ray_spans;"
     "func is_in_fov_fp    is_in_fov       = obj_neg_s_is_in_fov;"
     "func move_fp         move            = obj_neg_s_move;"
     "func rotate_fp       rotate          = obj_neg_s_rotate;"
@@ -1316,6 +3047,11 @@ obj_neg_s* obj_neg_s_create_neg( vc_t o1 )
 {
     obj_neg_s* o = obj_neg_s_create();
     properties_s_copy( &o->prp, &( ( obj_hdr_s* )o1 )->prp );
+
+    // the envelope of o1 encloses the inside of o1, which is the outside of the negation
+    if( o->prp.envelope ) envelope_s_discard( o->prp.envelope );
+    o->prp.envelope = NULL;
+
     o->o1 = bcore_inst_a_clone( o1 );
     return o;
 }
@@ -1338,6 +3074,18 @@ f3_t obj_neg_s_ray_hit( const obj_neg_s* o, const ray_s* r, v3d_s* p_nor )
     return f3_inf;
 }
 
+bl_t obj_neg_s_ray_occluded( const obj_neg_s* o, const ray_s* r, f3_t max_dist )
+{
+    return obj_ray_occluded( o->o1, r, max_dist );
+}
+
+bl_t obj_neg_s_ray_spans( const obj_neg_s* o, const ray_s* r, spans_s* spans )
+{
+    spans_s spans1;
+    if( !obj_ray_spans( o->o1, r, &spans1 ) ) return false;
+    return spans_s_invert( &spans1, spans );
+}
+
 s2_t obj_neg_s_side( const obj_neg_s* o, v3d_s pos )
 {
     return -1 * obj_side( o->o1, pos );
@@ -1377,10 +3125,13 @@ static sc_t obj_scale_s_def =
 
     "func ap_t            init            = obj_scale_s_init_a;"
     "func ray_hit_fp      ray_hit         = obj_scale_s_ray_hit;"
+    "func ray_occluded_fp ray_occluded    = obj_scale_s_ray_occluded;"
     "func side_fp         side            = obj_scale_s_side;"
+    "func ray_spans_fp    ray_spans       = obj_scale_s_ray_spans;"
     "func move_fp         move            = obj_scale_s_move;"
     "func rotate_fp       rotate          = obj_scale_s_rotate;"
     "func scale_fp        scale           = obj_scale_s_scale;"
+    "func bounds_fp       bounds          = obj_scale_s_bounds;"
 "}";
 
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST( obj_scale_s, obj_scale_s_def )
@@ -1393,11 +3144,7 @@ obj_scale_s* obj_scale_s_create_scale( vc_t o1, v3d_s scale )
     o->prp.pos = v3d_s_zero();
     o->prp.rax = m3d_s_ident();
 
-    if( o->prp.envelope )
-    {
-        o->prp.envelope->pos = v3d_s_mld( o->prp.envelope->pos, scale );
-        o->prp.envelope->radius *= v3d_s_max( scale );
-    }
+    if( o->prp.envelope ) envelope_s_scale_axes( o->prp.envelope, scale );
 
     o->o1 = bcore_inst_a_clone( o1 );
     o->inv_scale.x = ( scale.x != 0 ) ? ( 1.0 / scale.x ) : 1.0;
@@ -1436,6 +3183,69 @@ f3_t obj_scale_s_ray_hit( const obj_scale_s* o, const ray_s* r, v3d_s* p_nor )
     return f3_inf;
 }
 
+bl_t obj_scale_s_ray_occluded( const obj_scale_s* o, const ray_s* r, f3_t max_dist )
+{
+    ray_s ray;
+    ray.p = v3d_s_mld( m3d_s_mlv( &o->prp.rax, v3d_s_sub( r->p, o->prp.pos ) ), o->inv_scale );
+    ray.d = v3d_s_mld( m3d_s_mlv( &o->prp.rax, r->d ), o->inv_scale );
+
+    f3_t d_length = sqrt( v3d_s_sqr( ray.d ) );
+    f3_t d_factor = ( d_length > 0 ) ? ( 1.0 / d_length ) : 0;
+    ray.d = v3d_s_mlf( ray.d, d_factor );
+
+    // inverse of the offset mapping in obj_scale_s_ray_hit
+    return obj_ray_occluded( o->o1, &ray, ( max_dist + f3_eps ) * d_length - f3_eps );
+}
+
+bl_t obj_scale_s_bounds( const obj_scale_s* o, envelope_s* env )
+{
+    envelope_s env1;
+    if( !obj_bounds( o->o1, &env1 ) ) return false;
+
+    v3d_s scale;
+    scale.x = f3_abs( 1.0 / o->inv_scale.x );
+    scale.y = f3_abs( 1.0 / o->inv_scale.y );
+    scale.z = f3_abs( 1.0 / o->inv_scale.z );
+
+    // candidates in the local frame
+    envelope_s env_sph = envelope_create( env1.pos, env1.radius );
+    envelope_s env_box = envelope_of_box( envelope_s_get_box( &env1 ) );
+    envelope_s_scale_axes( &env_sph, scale );
+    envelope_s_scale_axes( &env_box, scale );
+    *env = envelope_min_area( &env_sph, &env_box );
+
+    // local frame -> world
+    m3d_s mat = m3d_s_transposed( o->prp.rax );
+    envelope_s_rotate( env, &mat );
+    envelope_s_move( env, &o->prp.pos );
+    return true;
+}
+
+bl_t obj_scale_s_ray_spans( const obj_scale_s* o, const ray_s* r, spans_s* spans )
+{
+    ray_s ray;
+    ray.p = v3d_s_mld( m3d_s_mlv( &o->prp.rax, v3d_s_sub( r->p, o->prp.pos ) ), o->inv_scale );
+    ray.d = v3d_s_mld( m3d_s_mlv( &o->prp.rax, r->d ), o->inv_scale );
+
+    f3_t d_length = sqrt( v3d_s_sqr( ray.d ) );
+    if( d_length == 0 ) return false;
+    f3_t d_factor = 1.0 / d_length;
+    ray.d = v3d_s_mlf( ray.d, d_factor );
+
+    if( !obj_ray_spans( o->o1, &ray, spans ) ) return false;
+
+    // local frame -> world
+    for( uz_t i = 0; i < spans->size; i++ )
+    {
+        span_s* s = &spans->data[ i ];
+        s->a0 *= d_factor;
+        s->a1 *= d_factor;
+        s->n0 = v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, v3d_s_mld( s->n0, o->inv_scale ) ), 1.0 );
+        s->n1 = v3d_s_of_length( m3d_s_tmlv( &o->prp.rax, v3d_s_mld( s->n1, o->inv_scale ) ), 1.0 );
+    }
+    return true;
+}
+
 s2_t obj_scale_s_side( const obj_scale_s* o, v3d_s pos )
 {
     v3d_s p = m3d_s_mlv( &o->prp.rax, v3d_s_sub( pos, o->prp.pos ) );
@@ -1460,6 +3270,38 @@ void obj_scale_s_scale( obj_scale_s* o, f3_t fac )
 
 /**********************************************************************************************************************/
 
+bl_t obj_has_ray_spans( vc_t o )
+{
+    const obj_hdr_s* hdr = o;
+    if( !hdr->p->fp_ray_spans ) return false;
+    switch( *( aware_t* )o )
+    {
+        case TYPEOF_obj_pair_inside_s:  return ( ( const obj_pair_inside_s*  )o )->use_spans;
+        case TYPEOF_obj_pair_outside_s: return ( ( const obj_pair_outside_s* )o )->use_spans;
+        case TYPEOF_obj_neg_s:          return obj_has_ray_spans( ( ( const obj_neg_s*   )o )->o1 );
+        case TYPEOF_obj_scale_s:        return obj_has_ray_spans( ( ( const obj_scale_s* )o )->o1 );
+        case TYPEOF_obj_squaroid_s:     return !( ( const obj_squaroid_s* )o )->clip || ( ( const obj_squaroid_s* )o )->caps;
+        default: break;
+    }
+    return true;
+}
+
+void obj_bake( vd_t o, uz_t threads )
+{
+    switch( *( aware_t* )o )
+    {
+        case TYPEOF_obj_distance_s:     obj_distance_s_bake( o, threads ); break;
+        case TYPEOF_obj_sphere_cloud_s: obj_sphere_cloud_s_prepare( o ); break;
+        case TYPEOF_obj_pair_inside_s:  obj_bake( ( ( obj_pair_inside_s*  )o )->o1, threads ); obj_bake( ( ( obj_pair_inside_s*  )o )->o2, threads ); break;
+        case TYPEOF_obj_pair_outside_s: obj_bake( ( ( obj_pair_outside_s* )o )->o1, threads ); obj_bake( ( ( obj_pair_outside_s* )o )->o2, threads ); break;
+        case TYPEOF_obj_neg_s:          obj_bake( ( ( obj_neg_s*   )o )->o1, threads ); break;
+        case TYPEOF_obj_scale_s:        obj_bake( ( ( obj_scale_s* )o )->o1, threads ); break;
+        default: break;
+    }
+}
+
+/**********************************************************************************************************************/
+
 sr_s obj_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
 {
     assert( bcore_trait_is_of( sr_s_type( sr_o ), TYPEOF_spect_obj ) );
@@ -1525,14 +3367,12 @@ sr_s obj_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         }
         else if( sr_s_type( &v ) == TYPEOF_obj_sphere_s )
         {
-            envelope_s env;
-            env.pos = ( ( obj_sphere_s* )v.o )->prp.pos;
-            env.radius = ( ( obj_sphere_s* )v.o )->radius;
+            envelope_s env = envelope_create( ( ( obj_sphere_s* )v.o )->prp.pos, ( ( obj_sphere_s* )v.o )->radius );
             obj_set_envelope( sr_o->o, &env );
         }
         else
         {
-            meval_s_err_fa( ev, "Object '#<sc_t>' cannot be used as envelope (use a sphere).", ifnameof( sr_s_type( &v ) ) );
+            meval_s_err_fa( ev, "Object '#<sc_t>' cannot be used as envelope (use a sphere or an envelope).", ifnameof( sr_s_type( &v ) ) );
         }
 
         sr_down( v );
@@ -1688,6 +3528,64 @@ sr_s obj_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         sr_down( v );
         meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
     }
+    else if( key == typeof( "clip_z" ) || key == typeof( "clip_z_open" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_squaroid_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_squaroid_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        f3_t z0 = meval_s_eval_f3( ev );
+        meval_s_expect_code( ev, CL_COMMA );
+        f3_t z1 = meval_s_eval_f3( ev );
+        obj_squaroid_s_set_clip( sr_o->o, z0, z1, key == typeof( "clip_z" ) );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == typeof( "push_sphere" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_sphere_cloud_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_sphere_cloud_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        v3d_s pos = meval_s_eval_v3d( ev );
+        meval_s_expect_code( ev, CL_COMMA );
+        f3_t radius = meval_s_eval_f3( ev );
+        obj_sphere_cloud_s_push_sphere( sr_o->o, pos, radius );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == typeof( "set_lipschitz" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_distance_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_distance_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        obj_distance_s_set_lipschitz( sr_o->o, meval_s_eval_f3( ev ) );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == typeof( "set_reference_marcher" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_distance_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_distance_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        obj_distance_s_set_reference( sr_o->o, meval_s_eval_bl( ev ) );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == typeof( "set_bake_resolution" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_distance_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_distance_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        obj_distance_s* o = sr_o->o;
+        f3_t resolution = meval_s_eval_f3( ev );
+        if( !( resolution > 0 && resolution <= OBJ_DISTANCE_MAX_BAKE_RESOLUTION ) ) // also rejects nan and inf
+        {
+            meval_s_err_fa( ev, "set_bake_resolution: Resolution must be in ( 0, #<uz_t> ].", ( uz_t )OBJ_DISTANCE_MAX_BAKE_RESOLUTION );
+        }
+        obj_distance_s_set_bake( o, resolution < 1 ? 1 : resolution, o->bake_folder ? o->bake_folder->sc : NULL );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
+    else if( key == typeof( "set_bake_folder" ) )
+    {
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
+        if( sr_s_type( sr_o ) != TYPEOF_obj_distance_s ) meval_s_err_fa( ev, "Object '#<sc_t>' must be 'obj_distance_s'.", ifnameof( sr_s_type( sr_o ) ) );
+        obj_distance_s* o = sr_o->o;
+        sr_s st = meval_s_eval( ev, sr_null() );
+        if( sr_s_type( &st ) != TYPEOF_st_s ) meval_s_err_fa( ev, "String expected." );
+        obj_distance_s_set_bake( o, o->bake_resolution, ( ( st_s* )st.o )->sc );
+        sr_down( st );
+        meval_s_expect_code( ev, CL_ROUND_BRACKET_CLOSE );
+    }
     else if( key == typeof( "set_distance_function" ) )
     {
         meval_s_expect_code( ev, CL_ROUND_BRACKET_OPEN  );
@@ -1698,7 +3596,7 @@ sr_s obj_meval_key( sr_s* sr_o, meval_s* ev, tp_t key )
         if( bcore_trait_is_of( sr_s_type( &v ), typeof( "distance" ) ) )
         {
             bcore_inst_a_discard( o->distance );
-            o->distance = bcore_inst_a_clone( v.o );
+            obj_distance_s_set_distance( o, v.o );
         }
         else
         {
@@ -1728,6 +3626,7 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
 
             BCORE_REGISTER_FEATURE( projection_fp );
             BCORE_REGISTER_FEATURE( ray_hit_fp );
+            BCORE_REGISTER_FEATURE( ray_occluded_fp );
             BCORE_REGISTER_FEATURE( side_fp );
             BCORE_REGISTER_FEATURE( fov_fp );
             BCORE_REGISTER_FEATURE( is_in_fov_fp );
@@ -1735,6 +3634,8 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_FEATURE( move_fp );
             BCORE_REGISTER_FEATURE( rotate_fp );
             BCORE_REGISTER_FEATURE( scale_fp );
+            BCORE_REGISTER_FEATURE( bounds_fp );
+            BCORE_REGISTER_FEATURE( ray_spans_fp );
 
             BCORE_REGISTER_OBJECT( envelope_s );
             BCORE_REGISTER_OBJECT( properties_s );
@@ -1748,10 +3649,22 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_FUNC(  obj_plane_s_ray_hit );
             BCORE_REGISTER_FUNC(  obj_plane_s_side );
             BCORE_REGISTER_FUNC(  obj_plane_s_is_in_fov );
+            BCORE_REGISTER_FUNC(  obj_plane_s_ray_spans );
             BCORE_REGISTER_FUNC(  obj_plane_s_move );
             BCORE_REGISTER_FUNC(  obj_plane_s_rotate );
             BCORE_REGISTER_FUNC(  obj_plane_s_scale );
 
+            BCORE_REGISTER_OBJECT( half_space_s );
+            BCORE_REGISTER_OBJECT( obj_polyhedron_s );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_fov );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_side );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_ray_spans );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_move );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_rotate );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_scale );
+            BCORE_REGISTER_FUNC(  obj_polyhedron_s_bounds );
+
             BCORE_REGISTER_OBJECT( obj_sphere_s );
             BCORE_REGISTER_FUNC(  obj_sphere_s_projection );
             BCORE_REGISTER_FUNC(  obj_sphere_s_fov );
@@ -1762,13 +3675,57 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_FUNC(  obj_sphere_s_move );
             BCORE_REGISTER_FUNC(  obj_sphere_s_rotate );
             BCORE_REGISTER_FUNC(  obj_sphere_s_scale );
+            BCORE_REGISTER_FUNC(  obj_sphere_s_bounds );
+            BCORE_REGISTER_FUNC(  obj_sphere_s_ray_spans );
 
             BCORE_REGISTER_OBJECT( obj_squaroid_s );
+            BCORE_REGISTER_FUNC(  obj_squaroid_s_init_a );
             BCORE_REGISTER_FUNC(  obj_squaroid_s_ray_hit );
             BCORE_REGISTER_FUNC(  obj_squaroid_s_side );
             BCORE_REGISTER_FUNC(  obj_squaroid_s_move );
             BCORE_REGISTER_FUNC(  obj_squaroid_s_rotate );
             BCORE_REGISTER_FUNC(  obj_squaroid_s_scale );
+            BCORE_REGISTER_FUNC(  obj_squaroid_s_bounds );
+            BCORE_REGISTER_FUNC(  obj_squaroid_s_ray_spans );
+
+            BCORE_REGISTER_OBJECT( obj_torus_s );
+            BCORE_REGISTER_FUNC(  obj_torus_s_projection );
+            BCORE_REGISTER_FUNC(  obj_torus_s_fov );
+            BCORE_REGISTER_FUNC(  obj_torus_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_torus_s_side );
+            BCORE_REGISTER_FUNC(  obj_torus_s_is_in_fov );
+            BCORE_REGISTER_FUNC(  obj_torus_s_is_reachable );
+            BCORE_REGISTER_FUNC(  obj_torus_s_move );
+            BCORE_REGISTER_FUNC(  obj_torus_s_rotate );
+            BCORE_REGISTER_FUNC(  obj_torus_s_scale );
+            BCORE_REGISTER_FUNC(  obj_torus_s_bounds );
+            BCORE_REGISTER_FUNC(  obj_torus_s_ray_spans );
+
+            BCORE_REGISTER_OBJECT( obj_mesh_s );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_projection );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_fov );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_side );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_is_in_fov );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_is_reachable );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_move );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_rotate );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_scale );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_bounds );
+            BCORE_REGISTER_FUNC(  obj_mesh_s_ray_spans );
+
+            BCORE_REGISTER_OBJECT( obj_sphere_cloud_s );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_projection );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_fov );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_ray_occluded );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_side );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_is_in_fov );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_is_reachable );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_move );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_rotate );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_scale );
+            BCORE_REGISTER_FUNC(  obj_sphere_cloud_s_bounds );
 
             BCORE_REGISTER_OBJECT( obj_distance_s );
             BCORE_REGISTER_FUNC(  obj_distance_s_projection );
@@ -1783,23 +3740,29 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_fov );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_ray_hit );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_side );
+            BCORE_REGISTER_FUNC(  obj_pair_inside_s_ray_spans );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_is_in_fov );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_move );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_rotate );
             BCORE_REGISTER_FUNC(  obj_pair_inside_s_scale );
+            BCORE_REGISTER_FUNC(  obj_pair_inside_s_bounds );
 
             BCORE_REGISTER_OBJECT( obj_pair_outside_s );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_fov );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_ray_hit );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_side );
+            BCORE_REGISTER_FUNC(  obj_pair_outside_s_ray_spans );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_is_in_fov );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_move );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_rotate );
             BCORE_REGISTER_FUNC(  obj_pair_outside_s_scale );
+            BCORE_REGISTER_FUNC(  obj_pair_outside_s_bounds );
 
             BCORE_REGISTER_OBJECT( obj_neg_s );
             BCORE_REGISTER_FUNC(  obj_neg_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_neg_s_ray_occluded );
             BCORE_REGISTER_FUNC(  obj_neg_s_side );
+            BCORE_REGISTER_FUNC(  obj_neg_s_ray_spans );
             BCORE_REGISTER_FUNC(  obj_neg_s_is_in_fov );
             BCORE_REGISTER_FUNC(  obj_neg_s_move );
             BCORE_REGISTER_FUNC(  obj_neg_s_rotate );
@@ -1808,10 +3771,13 @@ vd_t objects_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_OBJECT( obj_scale_s );
             BCORE_REGISTER_FUNC(  obj_scale_s_init_a );
             BCORE_REGISTER_FUNC(  obj_scale_s_ray_hit );
+            BCORE_REGISTER_FUNC(  obj_scale_s_ray_occluded );
             BCORE_REGISTER_FUNC(  obj_scale_s_side );
+            BCORE_REGISTER_FUNC(  obj_scale_s_ray_spans );
             BCORE_REGISTER_FUNC(  obj_scale_s_move );
             BCORE_REGISTER_FUNC(  obj_scale_s_rotate );
             BCORE_REGISTER_FUNC(  obj_scale_s_scale );
+            BCORE_REGISTER_FUNC(  obj_scale_s_bounds );
         }
         break;
 
@@ -25,12 +25,18 @@
 #include "quicktypes.h"
 
 /**********************************************************************************************************************/
-/// envelope_s  (sphere used to define object boundaries)
+/// envelope_s  (sphere or box used to define object boundaries)
+/** A box envelope is oriented by rax (rows: box axes); rax = identity defines an axis aligned box.
+ *  'radius' is always a valid bounding sphere radius around pos (also for boxes).
+ */
 #define TYPEOF_envelope_s typeof( "envelope_s" )
 typedef struct envelope_s
 {
     v3d_s pos;
     f3_t radius;
+    bl_t box;   // true: envelope is the box given by ext and rax
+    v3d_s ext;  // half-extents of box
+    m3d_s rax;  // orientation of box
 } envelope_s;
 
 BCORE_DECLARE_FUNCTIONS_OBJ( envelope_s )
@@ -38,13 +44,24 @@ BCORE_DECLARE_FUNCTIONS_OBJ( envelope_s )
 void envelope_s_move(           envelope_s* o, const v3d_s* vec );
 void envelope_s_rotate(         envelope_s* o, const m3d_s* mat );
 void envelope_s_scale(          envelope_s* o, f3_t fac );
+void envelope_s_scale_axes(     envelope_s* o, v3d_s scale ); // conservative for non-uniform scaling
 bl_t envelope_s_ray_hits( const envelope_s* o, const ray_s* r );
 f3_t envelope_s_ray_hit(  const envelope_s* o, const ray_s* r );
 s3_t envelope_s_side(     const envelope_s* o, v3d_s pos );
+f3_t envelope_s_area(     const envelope_s* o ); // surface area
+box_s envelope_s_get_box( const envelope_s* o ); // enclosing axis aligned box
 
 envelope_s envelope_create( v3d_s pos, f3_t radius );
+envelope_s envelope_create_box( v3d_s min, v3d_s max );                  // axis aligned box
+envelope_s envelope_create_obb( v3d_s pos, v3d_s ext, const m3d_s* rax ); // oriented box
+envelope_s envelope_of_box( box_s box );
+
+/// envelope enclosing both envelopes (sphere or box, whichever has the smaller surface)
 envelope_s envelope_of_pair( const envelope_s* env1, const envelope_s* env2 );
 
+/// envelope enclosing the intersection of both envelopes
+envelope_s envelope_of_intersection( const envelope_s* env1, const envelope_s* env2 );
+
 /**********************************************************************************************************************/
 /// properties_s  (object's properties)
 
@@ -122,10 +139,50 @@ bl_t obj_is_reachable( vc_t o, const ray_s* ray_field, f3_t length );
 /// returns object's hit position (offset) or f3_inf if not hit.
 f3_t obj_ray_hit( vc_t o, const ray_s* ray, v3d_s* p_nor );
 
-/// returns object's exit position on ray (latest hit where ray exits object); f3_inf if no such position
+/// returns true when the object is hit at an offset <= max_dist (any-hit query; no normal computation)
+bl_t obj_ray_occluded( vc_t o, const ray_s* ray, f3_t max_dist );
+
+/** returns object's exit position on ray (latest hit where ray exits object); f3_inf if no such position
+ *  Uses obj_ray_spans where available, otherwise the envelope or (unbounded objects) a walk over all surfaces.
+ */
 f3_t obj_ray_exit( vc_t o, const ray_s* ray, v3d_s* p_nor );
 
-/// estimates an envelope for given object via random ray-casting
+/** Computes an envelope enclosing the object's inside area (analytic where possible; no sampling).
+ *  Returns false if the object is unbounded or its bounds are unknown.
+ */
+bl_t obj_bounds( vc_t o, envelope_s* env );
+
+/// maximum number of spans in spans_s
+#define SPANS_MAX 16
+
+/// interval of a ray inside an object
+typedef struct span_s
+{
+    f3_t a0, a1;  // entry and exit offset (a0 < a1); -f3_inf, f3_inf for an unbounded interval
+    v3d_s n0, n1; // outward surface normals at entry and exit
+} span_s;
+
+/// ascending list of disjoint intervals; intervals ending at offsets <= 0 may be omitted
+typedef struct spans_s
+{
+    uz_t size;
+    span_s data[ SPANS_MAX ];
+} spans_s;
+
+/** Computes all intervals where the ray is inside the object (exact surface offsets; no f3_eps correction).
+ *  Returns false when the object (or one of its operands) provides no spans or the list would exceed SPANS_MAX.
+ */
+bl_t obj_ray_spans( vc_t o, const ray_s* ray, spans_s* spans );
+
+/// true when obj_ray_spans is implemented for the object and all of its operands
+bl_t obj_has_ray_spans( vc_t o );
+
+/** scene preparation: bakes distance objects (including operands) that requested it (see obj_distance_s_set_bake);
+ *  builds the hierarchy of sphere clouds
+ */
+void obj_bake( vd_t o, uz_t threads );
+
+/// estimates an envelope for given object via random ray-casting (radius f3_mag if no ray exits the object)
 envelope_s obj_estimate_envelope( vc_t o, uz_t samples, u2_t rseed, f3_t radius_factor );
 
 /// return 1 when pos is outside object, -1 otherwise
@@ -143,7 +200,8 @@ void obj_set_refractive_index( vd_t o, f3_t val );
 void obj_set_radiance        ( vd_t o, f3_t val );
 void obj_set_texture_field   ( vd_t o, vc_t texture_field );
 void obj_set_envelope        ( vd_t obj, const envelope_s* env );
-void obj_set_auto_envelope   ( vd_t obj ); // estimates envelope for object (overwrites existing envelope)
+void obj_set_auto_envelope   ( vd_t obj ); // sets envelope from object bounds or by sampling (overwrites existing envelope; removes it if unbounded)
+bl_t obj_auto_envelope       ( vc_t obj, envelope_s* env ); // envelope obj_set_auto_envelope would set (ignores existing envelope); false if unbounded
 
 /**********************************************************************************************************************/
 /// obj_plane_s
@@ -151,6 +209,24 @@ void obj_set_auto_envelope   ( vd_t obj ); // estimates envelope for object (ove
 typedef struct obj_plane_s obj_plane_s;
 BCORE_DECLARE_FUNCTIONS_OBJ( obj_plane_s )
 
+/**********************************************************************************************************************/
+/// obj_polyhedron_s  (convex polyhedron: intersection of half-spaces)
+
+typedef struct half_space_s half_space_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( half_space_s )
+
+typedef struct obj_polyhedron_s obj_polyhedron_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( obj_polyhedron_s )
+
+/// adds the inside half-space of a plane through pos with outward normal nor
+void obj_polyhedron_s_push_plane( obj_polyhedron_s* o, v3d_s pos, v3d_s nor );
+
+/// true for planes and polyhedra without envelope (these can be merged into a polyhedron)
+bl_t obj_polyhedron_s_is_mergeable( vc_t o );
+
+/// polyhedron equivalent to obj_pair_inside_s of two mergeable objects; properties are taken from o1
+obj_polyhedron_s* obj_polyhedron_s_create_pair( vc_t o1, vc_t o2 );
+
 /**********************************************************************************************************************/
 /// obj_sphere_s
 
@@ -168,6 +244,9 @@ BCORE_DECLARE_FUNCTIONS_OBJ( obj_squaroid_s )
 
 void obj_squaroid_s_set_param( obj_squaroid_s* o, f3_t a, f3_t b, f3_t c, f3_t r );
 
+/// restricts the surface to the local z-range z0 ... z1; caps: closes the surface at z0 and z1
+void obj_squaroid_s_set_clip( obj_squaroid_s* o, f3_t z0, f3_t z1, bl_t caps );
+
 obj_squaroid_s* obj_squaroid_s_create_squaroid(     f3_t a,  f3_t b,  f3_t c, f3_t r );
 obj_squaroid_s* obj_squaroid_s_create_ellipsoid(    f3_t rx, f3_t ry, f3_t rz ); // with envelope
 obj_squaroid_s* obj_squaroid_s_create_hyperboloid1( f3_t rx, f3_t ry, f3_t rz ); // 1-sheet (ellipse at z=0)
@@ -175,6 +254,34 @@ obj_squaroid_s* obj_squaroid_s_create_hyperboloid2( f3_t rx, f3_t ry, f3_t rz );
 obj_squaroid_s* obj_squaroid_s_create_cone(         f3_t rx, f3_t ry, f3_t rz ); // ellipse at z/rz=1
 obj_squaroid_s* obj_squaroid_s_create_cylinder(     f3_t rx, f3_t ry          ); // ellipse at perpendicular section
 
+/**********************************************************************************************************************/
+/// obj_torus_s  (analytic torus around the local z-axis)
+
+typedef struct obj_torus_s obj_torus_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( obj_torus_s )
+
+void obj_torus_s_set_radii( obj_torus_s* o, f3_t radius1, f3_t radius2 ); // radius1: center of tube to axis; radius2: tube
+
+obj_torus_s* obj_torus_s_create_torus( f3_t radius1, f3_t radius2 );
+
+/**********************************************************************************************************************/
+/// obj_mesh_s  (triangle mesh; see mesh_s)
+
+typedef struct obj_mesh_s obj_mesh_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( obj_mesh_s )
+
+/// loads mesh from a .obj, .ply or binary mesh file (see mesh.h)
+obj_mesh_s* obj_mesh_s_create_mesh( sc_t file );
+
+/**********************************************************************************************************************/
+/// obj_sphere_cloud_s  (many spheres of identical properties; see sphere_cloud_s)
+
+typedef struct obj_sphere_cloud_s obj_sphere_cloud_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( obj_sphere_cloud_s )
+
+void obj_sphere_cloud_s_push_sphere( obj_sphere_cloud_s* o, v3d_s pos, f3_t radius ); // pos: global frame
+void obj_sphere_cloud_s_prepare(     obj_sphere_cloud_s* o ); // builds hierarchy (also done by obj_bake)
+
 /**********************************************************************************************************************/
 /// obj_distance_s
 
@@ -183,6 +290,20 @@ BCORE_DECLARE_FUNCTIONS_OBJ( obj_distance_s )
 
 void obj_distance_s_set_distance( obj_distance_s* o, vc_t distance );
 void obj_distance_s_set_cycles( obj_distance_s* o, uz_t cycles );
+void obj_distance_s_set_lipschitz( obj_distance_s* o, f3_t lipschitz ); // upper bound of the gradient magnitude (default 1)
+void obj_distance_s_set_reference( obj_distance_s* o, bl_t reference );  // true: plain sphere tracing (reference mode)
+
+/** Opt-in baking of the distance function into a sparse cache (distance_cache_s) inside the envelope.
+ *  resolution: cells per envelope diameter (0: no baking); folder: location of cached bakes (NULL: no disk cache).
+ *  Cached bakes are identified by the fingerprint of distance function and bake parameters.
+ */
+void obj_distance_s_set_bake( obj_distance_s* o, uz_t resolution, sc_t folder );
+
+/// largest bake resolution accepted by scripts (the brick center array grows with its cube)
+#define OBJ_DISTANCE_MAX_BAKE_RESOLUTION 2048
+
+/// bakes the distance function if requested and not yet baked
+void obj_distance_s_bake( obj_distance_s* o, uz_t threads );
 
 /**********************************************************************************************************************/
 /// obj_pair_inside_s  (combination of two objects)
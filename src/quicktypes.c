@@ -45,17 +45,24 @@ static sr_s typelist()
     bcore_array_r_push_sc( &list, "scene_s" );
     bcore_array_r_push_sc( &list, "spect_obj_s" );
     bcore_array_r_push_sc( &list, "spect_obj" );
+    bcore_array_r_push_sc( &list, "half_space_s" );
     bcore_array_r_push_sc( &list, "obj_plane_s" );
+    bcore_array_r_push_sc( &list, "obj_polyhedron_s" );
     bcore_array_r_push_sc( &list, "obj_sphere_s" );
     bcore_array_r_push_sc( &list, "obj_squaroid_s" );
+    bcore_array_r_push_sc( &list, "obj_torus_s" );
+    bcore_array_r_push_sc( &list, "obj_mesh_s" );
+    bcore_array_r_push_sc( &list, "obj_sphere_cloud_s" );
     bcore_array_r_push_sc( &list, "obj_distance_s" );
     bcore_array_r_push_sc( &list, "obj_pair_inside_s" );
     bcore_array_r_push_sc( &list, "obj_pair_outside_s" );
     bcore_array_r_push_sc( &list, "obj_neg_s" );
     bcore_array_r_push_sc( &list, "obj_scale_s" );
+    bcore_array_r_push_sc( &list, "distance_cache_s" );
 
     bcore_array_r_push_sc( &list, "properties_s" );
     bcore_array_r_push_sc( &list, "compound_s" );
+    bcore_array_r_push_sc( &list, "instance_s" );
     bcore_array_r_push_sc( &list, "meval_s" );
     bcore_array_r_push_sc( &list, "mclosure_s" );
     bcore_array_r_push_sc( &list, "arr_s" );
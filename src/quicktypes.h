@@ -35,16 +35,23 @@ void quicktypes_to_stdout( tp_t (*hash)( sc_t name ) );
 #define TYPEOF_scene_s 0x4004287ACF60A435ull
 #define TYPEOF_spect_obj_s 0x0D7850F1CE75B7A2ull
 #define TYPEOF_spect_obj 0x107E819E5675C418ull
+#define TYPEOF_half_space_s 0x2C6B7C9B98FF74CBull
 #define TYPEOF_obj_plane_s 0x3CA9D7EF68D58921ull
+#define TYPEOF_obj_polyhedron_s 0x0904FEFC00C033A7ull
 #define TYPEOF_obj_sphere_s 0x1B66B59BF27F6AF4ull
 #define TYPEOF_obj_squaroid_s 0x1C09C98B1CC4819Dull
+#define TYPEOF_obj_torus_s 0x0CE48B47B54D378Eull
+#define TYPEOF_obj_mesh_s 0x32540BBF7A1A4A4Cull
+#define TYPEOF_obj_sphere_cloud_s 0x329F2D0873312BCEull
 #define TYPEOF_obj_distance_s 0x4512317AA9CB8D82ull
 #define TYPEOF_obj_pair_inside_s 0xBB012DBE14809C26ull
 #define TYPEOF_obj_pair_outside_s 0xBF9443641B89C009ull
 #define TYPEOF_obj_neg_s 0x3FE037BB5EE2BAB9ull
 #define TYPEOF_obj_scale_s 0x98B7FDE98C7910C9ull
+#define TYPEOF_distance_cache_s 0xD81091F030E67A8Dull
 #define TYPEOF_properties_s 0xBF0C82AF7675A3BEull
 #define TYPEOF_compound_s 0x13D78EFEE85438FEull
+#define TYPEOF_instance_s 0x3B2460D14BE4B4ECull
 #define TYPEOF_meval_s 0xDA4D919A7E8B2860ull
 #define TYPEOF_mclosure_s 0x1994E566CD0CBBCFull
 #define TYPEOF_arr_s 0x4FCE12B634EFD082ull
@@ -150,6 +150,22 @@ tp_t image_cps_s_hash( const image_cps_s* o )
 /**********************************************************************************************************************/
 /// scene_s
 
+/// integrators (scene_s: integrator)
+enum
+{
+    SCENE_INTEGRATOR_RECURSIVE = 0, // branches into all lobes at each surface (scene_s_lum)
+    SCENE_INTEGRATOR_ITERATIVE = 1, // follows one stochastically chosen lobe per surface (scene_s_path_lum)
+    SCENE_INTEGRATOR_WAVEFRONT = 2, // iterative estimator; paths are processed in batches, stage by stage (lum_wavefront_s)
+};
+
+/// multiple importance sampling heuristics (scene_s: mis_heuristic)
+enum
+{
+    SCENE_MIS_NONE    = 0, // light sources are reached by light sampling only
+    SCENE_MIS_BALANCE = 1,
+    SCENE_MIS_POWER   = 2, // power heuristic with exponent 2
+};
+
 typedef struct scene_s
 {
     aware_t _;
@@ -175,6 +191,13 @@ typedef struct scene_s
     uz_t path_samples;
     f3_t max_path_length;  // path rays longer than max_path_length obtain background color (only for path tracing; does not apply to reflection)
 
+    uz_t integrator;         // SCENE_INTEGRATOR_...
+    uz_t integrator_samples; // paths per camera ray (iterative integrator)
+    uz_t wavefront_size;     // paths per batch (wavefront integrator)
+    uz_t roulette_depth;     // > 0: russian roulette after roulette_depth bounces (iterative and wavefront integrator)
+    uz_t mis_heuristic;      // SCENE_MIS_...
+    bl_t light_selection;    // direct light samples are distributed among light sources by importance
+
     compound_s* light;  // light sources
     compound_s* matter; // passive objects
 
@@ -206,6 +229,13 @@ static sc_t scene_s_def =
     "uz_t path_samples        = 0;"  // requires trace_depth > 10
     "f3_t max_path_length     = 1E+30;"  // path rays longer than max_path_length obtain background color
 
+    "uz_t integrator          = 0;"  // 0: recursive (scene_s_lum); 1: iterative (scene_s_path_lum); 2: wavefront
+    "uz_t integrator_samples  = 16;" // paths per camera ray (iterative and wavefront integrator)
+    "uz_t wavefront_size      = 65536;" // paths per batch (wavefront integrator)
+    "uz_t roulette_depth      = 0;"  // > 0: russian roulette after roulette_depth bounces; replaces trace_min_intensity (iterative and wavefront integrator)
+    "uz_t mis_heuristic       = 0;"  // 0: none; 1: balance; 2: power; combines light sampling and path sampling at diffuse surfaces
+    "bl_t light_selection     = false;" // true: direct_samples is the budget of all light sources, distributed by importance
+
     "compound_s => light;"
     "compound_s => matter;"
 
@@ -250,7 +280,7 @@ uz_t scene_s_push( scene_s* o, const sr_s* object )
         }
         return 1;
     }
-    else if( type == TYPEOF_compound_s )
+    else if( type == TYPEOF_compound_s || type == TYPEOF_instance_s )
     {
         compound_s_push_q( o->matter, object );
     }
@@ -359,10 +389,12 @@ f3_t scene_s_hit( const scene_s* o, const ray_s* r, v3d_s* p_nor, vc_t* hit_obj
 
 //----------------------------------------------------------------------------------------------------------------------
 
-f3_t scene_s_trans_hit( const scene_s* o, const ray_s* r, trans_data_s* trans )
+/// p_light (optional): true when the hit belongs to o->light
+f3_t scene_s_trans_hit( const scene_s* o, const ray_s* r, trans_data_s* trans, bl_t* p_light )
 {
     f3_t min_a = f3_inf;
     f3_t a;
+    bl_t light = false;
 
     trans_data_s trans_l;
 
@@ -370,14 +402,17 @@ f3_t scene_s_trans_hit( const scene_s* o, const ray_s* r, trans_data_s* trans )
     {
         min_a = a;
         *trans = trans_l;
+        light = true;
     }
 
     if( ( a = compound_s_ray_trans_hit( o->matter, r, &trans_l ) ) < min_a )
     {
         min_a = a;
         *trans = trans_l;
+        light = false;
     }
 
+    if( p_light ) *p_light = light;
     return min_a;
 }
 
@@ -417,6 +452,46 @@ f3_t oren_nayar_weight( f3_t weight, f3_t theta_i, f3_t on_a, f3_t on_b, v3d_s o
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/** Multiple importance sampling weight of strategy a against strategy b.
+ *  na_pa, nb_pb: sample count times density of each strategy (any common factor may be omitted).
+ *  Light sampling draws directions uniformly from the cap of height h enclosing the source (density 1 / ( 2 * pi * h ));
+ *  path sampling draws uniformly from the half-sphere (density 1 / ( 2 * pi )).
+ */
+static inline f3_t scene_mis_weight( uz_t heuristic, f3_t na_pa, f3_t nb_pb )
+{
+    if( heuristic == SCENE_MIS_POWER )
+    {
+        na_pa *= na_pa;
+        nb_pb *= nb_pb;
+    }
+    f3_t sum = na_pa + nb_pb;
+    return sum > 0 ? na_pa / sum : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// importance of a light source for direct light sampling at pos: radiance over squared distance
+static inline f3_t scene_light_importance( const obj_hdr_s* light_src, v3d_s pos )
+{
+    f3_t diff_sqr = v3d_s_diff_sqr( pos, light_src->prp.pos );
+    return ( diff_sqr > 0 ) ? ( light_src->prp.radiance / diff_sqr ) : f3_mag;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// sum of importances of all light sources at pos
+static f3_t scene_s_light_importance_sum( const scene_s* o, v3d_s pos )
+{
+    f3_t sum = 0;
+    for( uz_t i = 0; i < compound_s_get_size( o->light ); i++ )
+    {
+        sum += scene_light_importance( ( const obj_hdr_s* )compound_s_get_object( o->light, i ), pos );
+    }
+    return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 cl_s scene_s_lum( const scene_s* scene,
                   const ray_s* ray,
                   f3_t offs,
@@ -429,11 +504,14 @@ cl_s scene_s_lum( const scene_s* scene,
 
     v3d_s pos = ray_s_pos( ray, offs );
 
+    /// position in the frame of the entered object (textures, radiance)
+    v3d_s enter_pos = trans_data_s_enter_pos( trans, pos );
+
     if( trans->enter_obj && trans->enter_obj->prp.radiance > 0 )
     {
-        f3_t diff_sqr = v3d_s_diff_sqr( pos, trans->enter_obj->prp.pos );
+        f3_t diff_sqr = v3d_s_diff_sqr( enter_pos, trans->enter_obj->prp.pos );
         f3_t light_intensity = ( diff_sqr > 0 ) ? ( trans->enter_obj->prp.radiance / diff_sqr ) : f3_mag;
-        return v3d_s_mlf( obj_color( trans->enter_obj, pos ), light_intensity * intensity );
+        return v3d_s_mlf( obj_color( trans->enter_obj, enter_pos ), light_intensity * intensity );
     }
 
     f3_t trans_refractive_index = 1.0;
@@ -481,7 +559,7 @@ cl_s scene_s_lum( const scene_s* scene,
 
         f3_t a;
         cl_s lum_l = { 0, 0, 0 };
-        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l ) ) < f3_inf )
+        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l, NULL ) ) < f3_inf )
         {
             lum_l = scene_s_lum( scene, &out, a, &trans_l, depth - 1, reflectance * intensity );
         }
@@ -504,7 +582,7 @@ cl_s scene_s_lum( const scene_s* scene,
         trans_data_s_init( &trans_l );
         f3_t a;
         cl_s lum_l = { 0, 0, 0 };
-        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l ) ) < f3_inf )
+        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l, NULL ) ) < f3_inf )
         {
             lum_l = scene_s_lum( scene, &out, a, &trans_l, depth - 1, chromatic_reflectivity * intensity );
         }
@@ -513,7 +591,7 @@ cl_s scene_s_lum( const scene_s* scene,
             lum_l = v3d_s_mlf( scene->background_color, chromatic_reflectivity * intensity );
         }
 
-        cl_s cl = obj_color( trans->enter_obj, pos );
+        cl_s cl = obj_color( trans->enter_obj, enter_pos );
         lum_l.x *= cl.x;
         lum_l.y *= cl.y;
         lum_l.z *= cl.z;
@@ -543,6 +621,29 @@ cl_s scene_s_lum( const scene_s* scene,
 
         cl_s lum_l = { 0, 0, 0 };
 
+        uz_t direct_samples = scene->direct_samples * diffuse_intensity;
+        direct_samples = ( direct_samples == 0 ) ? 1 : direct_samples;
+
+        uz_t path_samples = 0;
+        if( scene->path_samples && depth > 10 )
+        {
+            path_samples = scene->path_samples * diffuse_intensity;
+            path_samples = ( path_samples == 0 ) ? 1 : path_samples;
+        }
+
+        /// with mis, path rays also reach light sources; both estimates are weighted
+        bl_t mis = scene->mis_heuristic != SCENE_MIS_NONE && path_samples > 0;
+
+        /** light selection: The direct_samples are distributed among light sources by systematic sampling
+         *  proportional to importance: Sample k selects the source whose cumulative importance range contains
+         *  ( select_offs + k ) / direct_samples. A source thus receives direct_samples * importance / importance_sum
+         *  samples in expectation; its estimate is normalized by this expectation.
+         */
+        f3_t importance_sum = scene->light_selection ? scene_s_light_importance_sum( scene, pos ) : 0;
+        f3_t select_offs = scene->light_selection ? f3_rnd1( &rv ) : 0;
+        f3_t select_cumulative = 0;
+        uz_t selected = 0;
+
         /// process sources with radiance directly  (light-sources)
         for( uz_t i = 0; i < compound_s_get_size( scene->light ); i++ )
         {
@@ -551,14 +652,28 @@ cl_s scene_s_lum( const scene_s* scene,
             const aware_t* cmp_object = compound_s_get_object( scene->light, i );
             assert( bcore_trait_is_of( *cmp_object, TYPEOF_spect_obj ) );
             obj_hdr_s* light_src = ( obj_hdr_s* )cmp_object;
+
+            uz_t light_samples = direct_samples; // samples of this source
+            f3_t light_norm    = direct_samples; // expected samples of this source
+            if( scene->light_selection )
+            {
+                if( importance_sum <= 0 ) break;
+                light_norm = direct_samples * scene_light_importance( light_src, pos ) / importance_sum;
+                select_cumulative += light_norm;
+                f3_t select_end = ceil( select_cumulative - select_offs );
+                uz_t end = select_end > 0 ? ( select_end < direct_samples ? select_end : direct_samples ) : 0;
+                light_samples = end > selected ? end - selected : 0;
+                selected = end;
+                if( light_samples == 0 ) continue;
+            }
+
             ray_cone_s fov_to_src = obj_fov( light_src, pos );
             m3d_s src_con = m3d_s_transposed( m3d_s_con_z( fov_to_src.ray.d ) );
             f3_t cyl_hgt = areal_coverage( fov_to_src.cos_rs );
             cl_s color = obj_color( light_src, light_src->prp.pos );
-            uz_t direct_samples = scene->direct_samples * diffuse_intensity;
-            direct_samples = ( direct_samples == 0 ) ? 1 : direct_samples;
+            f3_t mis_weight = mis ? scene_mis_weight( scene->mis_heuristic, light_norm, path_samples * cyl_hgt ) : 1.0;
 
-            for( uz_t j = 0; j < direct_samples; j++ )
+            for( uz_t j = 0; j < light_samples; j++ )
             {
                 out.d = m3d_s_mlv( &src_con, v3d_s_random_sphere_cap( &rv, cyl_hgt ) );
                 f3_t weight = v3d_s_mlv( out.d, surface.d );
@@ -571,7 +686,7 @@ cl_s scene_s_lum( const scene_s* scene,
 
                 if( on_b > 0 ) weight = oren_nayar_weight( weight, theta_i, on_a, on_b, out.d, surface.d, ray_projection );
 
-                if( compound_s_ray_hit( scene->matter, &out, NULL, NULL ) > a )
+                if( !compound_s_ray_occluded( scene->matter, &out, a ) )
                 {
                     v3d_s hit_pos = ray_s_pos( &out, a );
                     f3_t diff_sqr = v3d_s_diff_sqr( hit_pos, light_src->prp.pos );
@@ -581,12 +696,12 @@ cl_s scene_s_lum( const scene_s* scene,
             }
 
             // factor 2 arises from weight distribution across the half-sphere
-            lum_l = v3d_s_add( lum_l, v3d_s_mlf( cl_sum, 2.0 * cyl_hgt / direct_samples ) );
+            lum_l = v3d_s_add( lum_l, v3d_s_mlf( cl_sum, 2.0 * cyl_hgt * mis_weight / light_norm ) );
 
         }
 
         // path tracing
-        if( scene->path_samples && depth > 10 )
+        if( path_samples > 0 )
         {
             cl_s cl_sum = { 0, 0, 0 };
             ray_s out = surface;
@@ -595,9 +710,6 @@ cl_s scene_s_lum( const scene_s* scene,
             f3_t per_energy = v3d_s_sqr( lum_l );
             per_energy = per_energy > 0.01 ? per_energy : 0.01;
 
-            uz_t path_samples = scene->path_samples * diffuse_intensity;
-            path_samples = ( path_samples == 0 ) ? 1 : path_samples;
-
             for( uz_t i = 0; i < path_samples; i++ )
             {
                 out.d = m3d_s_mlv( &out_con, v3d_s_random_sphere_cap( &rv, 1.0 ) );
@@ -608,11 +720,23 @@ cl_s scene_s_lum( const scene_s* scene,
 
                 trans_data_s trans_l;
                 trans_data_s_init( &trans_l );
-                f3_t a = compound_s_ray_trans_hit( scene->matter, &out, &trans_l );
+                bl_t light_hit = false;
+                f3_t a = mis ? scene_s_trans_hit( scene, &out, &trans_l, &light_hit ) : compound_s_ray_trans_hit( scene->matter, &out, &trans_l );
 
                 if( a < scene->max_path_length )
                 {
                     cl_s lum = scene_s_lum( scene, &out, a, &trans_l, depth - 10, weight * diffuse_intensity );
+                    // only scene->light is sampled directly; emitting matter keeps its full path contribution
+                    if( mis && light_hit && trans_l.enter_obj && trans_l.enter_obj->prp.radiance > 0 )
+                    {
+                        f3_t cyl_hgt = areal_coverage( obj_fov( trans_l.enter_obj, pos ).cos_rs );
+                        f3_t light_norm = direct_samples;
+                        if( scene->light_selection )
+                        {
+                            light_norm = importance_sum > 0 ? direct_samples * scene_light_importance( trans_l.enter_obj, pos ) / importance_sum : 0;
+                        }
+                        lum = v3d_s_mlf( lum, scene_mis_weight( scene->mis_heuristic, path_samples * cyl_hgt, light_norm ) );
+                    }
                     cl_sum = v3d_s_add( cl_sum, lum );
                 }
                 else
@@ -625,7 +749,7 @@ cl_s scene_s_lum( const scene_s* scene,
             lum_l = v3d_s_add( lum_l, v3d_s_mlf( cl_sum, 2.0 / path_samples ) );
         }
 
-        cl_s cl = obj_color( trans->enter_obj, pos );
+        cl_s cl = obj_color( trans->enter_obj, enter_pos );
         lum_l.x *= cl.x;
         lum_l.y *= cl.y;
         lum_l.z *= cl.z;
@@ -646,7 +770,7 @@ cl_s scene_s_lum( const scene_s* scene,
 
         f3_t a;
         cl_s lum_l = { 0, 0, 0 };
-        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l ) ) < f3_inf )
+        if ( ( a = scene_s_trans_hit( scene, &out, &trans_l, NULL ) ) < f3_inf )
         {
             lum_l = scene_s_lum( scene, &out, a, &trans_l, depth - 1, intensity );
         }
@@ -673,6 +797,456 @@ cl_s scene_s_lum( const scene_s* scene,
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/** Path state of the iterative and the wavefront integrator.
+ *  A path is advanced vertex by vertex in four steps:
+ *    path_s_select:       chooses one of the lobes of scene_s_lum (fresnel reflection, chromatic reflection,
+ *                         diffuse reflection, refraction) with a probability proportional to its energy
+ *    path_s_light_sample: (diffuse lobe) samples direct light of one light source; yields a shadow ray
+ *                         (one per light source or, with light_selection, one of a source chosen by importance)
+ *    path_s_scatter:      computes the continuation ray
+ *    path_s_trace:        intersects the continuation ray with the scene
+ *  The throughput is weighted by the total energy of all lobes, so that the expected luminance equals
+ *  that of scene_s_lum. Depth is accounted for as in scene_s_lum: a specular bounce costs 1, a diffuse bounce 10.
+ *
+ *  With roulette_depth > 0, paths are terminated by russian roulette instead: After roulette_depth bounces,
+ *  a path survives with probability min( 1, throughput ) and its throughput is divided by that probability,
+ *  which keeps the estimator unbiased. trace_min_intensity is then ignored, each bounce costs 1 and
+ *  trace_depth only serves as upper limit.
+ *
+ *  With mis_heuristic, the continuation ray of a diffuse vertex also reaches light sources. Its light contribution and
+ *  that of the light samples at the vertex are weighted by the heuristic. Fresnel and chromatic reflections are
+ *  perfect mirrors (with respect to the possibly roughened normal); light sampling cannot produce their directions,
+ *  so light sources reached by them are weighted 1.
+ */
+
+/// lobes of a path vertex
+enum
+{
+    PATH_LOBE_NONE = 0, // path terminated
+    PATH_LOBE_FRESNEL,
+    PATH_LOBE_CHROMATIC,
+    PATH_LOBE_DIFFUSE,
+    PATH_LOBE_REFRACTION,
+    PATH_LOBES
+};
+
+typedef struct path_s
+{
+    ray_s ray;           // ray leading to the current vertex
+    f3_t  offs;          // offset of the current vertex on ray
+    trans_data_s trans;  // transition at the current vertex
+    cl_s  lum;           // accumulated luminance
+    cl_s  weight;        // chromatic throughput (colors, absorption)
+    f3_t  intensity;     // energetic throughput (compared to trace_min_intensity)
+    uz_t  depth;         // remaining depth
+    uz_t  bounces;       // bounces so far
+    u3_t  rv;            // random state
+
+    /// vertex (set by path_s_select)
+    s2_t  lobe;          // PATH_LOBE_...
+    v3d_s pos;
+    f3_t  refractive_index;
+    v3d_s fresnel_d;     // direction of fresnel reflection
+    f3_t  on_a, on_b;    // oren-nayar-terms
+    f3_t  theta_i;       // oren-nayar-angle of incidence
+    v3d_s ray_projection;
+
+    /// continuation (set by path_s_scatter)
+    ray_s out;
+    bl_t  matter_only;   // out is traced against matter only (light sources are reached by direct sampling)
+    bl_t  mis;           // out is a path sample of a diffuse vertex at mis_pos, which also sampled light sources
+    v3d_s mis_pos;
+    bl_t  light_hit;     // trans.enter_obj belongs to scene->light (set by path_s_trace)
+    f3_t  importance_sum; // light selection: importance sum of all light sources at the last diffuse vertex
+} path_s;
+
+/// shadow ray of a direct light sample
+typedef struct shadow_s
+{
+    ray_s ray;
+    f3_t  dist;    // offset of the light source on ray
+    cl_s  lum;     // contribution unless occluded
+    bl_t  visible;
+} shadow_s;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// throughput of the path (largest color channel)
+static inline f3_t path_s_throughput( const path_s* o )
+{
+    return o->intensity * f3_max( o->weight.x, f3_max( o->weight.y, o->weight.z ) );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// cost in depth of a diffuse bounce
+static inline uz_t scene_s_diffuse_cost( const scene_s* o )
+{
+    return o->roulette_depth > 0 ? 1 : 10;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// true when the diffuse lobe at the current vertex is continued by a path sample
+static inline bl_t path_s_diffuse_continues( const path_s* o, const scene_s* scene )
+{
+    return scene->path_samples && o->depth > scene_s_diffuse_cost( scene );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void path_s_init( path_s* o, const ray_s* ray, f3_t offs, const trans_data_s* trans, uz_t depth, u3_t rv )
+{
+    bcore_memzero( o, sizeof( *o ) );
+    o->ray       = *ray;
+    o->offs      = offs;
+    o->trans     = *trans;
+    o->weight    = ( cl_s ){ 1, 1, 1 };
+    o->intensity = 1.0;
+    o->depth     = depth;
+    o->rv        = rv;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// chooses the lobe at the current vertex; PATH_LOBE_NONE terminates the path
+s2_t path_s_select( path_s* o, const scene_s* scene )
+{
+    o->lobe = PATH_LOBE_NONE;
+    if( o->depth == 0 ) return o->lobe;
+    if( scene->roulette_depth == 0 && o->intensity < scene->trace_min_intensity ) return o->lobe;
+
+    const trans_data_s* trans = &o->trans;
+    o->pos = ray_s_pos( &o->ray, o->offs );
+
+    /// position in the frame of the entered object (textures, radiance)
+    v3d_s enter_pos = trans_data_s_enter_pos( trans, o->pos );
+
+    if( trans->enter_obj && trans->enter_obj->prp.radiance > 0 )
+    {
+        f3_t diff_sqr = v3d_s_diff_sqr( enter_pos, trans->enter_obj->prp.pos );
+        f3_t light_intensity = ( diff_sqr > 0 ) ? ( trans->enter_obj->prp.radiance / diff_sqr ) : f3_mag;
+        if( o->mis && o->light_hit )
+        {
+            f3_t cyl_hgt = areal_coverage( obj_fov( trans->enter_obj, o->mis_pos ).cos_rs );
+            f3_t probability = 1.0; // of sampling this source
+            if( scene->light_selection )
+            {
+                probability = o->importance_sum > 0 ? scene_light_importance( trans->enter_obj, o->mis_pos ) / o->importance_sum : 0;
+            }
+            light_intensity *= scene_mis_weight( scene->mis_heuristic, cyl_hgt, probability );
+        }
+        o->lum = v3d_s_add( o->lum, v3d_s_mlf( v3d_s_mld( obj_color( trans->enter_obj, enter_pos ), o->weight ), light_intensity * o->intensity ) );
+        return o->lobe;
+    }
+
+    /// russian roulette
+    if( scene->roulette_depth > 0 && o->bounces >= scene->roulette_depth )
+    {
+        f3_t survival = f3_min( 1.0, path_s_throughput( o ) );
+        if( survival <= 0 || f3_rnd1( &o->rv ) >= survival ) return o->lobe;
+        o->intensity /= survival;
+    }
+
+    f3_t fresnel_reflectivity = 0;
+    f3_t chromatic_reflectivity = 0;
+    f3_t diffuse_reflectivity = 0;
+    bl_t transparent = false;
+
+    o->refractive_index = 1.0;
+    o->on_a = 1.0;
+    o->on_b = 0.0;
+
+    if( trans->enter_obj )
+    {
+        o->refractive_index    = trans->enter_obj->prp.refractive_index;
+        fresnel_reflectivity   = trans->enter_obj->prp.fresnel_reflectivity && trans->enter_obj->prp.refractive_index != 1.0;
+        chromatic_reflectivity = trans->enter_obj->prp.chromatic_reflectivity;
+        diffuse_reflectivity   = trans->enter_obj->prp.diffuse_reflectivity;
+        transparent            = v3d_s_sqr( trans->enter_obj->prp.transparency ) > 0;
+        f3_t sigma             = trans->enter_obj->prp.sigma;
+        if( sigma > 0 )
+        {
+            f3_t sigma_sqr = f3_sqr( sigma );
+            o->on_a = 1.0 - 0.5 * sigma_sqr / ( sigma_sqr + 0.33 );
+            o->on_b = 0.45 * sigma_sqr / ( sigma_sqr + 0.09 );
+        }
+    }
+
+    if( trans->exit_obj )
+    {
+        o->refractive_index /= trans->exit_obj->prp.refractive_index;
+        fresnel_reflectivity = 1.0;
+        diffuse_reflectivity = chromatic_reflectivity = 0;
+        transparent = true;
+
+        /// absorption inside the object
+        if( o->offs > 0 )
+        {
+            o->weight.x *= pow( trans->exit_obj->prp.transparency.x, o->offs );
+            o->weight.y *= pow( trans->exit_obj->prp.transparency.y, o->offs );
+            o->weight.z *= pow( trans->exit_obj->prp.transparency.z, o->offs );
+        }
+    }
+
+    /// lobe energies (same partition as in scene_s_lum)
+    f3_t remaining = 1.0;
+    f3_t e_fresnel = 0, e_chromatic = 0, e_diffuse = 0, e_refraction = 0;
+
+    if( fresnel_reflectivity > 0 )
+    {
+        e_fresnel = fresnel_reflection( o->ray.d, trans->exit_nor, o->refractive_index, &o->fresnel_d ) * fresnel_reflectivity;
+        remaining *= ( 1.0 - e_fresnel );
+    }
+
+    if( chromatic_reflectivity > 0 )
+    {
+        e_chromatic = remaining * chromatic_reflectivity;
+        remaining *= ( 1.0 - chromatic_reflectivity );
+    }
+
+    if( diffuse_reflectivity > 0 )
+    {
+        e_diffuse = remaining * diffuse_reflectivity;
+        remaining *= ( 1.0 - diffuse_reflectivity );
+    }
+
+    if( transparent ) e_refraction = remaining;
+
+    f3_t e_sum = e_fresnel + e_chromatic + e_diffuse + e_refraction;
+    if( e_sum <= 0 ) return o->lobe;
+
+    /// lobe k is chosen with probability e_k / e_sum; the estimator's weight is therefore e_sum
+    f3_t select = f3_rnd1( &o->rv ) * e_sum;
+    o->intensity *= e_sum;
+
+    if( select < e_fresnel )
+    {
+        o->lobe = PATH_LOBE_FRESNEL;
+    }
+    else if( select < e_fresnel + e_chromatic )
+    {
+        o->lobe = PATH_LOBE_CHROMATIC;
+        o->weight = v3d_s_mld( o->weight, obj_color( trans->enter_obj, enter_pos ) );
+    }
+    else if( select < e_fresnel + e_chromatic + e_diffuse )
+    {
+        o->lobe = PATH_LOBE_DIFFUSE;
+        o->weight = v3d_s_mld( o->weight, obj_color( trans->enter_obj, enter_pos ) );
+
+        /// oren-nayar-reflection
+        v3d_s surface_d = v3d_s_neg( trans->exit_nor );
+        o->theta_i = acos( -v3d_s_mlv( o->ray.d, surface_d ) );
+        o->ray_projection = v3d_s_of_length( v3d_s_orthogonal_projection( o->ray.d, surface_d ), 1.0 );
+    }
+    else
+    {
+        o->lobe = PATH_LOBE_REFRACTION;
+    }
+
+    return o->lobe;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// direct light samples per diffuse vertex
+static inline uz_t scene_s_path_light_samples( const scene_s* o )
+{
+    return o->light_selection ? 1 : compound_s_get_size( o->light );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Diffuse lobe: direct light sample k ( k < scene_s_path_light_samples ); returns false when the sample misses the source.
+ *  Sample k targets light source k or, with light_selection, a source chosen with probability proportional to its importance.
+ */
+bl_t path_s_light_sample( path_s* o, const scene_s* scene, uz_t k, shadow_s* shadow )
+{
+    uz_t light_index = k;
+    f3_t probability = 1.0; // of choosing light_index
+
+    if( scene->light_selection )
+    {
+        uz_t size = compound_s_get_size( scene->light );
+        o->importance_sum = scene_s_light_importance_sum( scene, o->pos );
+        if( size == 0 || o->importance_sum <= 0 ) return false;
+
+        f3_t select = f3_rnd1( &o->rv ) * o->importance_sum;
+        f3_t cumulative = 0;
+        for( light_index = 0; light_index < size - 1; light_index++ )
+        {
+            cumulative += scene_light_importance( ( const obj_hdr_s* )compound_s_get_object( scene->light, light_index ), o->pos );
+            if( select < cumulative ) break;
+        }
+
+        probability = scene_light_importance( ( const obj_hdr_s* )compound_s_get_object( scene->light, light_index ), o->pos ) / o->importance_sum;
+        if( probability <= 0 ) return false;
+    }
+
+    const aware_t* cmp_object = compound_s_get_object( scene->light, light_index );
+    assert( bcore_trait_is_of( *cmp_object, TYPEOF_spect_obj ) );
+    obj_hdr_s* light_src = ( obj_hdr_s* )cmp_object;
+    ray_cone_s fov_to_src = obj_fov( light_src, o->pos );
+    m3d_s src_con = m3d_s_transposed( m3d_s_con_z( fov_to_src.ray.d ) );
+    f3_t cyl_hgt = areal_coverage( fov_to_src.cos_rs );
+    v3d_s surface_d = v3d_s_neg( o->trans.exit_nor );
+
+    shadow->ray.p = o->pos;
+    shadow->ray.d = m3d_s_mlv( &src_con, v3d_s_random_sphere_cap( &o->rv, cyl_hgt ) );
+    f3_t light_weight = v3d_s_mlv( shadow->ray.d, surface_d );
+    if( light_weight <= 0 ) return false;
+
+    shadow->dist = obj_ray_hit( light_src, &shadow->ray, NULL );
+    if( shadow->dist >= f3_inf ) return false;
+
+    if( o->on_b > 0 ) light_weight = oren_nayar_weight( light_weight, o->theta_i, o->on_a, o->on_b, shadow->ray.d, surface_d, o->ray_projection );
+
+    v3d_s hit_pos = ray_s_pos( &shadow->ray, shadow->dist );
+    f3_t diff_sqr = v3d_s_diff_sqr( hit_pos, light_src->prp.pos );
+    f3_t local_intensity = ( diff_sqr > 0 ) ? ( light_src->prp.radiance / diff_sqr ) : f3_mag;
+    cl_s color = v3d_s_mld( obj_color( light_src, light_src->prp.pos ), o->weight );
+
+    if( scene->mis_heuristic != SCENE_MIS_NONE && path_s_diffuse_continues( o, scene ) )
+    {
+        local_intensity *= scene_mis_weight( scene->mis_heuristic, probability, cyl_hgt );
+    }
+
+    // factor 2 arises from weight distribution across the half-sphere
+    shadow->lum = v3d_s_mlf( color, local_intensity * light_weight * o->intensity * 2.0 * cyl_hgt / probability );
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// computes the continuation ray of the selected lobe; returns false when the path ends at the current vertex
+bl_t path_s_scatter( path_s* o, const scene_s* scene )
+{
+    o->out.p = o->pos;
+    o->matter_only = false;
+    o->mis = false;
+
+    switch( o->lobe )
+    {
+        case PATH_LOBE_FRESNEL:
+        {
+            o->out.d = o->fresnel_d;
+            o->depth -= 1;
+        }
+        break;
+
+        case PATH_LOBE_CHROMATIC:
+        {
+            o->out.d = v3d_s_reflection( o->ray.d, o->trans.exit_nor );
+            o->depth -= 1;
+        }
+        break;
+
+        case PATH_LOBE_DIFFUSE:
+        {
+            /// indirect light: continue path across the half-sphere
+            if( !path_s_diffuse_continues( o, scene ) ) return false;
+
+            v3d_s surface_d = v3d_s_neg( o->trans.exit_nor );
+            m3d_s out_con = m3d_s_transposed( m3d_s_con_z( surface_d ) );
+            o->out.d = m3d_s_mlv( &out_con, v3d_s_random_sphere_cap( &o->rv, 1.0 ) );
+            f3_t path_weight = v3d_s_mlv( o->out.d, surface_d );
+            if( path_weight <= 0 ) return false;
+            if( o->on_b > 0 ) path_weight = oren_nayar_weight( path_weight, o->theta_i, o->on_a, o->on_b, o->out.d, surface_d, o->ray_projection );
+
+            o->intensity *= 2.0 * path_weight;
+            o->depth -= scene_s_diffuse_cost( scene );
+            if( scene->mis_heuristic != SCENE_MIS_NONE )
+            {
+                o->mis = true;
+                o->mis_pos = o->pos;
+            }
+            else
+            {
+                o->matter_only = true;
+            }
+        }
+        break;
+
+        case PATH_LOBE_REFRACTION:
+        {
+            o->out.p = ray_s_pos( &o->ray, o->offs + 2.0 * f3_eps );
+            fresnel_refraction( o->ray.d, o->trans.exit_nor, o->refractive_index, &o->out.d );
+            o->depth -= 1;
+        }
+        break;
+
+        default: return false;
+    }
+
+    o->bounces++;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// intersects the continuation ray; returns false when it escapes the scene (background is accumulated)
+bl_t path_s_trace( path_s* o, const scene_s* scene )
+{
+    trans_data_s_init( &o->trans );
+    o->light_hit = false;
+    if( o->matter_only )
+    {
+        o->offs = compound_s_ray_trans_hit( scene->matter, &o->out, &o->trans );
+    }
+    else
+    {
+        o->offs = scene_s_trans_hit( scene, &o->out, &o->trans, &o->light_hit );
+    }
+
+    // diffuse continuation
+    if( ( o->matter_only || o->mis ) && o->offs >= scene->max_path_length ) o->offs = f3_inf;
+
+    o->ray = o->out;
+
+    if( o->offs >= f3_inf )
+    {
+        o->lum = v3d_s_add( o->lum, v3d_s_mlf( v3d_s_mld( scene->background_color, o->weight ), o->intensity ) );
+        return false;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Iterative path integrator: Traces a single path without recursion.
+ *  Direct light is sampled at each diffuse surface with one ray per light source.
+ *  Cost per path is linear in depth.
+ */
+cl_s scene_s_path_lum( const scene_s* scene, const ray_s* ray_in, f3_t offs_in, const trans_data_s* trans_in, u3_t* rv )
+{
+    path_s path;
+    path_s_init( &path, ray_in, offs_in, trans_in, scene->trace_depth, *rv );
+
+    while( path_s_select( &path, scene ) != PATH_LOBE_NONE )
+    {
+        if( path.lobe == PATH_LOBE_DIFFUSE )
+        {
+            for( uz_t i = 0; i < scene_s_path_light_samples( scene ); i++ )
+            {
+                shadow_s shadow;
+                if( path_s_light_sample( &path, scene, i, &shadow ) && !compound_s_ray_occluded( scene->matter, &shadow.ray, shadow.dist ) )
+                {
+                    path.lum = v3d_s_add( path.lum, shadow.lum );
+                }
+            }
+        }
+
+        if( !path_s_scatter( &path, scene ) ) break;
+        if( !path_s_trace( &path, scene ) ) break;
+    }
+
+    *rv = path.rv;
+    return path.lum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void scene_s_clear( scene_s* o )
 {
     compound_s_clear( o->light );
@@ -908,6 +1482,61 @@ static void signal_callabck( int signal_received )
 
 // ---------------------------------------------------------------------------------------------------------------------
 
+/// scrambles a seed (splitmix64 finalizer), such that neighboring seeds yield unrelated random sequences
+static inline u3_t scene_seed( u3_t v )
+{
+    v = ( v ^ ( v >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+    v = ( v ^ ( v >> 27 ) ) * 0x94D049BB133111EBull;
+    return v ^ ( v >> 31 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+/// random seed of a lum position
+static inline u3_t lum_s_seed( const lum_s* o )
+{
+    return scene_seed( ( ( u3_t )( s3_t )( o->pos.x * 65536 ) << 32 ) ^ ( u3_t )( s3_t )( o->pos.y * 65536 ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+/// rotation from camera coordinates into scene coordinates
+static m3d_s scene_s_camera_rotation( const scene_s* o )
+{
+    m3d_s camera_rotation;
+    v3d_s ry = v3d_s_of_length( o->camera_view_direction, 1 );
+    v3d_s rz = v3d_s_of_length( o->camera_top_direction, 1 );
+    rz = v3d_s_von( ry, rz );
+    v3d_s rx = v3d_s_mlx( ry, rz );
+    camera_rotation.x = rx;
+    camera_rotation.y = ry;
+    camera_rotation.z = rz;
+    return m3d_s_transposed( camera_rotation );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+/// camera ray through monitor position pos
+static ray_s scene_s_camera_ray( const scene_s* o, const m3d_s* camera_rotation, v2d_s pos )
+{
+    uz_t width = o->image_width;
+    uz_t height = o->image_height;
+    uz_t unit_sz = ( height >> 1 );
+    f3_t unit_f = 1.0 / unit_sz;
+
+    f3_t z = unit_f * ( ( height >> 1 ) - pos.y );
+    f3_t x = unit_f * ( pos.x - ( width >> 1 ) );
+    v3d_s d = { x, o->camera_focal_length, z };
+    d = v3d_s_of_length( d, 1.0 );
+
+    ray_s ray;
+    ray.p = o->camera_position;
+    ray.d = m3d_s_mlv( camera_rotation, d );
+    return ray;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
 typedef struct lum_machine_s
 {
     const scene_s* scene;
@@ -960,22 +1589,7 @@ uz_t lum_machine_s_get_index( lum_machine_s* o )
 
 vd_t lum_machine_s_func( lum_machine_s* o )
 {
-    uz_t width = o->scene->image_width;
-    uz_t height = o->scene->image_height;
-    uz_t unit_sz = ( height >> 1 );
-    f3_t unit_f = 1.0 / unit_sz;
-
-    m3d_s camera_rotation;
-    {
-        v3d_s ry = v3d_s_of_length( o->scene->camera_view_direction, 1 );
-        v3d_s rz = v3d_s_of_length( o->scene->camera_top_direction, 1 );
-        rz = v3d_s_von( ry, rz );
-        v3d_s rx = v3d_s_mlx( ry, rz );
-        camera_rotation.x = rx;
-        camera_rotation.y = ry;
-        camera_rotation.z = rz;
-        camera_rotation = m3d_s_transposed( camera_rotation );
-    }
+    m3d_s camera_rotation = scene_s_camera_rotation( o->scene );
 
     uz_t index;
     while( ( index = lum_machine_s_get_index( o ) ) < o->lum_arr->size )
@@ -983,32 +1597,34 @@ vd_t lum_machine_s_func( lum_machine_s* o )
         if( signal_received_g == SIGINT ) break;
 
         lum_s* lum = &o->lum_arr->data[ index ];
-        f3_t monitor_y = lum->pos.y;
-        f3_t monitor_x = lum->pos.x;
-        f3_t z = unit_f * ( ( height >> 1 ) - monitor_y );
-        f3_t x = unit_f * ( monitor_x - ( width >> 1 ) );
-        v3d_s d = { x, o->scene->camera_focal_length, z };
-        d = v3d_s_of_length( d, 1.0 );
-
-        ray_s ray;
-        ray.p = o->scene->camera_position;
-        ray.d = m3d_s_mlv( &camera_rotation, d );
+        ray_s ray = scene_s_camera_ray( o->scene, &camera_rotation, lum->pos );
 
         cl_s out_clr = o->scene->background_color;
 
         trans_data_s trans_l;
         trans_data_s_init( &trans_l );
 
-        f3_t offs = scene_s_trans_hit( o->scene, &ray, &trans_l );
+        f3_t offs = scene_s_trans_hit( o->scene, &ray, &trans_l, NULL );
         if( offs < f3_inf )
         {
-            if( o->scene->experimental_level == 0 )
+            if( o->scene->experimental_level != 0 )
             {
-                out_clr = scene_s_lum( o->scene, &ray, offs, &trans_l, o->scene->trace_depth, 1.0 );
+                bcore_err_fa( "Unsupported experimental level #<s3_t>\n", o->scene->experimental_level );
+            }
+            else if( o->scene->integrator == SCENE_INTEGRATOR_ITERATIVE )
+            {
+                u3_t rv = lum_s_seed( lum );
+                uz_t samples = o->scene->integrator_samples > 0 ? o->scene->integrator_samples : 1;
+                out_clr = cl_black();
+                for( uz_t i = 0; i < samples; i++ )
+                {
+                    out_clr = v3d_s_add( out_clr, scene_s_path_lum( o->scene, &ray, offs, &trans_l, &rv ) );
+                }
+                out_clr = v3d_s_mlf( out_clr, 1.0 / samples );
             }
             else
             {
-                bcore_err_fa( "Unsupported experimental level #<s3_t>\n", o->scene->experimental_level );
+                out_clr = scene_s_lum( o->scene, &ray, offs, &trans_l, o->scene->trace_depth, 1.0 );
             }
         }
 
@@ -1019,8 +1635,360 @@ vd_t lum_machine_s_func( lum_machine_s* o )
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**********************************************************************************************************************/
+// lum_wavefront
+
+/** Wavefront integrator: Computes the estimator of scene_s_path_lum for batches of paths.
+ *  Each bounce of a batch runs as a sequence of stages; each stage processes all active paths
+ *  across all threads before the next stage begins:
+ *    select:    path_s_select on all paths; the queue of active paths is then partitioned by lobe
+ *    shade:     shadow rays (diffuse lobe) and continuation rays (path_s_light_sample, path_s_scatter)
+ *    shadow:    occlusion of all shadow rays
+ *    trace:     accumulation of visible direct light; intersection of all continuation rays (path_s_trace)
+ *  Consecutive work items of a stage are thus of the same kind and lobe, which keeps
+ *  code and object data hot in the caches and lets threads share the batch without locking per ray.
+ */
+
+/// stages
+enum
+{
+    LUM_WAVEFRONT_CAMERA = 0, // intersection of camera rays; path initialization
+    LUM_WAVEFRONT_SELECT,
+    LUM_WAVEFRONT_SHADE,
+    LUM_WAVEFRONT_SHADOW,
+    LUM_WAVEFRONT_TRACE,
+};
+
+/// work items a thread fetches at once
+#define LUM_WAVEFRONT_CHUNK 64
+
+typedef struct lum_wavefront_s
+{
+    const scene_s* scene;
+    lum_arr_s* lum_arr;
+    m3d_s camera_rotation;
+    uz_t samples; // paths per lum
+    uz_t shadows; // shadow rays per diffuse path
+
+    /// batch
+    uz_t lum_start;
+    uz_t lum_size;
+    path_s* path_data; // path j of lum ( lum_start + i ): path_data[ i * samples + j ]
+    uz_t path_space;
+
+    /// queue of active paths (indices into path_data)
+    uz_t* queue_data;
+    uz_t* queue_buf;  // partition buffer
+    uz_t  queue_size;
+    uz_t  diffuse_start; // queue range of the diffuse lobe after partition
+    uz_t  diffuse_size;
+
+    /// shadow rays: light sample k of queue entry ( diffuse_start + i ): shadow_data[ i * shadows + k ]
+    shadow_s* shadow_data;
+    uz_t shadow_space;
+
+    /// current stage
+    s2_t stage;
+    uz_t stage_size;
+    uz_t index;
+    bcore_mutex_s mutex;
+} lum_wavefront_s;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void lum_wavefront_s_init( lum_wavefront_s* o )
+{
+    bcore_memzero( o, sizeof( *o ) );
+    bcore_mutex_s_init( &o->mutex );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void lum_wavefront_s_down( lum_wavefront_s* o )
+{
+    bcore_free( o->path_data );
+    bcore_free( o->queue_data );
+    bcore_free( o->queue_buf );
+    bcore_free( o->shadow_data );
+    bcore_mutex_s_down( &o->mutex );
+}
+
+BCORE_DEFINE_FUNCTION_CREATE( lum_wavefront_s )
+BCORE_DEFINE_FUNCTION_DISCARD( lum_wavefront_s )
+
+//----------------------------------------------------------------------------------------------------------------------
+
+lum_wavefront_s* lum_wavefront_s_plant( const scene_s* scene, lum_arr_s* lum_arr )
+{
+    lum_wavefront_s* o = lum_wavefront_s_create();
+    o->scene = scene;
+    o->lum_arr = lum_arr;
+    o->camera_rotation = scene_s_camera_rotation( scene );
+    o->samples = scene->integrator_samples > 0 ? scene->integrator_samples : 1;
+    o->shadows = scene_s_path_light_samples( scene );
+
+    uz_t batch = scene->wavefront_size / o->samples;
+    batch = batch > 0 ? batch : 1;
+    o->path_space = batch * o->samples;
+    o->path_data  = bcore_u_alloc( sizeof( path_s ), NULL, o->path_space, NULL );
+    o->queue_data = bcore_u_alloc( sizeof( uz_t ),   NULL, o->path_space, NULL );
+    o->queue_buf  = bcore_u_alloc( sizeof( uz_t ),   NULL, o->path_space, NULL );
+    return o;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// first item of the next chunk
+static uz_t lum_wavefront_s_get_index( lum_wavefront_s* o )
+{
+    bcore_mutex_s_lock( &o->mutex );
+    uz_t index = o->index;
+    o->index += LUM_WAVEFRONT_CHUNK;
+    bcore_mutex_s_unlock( &o->mutex );
+    return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// camera ray of lum ( lum_start + index ); initializes its paths
+static void lum_wavefront_s_camera( lum_wavefront_s* o, uz_t index )
+{
+    const scene_s* scene = o->scene;
+    const lum_s* lum = &o->lum_arr->data[ o->lum_start + index ];
+    path_s* path = o->path_data + index * o->samples;
+
+    ray_s ray = scene_s_camera_ray( scene, &o->camera_rotation, lum->pos );
+    trans_data_s trans;
+    trans_data_s_init( &trans );
+    f3_t offs = scene_s_trans_hit( scene, &ray, &trans, NULL );
+
+    if( offs < f3_inf && scene->experimental_level != 0 )
+    {
+        bcore_err_fa( "Unsupported experimental level #<s3_t>\n", scene->experimental_level );
+    }
+
+    u3_t seed = lum_s_seed( lum );
+    for( uz_t i = 0; i < o->samples; i++ )
+    {
+        path_s_init( &path[ i ], &ray, offs, &trans, scene->trace_depth, scene_seed( seed + i ) );
+        if( offs >= f3_inf ) path[ i ].lum = scene->background_color;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void lum_wavefront_s_shade( lum_wavefront_s* o, uz_t index )
+{
+    path_s* path = &o->path_data[ o->queue_data[ index ] ];
+
+    if( path->lobe == PATH_LOBE_DIFFUSE )
+    {
+        shadow_s* shadow = o->shadow_data + ( index - o->diffuse_start ) * o->shadows;
+        for( uz_t i = 0; i < o->shadows; i++ )
+        {
+            shadow[ i ].visible = path_s_light_sample( path, o->scene, i, &shadow[ i ] );
+        }
+    }
+
+    if( !path_s_scatter( path, o->scene ) ) path->lobe = PATH_LOBE_NONE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void lum_wavefront_s_shadow( lum_wavefront_s* o, uz_t index )
+{
+    shadow_s* shadow = &o->shadow_data[ index ];
+    if( shadow->visible ) shadow->visible = !compound_s_ray_occluded( o->scene->matter, &shadow->ray, shadow->dist );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void lum_wavefront_s_trace( lum_wavefront_s* o, uz_t index )
+{
+    path_s* path = &o->path_data[ o->queue_data[ index ] ];
+
+    if( index >= o->diffuse_start && index < o->diffuse_start + o->diffuse_size )
+    {
+        const shadow_s* shadow = o->shadow_data + ( index - o->diffuse_start ) * o->shadows;
+        for( uz_t i = 0; i < o->shadows; i++ )
+        {
+            if( shadow[ i ].visible ) path->lum = v3d_s_add( path->lum, shadow[ i ].lum );
+        }
+    }
+
+    if( path->lobe != PATH_LOBE_NONE && !path_s_trace( path, o->scene ) ) path->lobe = PATH_LOBE_NONE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static vd_t lum_wavefront_s_func( lum_wavefront_s* o )
+{
+    uz_t start;
+    while( ( start = lum_wavefront_s_get_index( o ) ) < o->stage_size )
+    {
+        if( signal_received_g == SIGINT ) break;
+
+        uz_t end = start + LUM_WAVEFRONT_CHUNK;
+        end = end < o->stage_size ? end : o->stage_size;
+
+        switch( o->stage )
+        {
+            case LUM_WAVEFRONT_CAMERA: for( uz_t i = start; i < end; i++ ) lum_wavefront_s_camera( o, i ); break;
+            case LUM_WAVEFRONT_SELECT: for( uz_t i = start; i < end; i++ ) path_s_select( &o->path_data[ o->queue_data[ i ] ], o->scene ); break;
+            case LUM_WAVEFRONT_SHADE:  for( uz_t i = start; i < end; i++ ) lum_wavefront_s_shade( o, i ); break;
+            case LUM_WAVEFRONT_SHADOW: for( uz_t i = start; i < end; i++ ) lum_wavefront_s_shadow( o, i ); break;
+            case LUM_WAVEFRONT_TRACE:  for( uz_t i = start; i < end; i++ ) lum_wavefront_s_trace( o, i ); break;
+            default: break;
+        }
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// processes items [ 0, size ) of a stage across all threads
+static void lum_wavefront_s_run_stage( lum_wavefront_s* o, s2_t stage, uz_t size )
+{
+    if( size == 0 ) return;
+    o->stage = stage;
+    o->stage_size = size;
+    o->index = 0;
+
+    uz_t chunks = ( size + LUM_WAVEFRONT_CHUNK - 1 ) / LUM_WAVEFRONT_CHUNK;
+    uz_t threads = o->scene->threads > 0 ? o->scene->threads : 1;
+    threads = threads < chunks ? threads : chunks;
+
+    if( threads == 1 )
+    {
+        lum_wavefront_s_func( o );
+        return;
+    }
+
+    bcore_thread_s* thread_arr = bcore_u_alloc( sizeof( bcore_thread_s ), NULL, threads, NULL );
+    for( uz_t i = 0; i < threads; i++ ) thread_arr[ i ] = bcore_thread_call( ( vd_t(*)(vd_t) )lum_wavefront_s_func, o );
+    for( uz_t i = 0; i < threads; i++ ) bcore_thread_join( thread_arr[ i ] );
+    bcore_free( thread_arr );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// removes terminated paths from the queue and sorts the remaining by lobe (stable)
+static void lum_wavefront_s_partition( lum_wavefront_s* o )
+{
+    uz_t count[ PATH_LOBES ] = { 0 };
+    for( uz_t i = 0; i < o->queue_size; i++ ) count[ o->path_data[ o->queue_data[ i ] ].lobe ]++;
+
+    uz_t start[ PATH_LOBES ];
+    uz_t sum = 0;
+    start[ PATH_LOBE_NONE ] = 0;
+    for( uz_t k = PATH_LOBE_NONE + 1; k < PATH_LOBES; k++ )
+    {
+        start[ k ] = sum;
+        sum += count[ k ];
+    }
+
+    for( uz_t i = 0; i < o->queue_size; i++ )
+    {
+        uz_t index = o->queue_data[ i ];
+        s2_t lobe = o->path_data[ index ].lobe;
+        if( lobe != PATH_LOBE_NONE ) o->queue_buf[ start[ lobe ]++ ] = index;
+    }
+
+    uz_t* swap = o->queue_data;
+    o->queue_data = o->queue_buf;
+    o->queue_buf = swap;
+    o->queue_size = sum;
+
+    o->diffuse_size  = count[ PATH_LOBE_DIFFUSE ];
+    o->diffuse_start = start[ PATH_LOBE_DIFFUSE ] - o->diffuse_size;
+
+    uz_t shadows = o->diffuse_size * o->shadows;
+    if( shadows > o->shadow_space )
+    {
+        o->shadow_data = bcore_u_alloc( sizeof( shadow_s ), o->shadow_data, shadows, NULL );
+        o->shadow_space = shadows;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// removes terminated paths from the queue
+static void lum_wavefront_s_compact( lum_wavefront_s* o )
+{
+    uz_t size = 0;
+    for( uz_t i = 0; i < o->queue_size; i++ )
+    {
+        uz_t index = o->queue_data[ i ];
+        if( o->path_data[ index ].lobe != PATH_LOBE_NONE ) o->queue_data[ size++ ] = index;
+    }
+    o->queue_size = size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// processes lums [ lum_start, lum_start + lum_size )
+static void lum_wavefront_s_run_batch( lum_wavefront_s* o, uz_t lum_start, uz_t lum_size )
+{
+    o->lum_start = lum_start;
+    o->lum_size  = lum_size;
+    uz_t paths = lum_size * o->samples;
+
+    lum_wavefront_s_run_stage( o, LUM_WAVEFRONT_CAMERA, lum_size );
+
+    o->queue_size = 0;
+    for( uz_t i = 0; i < paths; i++ ) if( o->path_data[ i ].offs < f3_inf ) o->queue_data[ o->queue_size++ ] = i;
+
+    while( o->queue_size > 0 && signal_received_g != SIGINT )
+    {
+        lum_wavefront_s_run_stage( o, LUM_WAVEFRONT_SELECT, o->queue_size );
+        lum_wavefront_s_partition( o );
+        lum_wavefront_s_run_stage( o, LUM_WAVEFRONT_SHADE,  o->queue_size );
+        lum_wavefront_s_run_stage( o, LUM_WAVEFRONT_SHADOW, o->diffuse_size * o->shadows );
+        lum_wavefront_s_run_stage( o, LUM_WAVEFRONT_TRACE,  o->queue_size );
+        lum_wavefront_s_compact( o );
+    }
+
+    if( signal_received_g == SIGINT ) return;
+
+    for( uz_t i = 0; i < lum_size; i++ )
+    {
+        const path_s* path = o->path_data + i * o->samples;
+        cl_s out_clr = cl_black();
+        for( uz_t j = 0; j < o->samples; j++ ) out_clr = v3d_s_add( out_clr, path[ j ].lum );
+        out_clr = v3d_s_mlf( out_clr, 1.0 / o->samples );
+        o->lum_arr->data[ lum_start + i ].clr = cl_s_sat( out_clr, o->scene->gamma );
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void lum_wavefront_s_run( const scene_s* scene, lum_arr_s* lum_arr )
+{
+    lum_wavefront_s* o = lum_wavefront_s_plant( scene, lum_arr );
+    uz_t batch = o->path_space / o->samples;
+
+    for( uz_t lum_start = 0; lum_start < lum_arr->size; lum_start += batch )
+    {
+        if( signal_received_g == SIGINT ) break;
+        uz_t lum_size = lum_arr->size - lum_start;
+        lum_size = lum_size < batch ? lum_size : batch;
+        lum_wavefront_s_run_batch( o, lum_start, lum_size );
+        bcore_msg( "%5.1f%% ", ( 100.0 * ( lum_start + lum_size ) ) / lum_arr->size );
+    }
+
+    lum_wavefront_s_discard( o );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void lum_machine_s_run( const scene_s* scene, lum_arr_s* lum_arr )
 {
+    if( scene->integrator == SCENE_INTEGRATOR_WAVEFRONT )
+    {
+        lum_wavefront_s_run( scene, lum_arr );
+        return;
+    }
+
     lum_machine_s* machine = lum_machine_s_plant( scene, lum_arr );
     uz_t threads = scene->threads > 0 ? scene->threads : 1;
 
@@ -1059,6 +2027,11 @@ void scene_s_create_image_file( scene_s* o, sc_t file )
 
     bcore_msg_fa( "Number of objects: #<uz_t>\n", scene_s_objects( o ) );
 
+    compound_s_prepare( o->light );
+    compound_s_prepare( o->matter );
+    compound_s_bake( o->light,  o->threads );
+    compound_s_bake( o->matter, o->threads );
+
     lum_arr_s* lum_arr = BLM_A_PUSH( lum_arr_s_create() );
 
     signal_received_g = 0;
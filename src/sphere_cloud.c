@@ -0,0 +1,356 @@
+/** Sphere Cloud */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <math.h>
+
+#include "bcore_spect_inst.h"
+#include "bcore_life.h"
+#include "bcore_spect.h"
+#include "bcore_spect_array.h"
+
+#include "sphere_cloud.h"
+
+/**********************************************************************************************************************/
+/// sphere_cloud_s
+
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_INST
+(
+    sphere_cloud_s,
+    "sphere_cloud_s = bcore_inst"
+    "{"
+        "aware_t _;"
+        "bvh_f3_arr_s x_arr;"
+        "bvh_f3_arr_s y_arr;"
+        "bvh_f3_arr_s z_arr;"
+        "bvh_f3_arr_s r_arr;"
+        "bvh_s        bvh;"
+    "}"
+)
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// appends to a plain data array (growing space geometrically)
+static inline void sphere_cloud_f3_arr_push( bvh_f3_arr_s* o, f3_t v )
+{
+    if( o->size >= o->space ) bcore_array_a_set_space( (bcore_array*)o, o->size > 0 ? o->size * 2 : 256 );
+    o->data[ o->size++ ] = v;
+}
+
+void sphere_cloud_s_clear( sphere_cloud_s* o )
+{
+    bcore_array_a_set_size( (bcore_array*)&o->x_arr, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->y_arr, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->z_arr, 0 );
+    bcore_array_a_set_size( (bcore_array*)&o->r_arr, 0 );
+    bvh_s_build( &o->bvh, NULL, 0 );
+}
+
+void sphere_cloud_s_push( sphere_cloud_s* o, v3d_s pos, f3_t radius )
+{
+    sphere_cloud_f3_arr_push( &o->x_arr, pos.x );
+    sphere_cloud_f3_arr_push( &o->y_arr, pos.y );
+    sphere_cloud_f3_arr_push( &o->z_arr, pos.z );
+    sphere_cloud_f3_arr_push( &o->r_arr, f3_abs( radius ) );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline v3d_s sphere_cloud_s_pos( const sphere_cloud_s* o, uz_t i )
+{
+    return ( v3d_s ) { o->x_arr.data[ i ], o->y_arr.data[ i ], o->z_arr.data[ i ] };
+}
+
+/// reorders array by slots
+static void sphere_cloud_f3_arr_permute( bvh_f3_arr_s* o, const u2_t* idx, f3_t* buf )
+{
+    for( uz_t i = 0; i < o->size; i++ ) buf[ i ] = o->data[ idx[ i ] ];
+    for( uz_t i = 0; i < o->size; i++ ) o->data[ i ] = buf[ i ];
+}
+
+void sphere_cloud_s_prepare( sphere_cloud_s* o )
+{
+    uz_t size = sphere_cloud_s_size( o );
+    if( size == 0 || sphere_cloud_s_is_prepared( o ) ) return;
+
+    box_s* box_arr = bcore_u_alloc( sizeof( box_s ), NULL, size, NULL );
+    for( uz_t i = 0; i < size; i++ ) box_arr[ i ] = box_s_of_sphere( sphere_cloud_s_pos( o, i ), o->r_arr.data[ i ] );
+    bvh_s_build( &o->bvh, box_arr, size );
+    bcore_free( box_arr );
+
+    // spheres in slot order: a leaf covers a contiguous range of spheres
+    f3_t* buf = bcore_u_alloc( sizeof( f3_t ), NULL, size, NULL );
+    u2_t* idx = o->bvh.idx_arr.data;
+    sphere_cloud_f3_arr_permute( &o->x_arr, idx, buf );
+    sphere_cloud_f3_arr_permute( &o->y_arr, idx, buf );
+    sphere_cloud_f3_arr_permute( &o->z_arr, idx, buf );
+    sphere_cloud_f3_arr_permute( &o->r_arr, idx, buf );
+    for( uz_t i = 0; i < size; i++ ) idx[ i ] = i;
+    bcore_free( buf );
+}
+
+box_s sphere_cloud_s_get_box( const sphere_cloud_s* o )
+{
+    if( sphere_cloud_s_is_prepared( o ) ) return bvh_s_get_box( &o->bvh );
+    box_s box = box_s_empty();
+    for( uz_t i = 0; i < sphere_cloud_s_size( o ); i++ )
+    {
+        box = box_s_union( box, box_s_of_sphere( sphere_cloud_s_pos( o, i ), o->r_arr.data[ i ] ) );
+    }
+    return box;
+}
+
+/**********************************************************************************************************************/
+/// intersection
+
+/// number of spheres intersected per pass of the kernel
+#define SPHERE_CLOUD_CHUNK 8
+
+/** Offsets of spheres i0 ... i0 + n - 1 (n <= SPHERE_CLOUD_CHUNK) along the ray; f3_inf: no crossing at offset > 0.
+ *  The loop is free of branches and dependencies across iterations for the compiler to vectorize it.
+ *  Selection of crossings is the same as in sphere_ray_hit.
+ */
+static inline void sphere_cloud_s_chunk_hit( const sphere_cloud_s* o, v3d_s p, v3d_s d, uz_t i0, uz_t n, f3_t* a_arr )
+{
+    const f3_t* x = o->x_arr.data + i0;
+    const f3_t* y = o->y_arr.data + i0;
+    const f3_t* z = o->z_arr.data + i0;
+    const f3_t* r = o->r_arr.data + i0;
+    for( uz_t i = 0; i < n; i++ )
+    {
+        f3_t px = p.x - x[ i ];
+        f3_t py = p.y - y[ i ];
+        f3_t pz = p.z - z[ i ];
+        f3_t s = px * d.x + py * d.y + pz * d.z;
+        f3_t q = px * px + py * py + pz * pz - r[ i ] * r[ i ];
+        f3_t disc = s * s - q;
+        f3_t w = sqrt( disc > 0 ? disc : 0 );
+        f3_t a0 = -s - w;
+        f3_t a1 = -s + w;
+        f3_t a = ( a0 > 0 ) ? a0 : a1;
+        a = ( disc >= 0 ) ? a : f3_inf;
+        a_arr[ i ] = ( a > 0 ) ? a : f3_inf;
+    }
+}
+
+/// closest crossing among spheres i0 ... i1 - 1; updates p_min_a and p_min_idx
+static inline void sphere_cloud_s_range_hit( const sphere_cloud_s* o, v3d_s p, v3d_s d, uz_t i0, uz_t i1, f3_t* p_min_a, uz_t* p_min_idx )
+{
+    f3_t a_arr[ SPHERE_CLOUD_CHUNK ];
+    for( uz_t j = i0; j < i1; j += SPHERE_CLOUD_CHUNK )
+    {
+        uz_t n = ( i1 - j < SPHERE_CLOUD_CHUNK ) ? i1 - j : SPHERE_CLOUD_CHUNK;
+        sphere_cloud_s_chunk_hit( o, p, d, j, n, a_arr );
+        for( uz_t i = 0; i < n; i++ )
+        {
+            if( a_arr[ i ] < *p_min_a )
+            {
+                *p_min_a = a_arr[ i ];
+                *p_min_idx = j + i;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+f3_t sphere_cloud_s_ray_hit( const sphere_cloud_s* o, const ray_s* r, v3d_s* p_nor )
+{
+    f3_t min_a = f3_inf;
+    uz_t min_idx = 0;
+
+    if( !sphere_cloud_s_is_prepared( o ) )
+    {
+        sphere_cloud_s_range_hit( o, r->p, r->d, 0, sphere_cloud_s_size( o ), &min_a, &min_idx );
+    }
+    else
+    {
+        const bvh_s* bvh = &o->bvh;
+        const bvh_node_s* node_arr = bvh->node_arr.data;
+        v3d_s inv_d = ray_inv_dir( r );
+
+        uz_t stack_node[ BVH_MAX_DEPTH ];
+        f3_t stack_offs[ BVH_MAX_DEPTH ];
+        uz_t stack_size = 0;
+
+        // front-to-back traversal (see compound_s_bvh_hit)
+        uz_t node = 0;
+        bl_t active = bvh_s_node_ray_entry( bvh, 0, r->p, inv_d ) < f3_inf;
+        while( active )
+        {
+            const bvh_node_s* nd = &node_arr[ node ];
+            if( nd->count > 0 )
+            {
+                sphere_cloud_s_range_hit( o, r->p, r->d, nd->offs, nd->offs + nd->count, &min_a, &min_idx );
+            }
+            else
+            {
+                uz_t near = node + 1;
+                uz_t far  = nd->offs;
+                f3_t near_offs = bvh_s_node_ray_entry( bvh, near, r->p, inv_d );
+                f3_t far_offs  = bvh_s_node_ray_entry( bvh, far,  r->p, inv_d );
+                if( far_offs < near_offs )
+                {
+                    uz_t t = near; near = far; far = t;
+                    f3_t t_offs = near_offs; near_offs = far_offs; far_offs = t_offs;
+                }
+
+                if( near_offs < min_a )
+                {
+                    if( far_offs < min_a )
+                    {
+                        stack_node[ stack_size ] = far;
+                        stack_offs[ stack_size ] = far_offs;
+                        stack_size++;
+                    }
+                    node = near;
+                    continue;
+                }
+            }
+
+            active = false;
+            while( stack_size > 0 )
+            {
+                stack_size--;
+                if( stack_offs[ stack_size ] < min_a )
+                {
+                    node = stack_node[ stack_size ];
+                    active = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if( min_a < f3_inf && p_nor )
+    {
+        *p_nor = v3d_s_of_length( v3d_s_sub( ray_s_pos( r, min_a ), sphere_cloud_s_pos( o, min_idx ) ), 1.0 );
+    }
+    return min_a;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bl_t sphere_cloud_s_ray_occluded( const sphere_cloud_s* o, const ray_s* r, f3_t max_dist )
+{
+    f3_t min_a = f3_inf;
+    uz_t min_idx = 0;
+
+    if( !sphere_cloud_s_is_prepared( o ) )
+    {
+        sphere_cloud_s_range_hit( o, r->p, r->d, 0, sphere_cloud_s_size( o ), &min_a, &min_idx );
+        return min_a <= max_dist;
+    }
+
+    const bvh_s* bvh = &o->bvh;
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+    v3d_s inv_d = ray_inv_dir( r );
+
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+    if( bvh_s_node_ray_entry( bvh, 0, r->p, inv_d ) <= max_dist ) stack[ stack_size++ ] = 0;
+
+    // any crossing terminates the traversal
+    while( stack_size > 0 )
+    {
+        const bvh_node_s* nd = &node_arr[ stack[ --stack_size ] ];
+        if( nd->count > 0 )
+        {
+            sphere_cloud_s_range_hit( o, r->p, r->d, nd->offs, nd->offs + nd->count, &min_a, &min_idx );
+            if( min_a <= max_dist ) return true;
+        }
+        else
+        {
+            uz_t left  = ( nd - node_arr ) + 1;
+            uz_t right = nd->offs;
+            if( bvh_s_node_ray_entry( bvh, right, r->p, inv_d ) <= max_dist ) stack[ stack_size++ ] = right;
+            if( bvh_s_node_ray_entry( bvh, left,  r->p, inv_d ) <= max_dist ) stack[ stack_size++ ] = left;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// true when pos lies inside node bounds
+static inline bl_t sphere_cloud_node_contains( const bvh_s* bvh, uz_t node, v3d_s pos )
+{
+    const f3_t* b = bvh->node_box.data;
+    uz_t n = bvh->node_arr.size;
+    return pos.x >= b[ node         ] && pos.y >= b[ node +     n ] && pos.z >= b[ node + 2 * n ] &&
+           pos.x <= b[ node + 3 * n ] && pos.y <= b[ node + 4 * n ] && pos.z <= b[ node + 5 * n ];
+}
+
+/// true when pos lies inside one of the spheres i0 ... i1 - 1
+static inline bl_t sphere_cloud_s_range_contains( const sphere_cloud_s* o, v3d_s pos, uz_t i0, uz_t i1 )
+{
+    for( uz_t i = i0; i < i1; i++ )
+    {
+        if( v3d_s_diff_sqr( pos, sphere_cloud_s_pos( o, i ) ) < f3_sqr( o->r_arr.data[ i ] ) ) return true;
+    }
+    return false;
+}
+
+s2_t sphere_cloud_s_side( const sphere_cloud_s* o, v3d_s pos )
+{
+    if( !sphere_cloud_s_is_prepared( o ) ) return sphere_cloud_s_range_contains( o, pos, 0, sphere_cloud_s_size( o ) ) ? -1 : 1;
+
+    const bvh_s* bvh = &o->bvh;
+    const bvh_node_s* node_arr = bvh->node_arr.data;
+
+    uz_t stack[ BVH_MAX_DEPTH ];
+    uz_t stack_size = 0;
+    if( sphere_cloud_node_contains( bvh, 0, pos ) ) stack[ stack_size++ ] = 0;
+
+    while( stack_size > 0 )
+    {
+        const bvh_node_s* nd = &node_arr[ stack[ --stack_size ] ];
+        if( nd->count > 0 )
+        {
+            if( sphere_cloud_s_range_contains( o, pos, nd->offs, nd->offs + nd->count ) ) return -1;
+        }
+        else
+        {
+            uz_t left  = ( nd - node_arr ) + 1;
+            uz_t right = nd->offs;
+            if( sphere_cloud_node_contains( bvh, right, pos ) ) stack[ stack_size++ ] = right;
+            if( sphere_cloud_node_contains( bvh, left,  pos ) ) stack[ stack_size++ ] = left;
+        }
+    }
+
+    return 1;
+}
+
+/**********************************************************************************************************************/
+
+vd_t sphere_cloud_signal_handler( const bcore_signal_s* o )
+{
+    switch( bcore_signal_s_handle_type( o, typeof( "sphere_cloud" ) ) )
+    {
+        case TYPEOF_init1:
+        {
+            BCORE_REGISTER_OBJECT( sphere_cloud_s );
+        }
+        break;
+
+        default: break;
+    }
+    return NULL;
+}
+
+/**********************************************************************************************************************/
+
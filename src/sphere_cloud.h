@@ -0,0 +1,82 @@
+/** Sphere Cloud */
+
+/** Copyright 2018 Johannes Bernhard Steffens
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SPHERE_CLOUD_H
+#define SPHERE_CLOUD_H
+
+#include "bcore_std.h"
+
+#include "quicktypes.h"
+#include "vectors.h"
+#include "gmath.h"
+#include "bvh.h"
+
+/**********************************************************************************************************************/
+/** Set of spheres with its own bounding volume hierarchy
+ *
+ *  Centers and radii are stored structure-of-arrays. sphere_cloud_s_prepare builds the hierarchy and
+ *  reorders the spheres by slot, so that each leaf covers a contiguous range of the arrays, which
+ *  is intersected by a branch-free (vectorizable) loop.
+ *  Spheres pushed after sphere_cloud_s_prepare are tested linearly until the cloud is prepared again.
+ *  Spheres should not overlap: a ray starting inside a sphere hits its exit regardless of other spheres.
+ */
+
+#define TYPEOF_sphere_cloud_s typeof( "sphere_cloud_s" )
+typedef struct sphere_cloud_s
+{
+    aware_t _;
+    bvh_f3_arr_s x_arr;
+    bvh_f3_arr_s y_arr;
+    bvh_f3_arr_s z_arr;
+    bvh_f3_arr_s r_arr;
+    bvh_s        bvh; // built by sphere_cloud_s_prepare
+} sphere_cloud_s;
+
+BCORE_DECLARE_FUNCTIONS_OBJ( sphere_cloud_s )
+
+static inline uz_t sphere_cloud_s_size( const sphere_cloud_s* o ) { return o->r_arr.size; }
+
+void sphere_cloud_s_clear( sphere_cloud_s* o );
+void sphere_cloud_s_push(  sphere_cloud_s* o, v3d_s pos, f3_t radius );
+
+/// builds the hierarchy (no effect when the cloud is prepared)
+void sphere_cloud_s_prepare( sphere_cloud_s* o );
+
+/// true when the hierarchy covers all spheres
+static inline bl_t sphere_cloud_s_is_prepared( const sphere_cloud_s* o )
+{
+    return o->bvh.node_arr.size > 0 && o->bvh.idx_arr.size == o->r_arr.size;
+}
+
+/// bounds of all spheres (empty box for an empty cloud)
+box_s sphere_cloud_s_get_box( const sphere_cloud_s* o );
+
+/// closest crossing at offset > 0 (not corrected by f3_eps) or f3_inf; r->d must be normalized; p_nor: outward unit normal
+f3_t sphere_cloud_s_ray_hit( const sphere_cloud_s* o, const ray_s* r, v3d_s* p_nor );
+
+/// true when any crossing lies within offset ( 0, max_dist ]; r->d must be normalized
+bl_t sphere_cloud_s_ray_occluded( const sphere_cloud_s* o, const ray_s* r, f3_t max_dist );
+
+/// 1: outside; -1: inside of a sphere
+s2_t sphere_cloud_s_side( const sphere_cloud_s* o, v3d_s pos );
+
+/**********************************************************************************************************************/
+
+vd_t sphere_cloud_signal_handler( const bcore_signal_s* o );
+
+#endif // SPHERE_CLOUD_H
+
@@ -30,6 +30,7 @@ BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( v3d_s,      "v3d_s = bcore_inst { f3_t
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( m3d_s,      "m3d_s = bcore_inst { v3d_s x; v3d_s y; v3d_s z; }" )
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( ray_s,      "ray_s = bcore_inst { v3d_s p; v3d_s d; }" )
 BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( ray_cone_s, "ray_cone_s = bcore_inst { ray_s ray; f3_t cos_rs; }" )
+BCORE_DEFINE_FUNCTIONS_SELF_OBJECT_FLAT( box_s,      "box_s = bcore_inst { v3d_s min; v3d_s max; }" )
 
 /**********************************************************************************************************************/
 /// cl_s
@@ -102,6 +103,7 @@ vd_t vectors_signal_handler( const bcore_signal_s* o )
             BCORE_REGISTER_OBJECT( m3d_s );
             BCORE_REGISTER_OBJECT( ray_s );
             BCORE_REGISTER_OBJECT( ray_cone_s );
+            BCORE_REGISTER_OBJECT( box_s );
             BCORE_REGISTER_OBJECT( cl_s );
             BCORE_REGISTER_OBJECT( row_cl_s );
             BCORE_REGISTER_OBJECT( image_cl_s );
@@ -352,6 +352,58 @@ BCORE_DECLARE_FUNCTIONS_OBJ( ray_cone_s )
 /// areal coverage (range 0...1: == height of unit-sphere-section)
 static inline f3_t areal_coverage( f3_t cos_rs ) { return 1 - cos_rs; }
 
+/**********************************************************************************************************************/
+/// box_s (axis aligned box)
+
+#define TYPEOF_box_s typeof( "box_s" )
+typedef struct box_s { v3d_s min; v3d_s max; } box_s;
+BCORE_DECLARE_FUNCTIONS_OBJ( box_s )
+
+/// empty box (neutral element of box_s_union)
+static inline box_s box_s_empty() { return ( box_s ) { .min = { f3_mag, f3_mag, f3_mag }, .max = { -f3_mag, -f3_mag, -f3_mag } }; }
+
+/// box enclosing a sphere
+static inline box_s box_s_of_sphere( v3d_s pos, f3_t r )
+{
+    return ( box_s ) { .min = { pos.x - r, pos.y - r, pos.z - r }, .max = { pos.x + r, pos.y + r, pos.z + r } };
+}
+
+static inline box_s box_s_union( box_s o, box_s b )
+{
+    return ( box_s )
+    {
+        .min = { o.min.x < b.min.x ? o.min.x : b.min.x, o.min.y < b.min.y ? o.min.y : b.min.y, o.min.z < b.min.z ? o.min.z : b.min.z },
+        .max = { o.max.x > b.max.x ? o.max.x : b.max.x, o.max.y > b.max.y ? o.max.y : b.max.y, o.max.z > b.max.z ? o.max.z : b.max.z }
+    };
+}
+
+/// intersection of two boxes (min > max in some component if the boxes are disjoint)
+static inline box_s box_s_intersection( box_s o, box_s b )
+{
+    return ( box_s )
+    {
+        .min = { o.min.x > b.min.x ? o.min.x : b.min.x, o.min.y > b.min.y ? o.min.y : b.min.y, o.min.z > b.min.z ? o.min.z : b.min.z },
+        .max = { o.max.x < b.max.x ? o.max.x : b.max.x, o.max.y < b.max.y ? o.max.y : b.max.y, o.max.z < b.max.z ? o.max.z : b.max.z }
+    };
+}
+
+static inline bl_t box_s_is_empty( box_s o ) { return o.min.x > o.max.x || o.min.y > o.max.y || o.min.z > o.max.z; }
+
+static inline box_s box_s_union_pos( box_s o, v3d_s p )
+{
+    return box_s_union( o, ( box_s ) { .min = p, .max = p } );
+}
+
+static inline v3d_s box_s_center( box_s o ) { return v3d_s_mlf( v3d_s_add( o.min, o.max ), 0.5 ); }
+
+/// surface area (0 for empty boxes)
+static inline f3_t box_s_area( box_s o )
+{
+    v3d_s d = v3d_s_sub( o.max, o.min );
+    if( d.x < 0 || d.y < 0 || d.z < 0 ) return 0;
+    return 2.0 * ( d.x * d.y + d.y * d.z + d.z * d.x );
+}
+
 /**********************************************************************************************************************/
 /// cl_s RGB Color expressed as 3D vector (x=red, y=green, z=blue)
 